@@ -6,6 +6,9 @@
 #include "Engine/Classes/Components/StaticMeshComponent.h"
 #include "StaticMeshAttributes.h"
 #include "StaticMeshOperations.h"
+#include "Async/ParallelFor.h"
+#include "DynamicMesh/DynamicMesh3.h"
+#include "DynamicMesh/DynamicMeshAttributeSet.h"
 
 
 
@@ -106,4 +109,299 @@ void UE::MeshDescription::ConfigureBuildSettings(UStaticMesh* StaticMesh, int32
 #else
 	// just ignore?
 #endif
-}
\ No newline at end of file
+}
+
+
+
+void UE::MeshDescription::ConvertDynamicMeshParallel(const UE::Geometry::FDynamicMesh3& MeshIn, FMeshDescription& MeshOut,
+	bool bSetPolyGroups, FParallelConversionTimings* OutTimings, bool bAppend)
+{
+	using namespace UE::Geometry;
+
+	double StageStartTime = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
+	auto EndStage = [&StageStartTime](double& StageTime)
+	{
+		const double Now = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
+		StageTime = Now - StageStartTime;
+		StageStartTime = Now;
+	};
+	FParallelConversionTimings Timings;
+
+	// Overlays that split vertex instances: normal layers (normal, tangent, bitangent), UV layers, colors
+	const FDynamicMeshAttributeSet* AttributesIn = MeshIn.HasAttributes() ? MeshIn.Attributes() : nullptr;
+	const int32 NumNormalLayers = AttributesIn ? FMath::Min(AttributesIn->NumNormalLayers(), 3) : 0;
+	const int32 NumUVLayers = AttributesIn ? AttributesIn->NumUVLayers() : 0;
+	const bool bHasColors = AttributesIn && AttributesIn->HasPrimaryColors();
+	const int32 KeyWidth = NumNormalLayers + NumUVLayers + (bHasColors ? 1 : 0);
+
+	auto GetCornerKey = [&](int32 tid, int32 Corner, int32* Key)
+	{
+		int32 k = 0;
+		for (int32 Layer = 0; Layer < NumNormalLayers; ++Layer, ++k)
+		{
+			const FDynamicMeshNormalOverlay* Overlay = AttributesIn->GetNormalLayer(Layer);
+			Key[k] = Overlay->IsSetTriangle(tid) ? Overlay->GetTriangle(tid)[Corner] : IndexConstants::InvalidID;
+		}
+		for (int32 Layer = 0; Layer < NumUVLayers; ++Layer, ++k)
+		{
+			const FDynamicMeshUVOverlay* Overlay = AttributesIn->GetUVLayer(Layer);
+			Key[k] = Overlay->IsSetTriangle(tid) ? Overlay->GetTriangle(tid)[Corner] : IndexConstants::InvalidID;
+		}
+		if (bHasColors)
+		{
+			const FDynamicMeshColorOverlay* Overlay = AttributesIn->PrimaryColors();
+			Key[k] = Overlay->IsSetTriangle(tid) ? Overlay->GetTriangle(tid)[Corner] : IndexConstants::InvalidID;
+		}
+	};
+
+	// Compact output IDs, the mesh may have holes in its ID spaces
+	const int32 MaxVertexID = MeshIn.MaxVertexID();
+	const int32 MaxTriangleID = MeshIn.MaxTriangleID();
+	TArray<int32> VertexToOut;
+	VertexToOut.SetNumUninitialized(MaxVertexID);
+	int32 NumVertices = 0;
+	for (int32 vid = 0; vid < MaxVertexID; ++vid)
+	{
+		VertexToOut[vid] = MeshIn.IsVertex(vid) ? NumVertices++ : IndexConstants::InvalidID;
+	}
+	TArray<int32> Triangles;
+	Triangles.Reserve(MeshIn.TriangleCount());
+	for (int32 tid = 0; tid < MaxTriangleID; ++tid)
+	{
+		if (MeshIn.IsTriangle(tid))
+		{
+			Triangles.Add(tid);
+		}
+	}
+
+	// Unique corner keys per vertex, counted first, then written at each vertex's offset in the same order
+	auto GatherVertexKeys = [&](int32 vid, TArray<int32, TInlineAllocator<64>>& OutKeys)
+	{
+		int32 CornerKey[16];
+		check(KeyWidth <= UE_ARRAY_COUNT(CornerKey));
+		OutKeys.Reset();
+		MeshIn.EnumerateVertexTriangles(vid, [&](int32 tid)
+		{
+			const FIndex3i Tri = MeshIn.GetTriangle(tid);
+			const int32 Corner = (Tri.A == vid) ? 0 : ((Tri.B == vid) ? 1 : 2);
+			GetCornerKey(tid, Corner, CornerKey);
+			for (int32 Existing = 0; Existing < OutKeys.Num(); Existing += KeyWidth)
+			{
+				if (FMemory::Memcmp(&OutKeys[Existing], CornerKey, KeyWidth * sizeof(int32)) == 0)
+				{
+					return;
+				}
+			}
+			OutKeys.Append(CornerKey, KeyWidth);
+		});
+	};
+
+	TArray<int32> VertexInstanceStart;
+	VertexInstanceStart.SetNumZeroed(MaxVertexID + 1);
+	ParallelFor(MaxVertexID, [&](int32 vid)
+	{
+		if (MeshIn.IsVertex(vid) == false)
+		{
+			return;
+		}
+		if (KeyWidth == 0)
+		{
+			VertexInstanceStart[vid + 1] = 1;
+			return;
+		}
+		TArray<int32, TInlineAllocator<64>> Keys;
+		GatherVertexKeys(vid, Keys);
+		VertexInstanceStart[vid + 1] = Keys.Num() / KeyWidth;
+	});
+	for (int32 vid = 0; vid < MaxVertexID; ++vid)
+	{
+		VertexInstanceStart[vid + 1] += VertexInstanceStart[vid];
+	}
+	const int32 NumInstances = VertexInstanceStart[MaxVertexID];
+
+	TArray<int32> InstanceVertex;
+	InstanceVertex.SetNumUninitialized(NumInstances);
+	TArray<int32> InstanceKeys;
+	InstanceKeys.SetNumUninitialized(NumInstances * KeyWidth);
+	ParallelFor(MaxVertexID, [&](int32 vid)
+	{
+		const int32 Start = VertexInstanceStart[vid];
+		const int32 End = VertexInstanceStart[vid + 1];
+		for (int32 Instance = Start; Instance < End; ++Instance)
+		{
+			InstanceVertex[Instance] = vid;
+		}
+		if (KeyWidth > 0 && End > Start)
+		{
+			TArray<int32, TInlineAllocator<64>> Keys;
+			GatherVertexKeys(vid, Keys);
+			FMemory::Memcpy(&InstanceKeys[Start * KeyWidth], Keys.GetData(), Keys.Num() * sizeof(int32));
+		}
+	});
+
+	// Instance of every triangle corner
+	TArray<FIndex3i> TriangleInstances;
+	TriangleInstances.SetNumUninitialized(Triangles.Num());
+	ParallelFor(Triangles.Num(), [&](int32 Idx)
+	{
+		const int32 tid = Triangles[Idx];
+		const FIndex3i Tri = MeshIn.GetTriangle(tid);
+		int32 CornerKey[16];
+		for (int32 Corner = 0; Corner < 3; ++Corner)
+		{
+			int32 Instance = VertexInstanceStart[Tri[Corner]];
+			if (KeyWidth > 0)
+			{
+				GetCornerKey(tid, Corner, CornerKey);
+				while (Instance < VertexInstanceStart[Tri[Corner] + 1] - 1 &&
+					FMemory::Memcmp(&InstanceKeys[Instance * KeyWidth], CornerKey, KeyWidth * sizeof(int32)) != 0)
+				{
+					++Instance;
+				}
+			}
+			TriangleInstances[Idx][Corner] = Instance;
+		}
+	});
+	EndStage(Timings.InstanceTime);
+
+	// Keep the slot names of the polygon groups we are about to recreate
+	FStaticMeshAttributes Attributes(MeshOut);
+	TArray<FName> SlotNames;
+	if (bAppend == false)
+	{
+		TPolygonGroupAttributesConstRef<FName> ExistingSlotNames = Attributes.GetPolygonGroupMaterialSlotNames();
+		if (ExistingSlotNames.IsValid())
+		{
+			for (const FPolygonGroupID GroupID : MeshOut.PolygonGroups().GetElementIDs())
+			{
+				SlotNames.SetNum(FMath::Max(SlotNames.Num(), GroupID.GetValue() + 1));
+				SlotNames[GroupID.GetValue()] = ExistingSlotNames[GroupID];
+			}
+		}
+	}
+
+	if (bAppend == false)
+	{
+		MeshOut.Empty();
+		Attributes.Register();
+	}
+
+	// Appended elements are created after the existing ones, which keep their IDs
+	const int32 VertexOffset = MeshOut.Vertices().Num();
+	const int32 InstanceOffset = MeshOut.VertexInstances().Num();
+	const int32 TriangleOffset = MeshOut.Triangles().Num();
+	const int32 NumExistingGroups = MeshOut.PolygonGroups().Num();
+
+	const bool bHasMaterialID = AttributesIn && AttributesIn->HasMaterialID();
+	int32 NumGroups = 1;
+	if (bHasMaterialID)
+	{
+		for (int32 tid : Triangles)
+		{
+			NumGroups = FMath::Max(NumGroups, AttributesIn->GetMaterialID()->GetValue(tid) + 1);
+		}
+	}
+
+	MeshOut.ReserveNewVertices(NumVertices);
+	MeshOut.ReserveNewVertexInstances(NumInstances);
+	MeshOut.ReserveNewPolygonGroups(FMath::Max(NumGroups - NumExistingGroups, 0));
+	MeshOut.ReserveNewTriangles(Triangles.Num());
+	MeshOut.ReserveNewPolygons(Triangles.Num());
+	MeshOut.ReserveNewEdges(Triangles.Num() * 3 / 2 + 1);
+
+	// The description has no holes, so IDs are handed out in creation order and match our compact indices
+	for (int32 Idx = 0; Idx < NumVertices; ++Idx)
+	{
+		MeshOut.CreateVertex();
+	}
+	for (int32 Instance = 0; Instance < NumInstances; ++Instance)
+	{
+		MeshOut.CreateVertexInstance(FVertexID(VertexOffset + VertexToOut[InstanceVertex[Instance]]));
+	}
+	TPolygonGroupAttributesRef<FName> SlotNamesOut = Attributes.GetPolygonGroupMaterialSlotNames();
+	for (int32 Group = NumExistingGroups; Group < NumGroups; ++Group)
+	{
+		const FPolygonGroupID GroupID = MeshOut.CreatePolygonGroup();
+		if (Group < SlotNames.Num())
+		{
+			SlotNamesOut[GroupID] = SlotNames[Group];
+		}
+	}
+	for (int32 Idx = 0; Idx < Triangles.Num(); ++Idx)
+	{
+		const FIndex3i& Corners = TriangleInstances[Idx];
+		const FVertexInstanceID InstanceIDs[3] = { FVertexInstanceID(InstanceOffset + Corners.A), FVertexInstanceID(InstanceOffset + Corners.B), FVertexInstanceID(InstanceOffset + Corners.C) };
+		const int32 Group = bHasMaterialID ? AttributesIn->GetMaterialID()->GetValue(Triangles[Idx]) : 0;
+		MeshOut.CreateTriangle(FPolygonGroupID(FMath::Max(Group, 0)), InstanceIDs);
+	}
+	TriangleInstances.Empty();
+	EndStage(Timings.TopologyTime);
+
+	// Attributes, every element is written once so this is all parallel
+	TVertexAttributesRef<FVector3f> Positions = Attributes.GetVertexPositions();
+	ParallelFor(MaxVertexID, [&](int32 vid)
+	{
+		if (VertexToOut[vid] != IndexConstants::InvalidID)
+		{
+			Positions[FVertexID(VertexOffset + VertexToOut[vid])] = FVector3f(MeshIn.GetVertex(vid));
+		}
+	});
+
+	TVertexInstanceAttributesRef<FVector3f> Normals = Attributes.GetVertexInstanceNormals();
+	TVertexInstanceAttributesRef<FVector3f> Tangents = Attributes.GetVertexInstanceTangents();
+	TVertexInstanceAttributesRef<float> BinormalSigns = Attributes.GetVertexInstanceBinormalSigns();
+	TVertexInstanceAttributesRef<FVector2f> UVs = Attributes.GetVertexInstanceUVs();
+	TVertexInstanceAttributesRef<FVector4f> Colors = Attributes.GetVertexInstanceColors();
+	UVs.SetNumChannels(FMath::Max3(NumUVLayers, 1, bAppend ? UVs.GetNumChannels() : 0));
+	ParallelFor(NumInstances, [&](int32 Instance)
+	{
+		const FVertexInstanceID InstanceID(InstanceOffset + Instance);
+		const int32 vid = InstanceVertex[Instance];
+		const int32* Key = KeyWidth > 0 ? &InstanceKeys[Instance * KeyWidth] : nullptr;
+		int32 k = 0;
+
+		FVector3f Normal = MeshIn.HasVertexNormals() ? MeshIn.GetVertexNormal(vid) : FVector3f::ZeroVector;
+		if (NumNormalLayers > 0 && Key[0] != IndexConstants::InvalidID)
+		{
+			Normal = AttributesIn->GetNormalLayer(0)->GetElement(Key[0]);
+		}
+		Normals[InstanceID] = Normal;
+		if (NumNormalLayers == 3 && Key[1] != IndexConstants::InvalidID && Key[2] != IndexConstants::InvalidID)
+		{
+			const FVector3f Tangent = AttributesIn->GetNormalLayer(1)->GetElement(Key[1]);
+			const FVector3f Bitangent = AttributesIn->GetNormalLayer(2)->GetElement(Key[2]);
+			Tangents[InstanceID] = Tangent;
+			BinormalSigns[InstanceID] = FVector3f::DotProduct(FVector3f::CrossProduct(Normal, Tangent), Bitangent) < 0.0f ? -1.0f : 1.0f;
+		}
+		k += NumNormalLayers;
+
+		for (int32 Layer = 0; Layer < NumUVLayers; ++Layer, ++k)
+		{
+			UVs.Set(InstanceID, Layer, Key[k] != IndexConstants::InvalidID ? AttributesIn->GetUVLayer(Layer)->GetElement(Key[k]) : FVector2f::ZeroVector);
+		}
+		if (bHasColors)
+		{
+			Colors[InstanceID] = Key[k] != IndexConstants::InvalidID ? AttributesIn->PrimaryColors()->GetElement(Key[k]) : FVector4f::One();
+		}
+	});
+
+	if (bSetPolyGroups && MeshIn.HasTriangleGroups())
+	{
+		static const FName PolyTriGroupsName(TEXT("PolyTriGroups"));
+		if (MeshOut.TriangleAttributes().HasAttribute(PolyTriGroupsName) == false)
+		{
+			MeshOut.TriangleAttributes().RegisterAttribute<int32>(PolyTriGroupsName, 1, 0, EMeshAttributeFlags::AutoGenerated);
+		}
+		TTriangleAttributesRef<int32> PolyTriGroups = MeshOut.TriangleAttributes().GetAttributesRef<int32>(PolyTriGroupsName);
+		ParallelFor(Triangles.Num(), [&](int32 Idx)
+		{
+			PolyTriGroups[FTriangleID(TriangleOffset + Idx)] = MeshIn.GetTriangleGroup(Triangles[Idx]);
+		});
+	}
+	EndStage(Timings.AttributeTime);
+
+	if (OutTimings)
+	{
+		*OutTimings = Timings;
+	}
+}
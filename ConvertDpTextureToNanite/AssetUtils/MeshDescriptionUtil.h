@@ -9,6 +9,7 @@ class UStaticMesh;
 class UActorComponent;
 struct FMeshBuildSettings;
 struct FMeshDescription;
+namespace UE { namespace Geometry { class FDynamicMesh3; } }
 
 
 namespace UE
@@ -64,5 +65,36 @@ namespace UE
 		/** Utility function to apply build settings changes to a UStaticMesh */
 		 void ConfigureBuildSettings(UStaticMesh* StaticMesh, int32 SourceLOD,
 			FStaticMeshBuildSettingChange NewSettings);
+
+
+
+		//
+		// Fast conversion of large meshes
+		//
+
+		/** Time spent in each stage of ConvertDynamicMeshParallel, in milliseconds */
+		struct FParallelConversionTimings
+		{
+			/** Finding the vertex instances (unique vertex/overlay element combinations) */
+			double InstanceTime = 0;
+			/** Creating vertices, instances, polygon groups and triangles, which is serial */
+			double TopologyTime = 0;
+			/** Filling positions, normals, tangents, UVs, colors and polygroups */
+			double AttributeTime = 0;
+		};
+
+		/**
+		 * Replace the contents of a static mesh FMeshDescription with a FDynamicMesh3, for meshes with millions of triangles.
+		 * All element arrays are presized, vertex instances are found and all attributes are filled in parallel, and only
+		 * the element creation itself runs on one thread. One vertex instance is created per unique combination of vertex
+		 * and normal/tangent/UV/color elements, and one polygon group per material ID, which keeps the material slot
+		 * name the group with that index had before.
+		 * @param bSetPolyGroups also store the triangle groups in the PolyTriGroups triangle attribute
+		 * @param bAppend add MeshIn to the contents of MeshOut instead, e.g. to write a mesh built in chunks one chunk
+		 * at a time. MeshOut must have been written by this function, its element IDs have no holes then. Polygon 
+		 * groups are shared by material ID.
+		 */
+		 void ConvertDynamicMeshParallel(const UE::Geometry::FDynamicMesh3& MeshIn, FMeshDescription& MeshOut,
+			bool bSetPolyGroups, FParallelConversionTimings* OutTimings = nullptr, bool bAppend = false);
 	}
 }
\ No newline at end of file
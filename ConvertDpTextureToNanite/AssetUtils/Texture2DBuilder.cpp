@@ -1,10 +1,54 @@
 // Copyright Epic Games, Inc. All Rights Reserved. 
 
 #include "Texture2DBuilder.h"
+#include "TexturePixelConversion.h"
+#include "Async/ParallelFor.h"
 
 using namespace UE::Geometry;
 
 
+static void ConvertImageRow(const FVector4f* Source, int64 NumPixels, bool bConvertToSRGB, FColor* Dest)
+{
+	UE::AssetUtils::ConvertLinearPixels(Source, NumPixels, bConvertToSRGB, Dest);
+}
+
+static void ConvertImageRow(const FVector3f* Source, int64 NumPixels, bool bConvertToSRGB, FColor* Dest)
+{
+	UE::AssetUtils::ConvertLinearPixels(Source, NumPixels, bConvertToSRGB, Dest);
+}
+
+static void ConvertImageRow(const FVector4f* Source, int64 NumPixels, bool bConvertToSRGB, FFloat16Color* Dest)
+{
+	UE::AssetUtils::ConvertLinearPixels(Source, NumPixels, Dest);
+}
+
+static void ConvertImageRow(const FVector3f* Source, int64 NumPixels, bool bConvertToSRGB, FFloat16Color* Dest)
+{
+	UE::AssetUtils::ConvertLinearPixels(Source, NumPixels, Dest);
+}
+
+/**
+ * Convert SourceImage row by row in parallel, straight into the texel buffer Dest of the same dimensions.
+ * Row offsets are int64, images can have more than 2^31 texels.
+ */
+template<typename PixelType, typename TexelType>
+static void ConvertImageRows(const TImageBuilder<PixelType>& SourceImage, bool bConvertToSRGB, TexelType* Dest)
+{
+	const FImageDimensions Dimensions = SourceImage.GetDimensions();
+	if (Dimensions.Num() == 0)
+	{
+		return;
+	}
+
+	const int64 Width = Dimensions.GetWidth();
+	const PixelType* SourcePixels = &SourceImage.GetPixel(0);
+	ParallelFor(Dimensions.GetHeight(), [&](int32 y)
+	{
+		const int64 RowStart = y * Width;
+		ConvertImageRow(SourcePixels + RowStart, Width, bConvertToSRGB, Dest + RowStart);
+	});
+}
+
 
 bool FTexture2DBuilder::Initialize(ETextureType BuildTypeIn, FImageDimensions DimensionsIn)
 {
@@ -203,7 +247,7 @@ void FTexture2DBuilder::UpdateSourceData()
 			reinterpret_cast<const FColor*>(RawTexture2D->GetPlatformData()->Mips[0].BulkData.Lock(LOCK_READ_ONLY));
 		RawTexture2D->Source.Init2DWithMipChain(Dimensions.GetWidth(), Dimensions.GetHeight(), TSF_BGRA8);
 		uint8* DestData = RawTexture2D->Source.LockMip(0);
-		FMemory::Memcpy(DestData, SourceMipData, Dimensions.GetWidth() * Dimensions.GetHeight() * 4 * sizeof(uint8));
+		FMemory::Memcpy(DestData, SourceMipData, Dimensions.Num() * 4 * sizeof(uint8));
 	}
 	else
 	{
@@ -211,7 +255,7 @@ void FTexture2DBuilder::UpdateSourceData()
 			reinterpret_cast<const FFloat16Color*>(RawTexture2D->GetPlatformData()->Mips[0].BulkData.Lock(LOCK_READ_ONLY));
 		RawTexture2D->Source.Init2DWithMipChain(Dimensions.GetWidth(), Dimensions.GetHeight(), TSF_RGBA16F);
 		uint8* DestData = RawTexture2D->Source.LockMip(0);
-		FMemory::Memcpy((void*)DestData, (void*)SourceMipData, Dimensions.GetWidth() * Dimensions.GetHeight() * sizeof(FFloat16Color));
+		FMemory::Memcpy((void*)DestData, (void*)SourceMipData, Dimensions.Num() * sizeof(FFloat16Color));
 	}
 
 	RawTexture2D->Source.UnlockMip(0);
@@ -253,7 +297,7 @@ void FTexture2DBuilder::Clear(const FColor& ClearColor)
 {
 	if (ensure(IsEditable() && IsByteTexture()))
 	{
-		int32 Num = Dimensions.Num();
+		const int64 Num = Dimensions.Num();
 		for (int64 k = 0; k < Num; ++k)
 		{
 			CurrentMipData[k] = ClearColor;
@@ -268,7 +312,7 @@ void FTexture2DBuilder::Clear(const FFloat16Color& ClearColor)
 {
 	if (ensure(IsEditable() && IsFloat16Texture()))
 	{
-		int32 Num = Dimensions.Num();
+		const int64 Num = Dimensions.Num();
 		for (int64 k = 0; k < Num; ++k)
 		{
 			CurrentMipDataFloat16[k] = ClearColor;
@@ -288,23 +332,18 @@ bool FTexture2DBuilder::Copy(const TImageBuilder<FVector3f>& SourceImage, const
 		ensure(false);		// not currently supported
 	}
 
-	int64 Num = Dimensions.Num();
-	for (int32 i = 0; i < Num; ++i)
+	if (!ensure(IsEditable()))
 	{
-		FVector3f Pixel = SourceImage.GetPixel(i);
-		if (IsByteTexture())
-		{
-			Pixel.X = FMathf::Clamp(Pixel.X, 0.0, 1.0);
-			Pixel.Y = FMathf::Clamp(Pixel.Y, 0.0, 1.0);
-			Pixel.Z = FMathf::Clamp(Pixel.Z, 0.0, 1.0);
-			FColor Texel = ToLinearColor(Pixel).ToFColor(bConvertToSRGB);
-			SetTexel(i, Texel);
-		}
-		else
-		{
-			FFloat16Color Texel(ToLinearColor(Pixel));
-			SetTexel(i, Texel);
-		}
+		return false;
+	}
+
+	if (IsByteTexture())
+	{
+		ConvertImageRows(SourceImage, bConvertToSRGB, CurrentMipData);
+	}
+	else
+	{
+		ConvertImageRows(SourceImage, false, CurrentMipDataFloat16);
 	}
 	return true;
 }
@@ -321,24 +360,18 @@ bool FTexture2DBuilder::Copy(const TImageBuilder<FVector4f>& SourceImage, const
 		ensure(false);		// not currently supported
 	}
 
-	int64 Num = Dimensions.Num();
-	for (int32 i = 0; i < Num; ++i)
+	if (!ensure(IsEditable()))
 	{
-		FVector4f Pixel = SourceImage.GetPixel(i);
-		if (IsByteTexture())
-		{
-			Pixel.X = FMathf::Clamp(Pixel.X, 0.0, 1.0);
-			Pixel.Y = FMathf::Clamp(Pixel.Y, 0.0, 1.0);
-			Pixel.Z = FMathf::Clamp(Pixel.Z, 0.0, 1.0);
-			Pixel.W = FMathf::Clamp(Pixel.W, 0.0, 1.0);
-			FColor Texel = ToLinearColor(Pixel).ToFColor(bConvertToSRGB);
-			SetTexel(i, Texel);
-		}
-		else
-		{
-			FFloat16Color Texel(ToLinearColor(Pixel));
-			SetTexel(i, Texel);
-		}
+		return false;
+	}
+
+	if (IsByteTexture())
+	{
+		ConvertImageRows(SourceImage, bConvertToSRGB, CurrentMipData);
+	}
+	else
+	{
+		ConvertImageRows(SourceImage, false, CurrentMipDataFloat16);
 	}
 	return true;
 }
@@ -371,35 +404,26 @@ bool FTexture2DBuilder::CopyImageToSourceData(const TImageBuilder<FVector4f>& So
 
 	RawTexture2D->Source.Init2DWithMipChain(Dimensions.GetWidth(), Dimensions.GetHeight(), SourceDataFormat);
 
-	const int64 Num = Dimensions.Num();
+	uint8* DestData = RawTexture2D->Source.LockMip(0);
+	if (!ensure(DestData))
+	{
+		return false;
+	}
+
 	if (SourceDataFormat == TSF_BGRA8)
 	{
-		FColor* DestData = reinterpret_cast<FColor*>(RawTexture2D->Source.LockMip(0));
-		for (int32 i = 0; i < Num; ++i)
-		{
-			FVector4f Pixel = SourceImage.GetPixel(i);
-			Pixel.X = FMathf::Clamp(Pixel.X, 0.0, 1.0);
-			Pixel.Y = FMathf::Clamp(Pixel.Y, 0.0, 1.0);
-			Pixel.Z = FMathf::Clamp(Pixel.Z, 0.0, 1.0);
-			Pixel.W = FMathf::Clamp(Pixel.W, 0.0, 1.0);
-			const FColor Texel = ToLinearColor(Pixel).ToFColor(bConvertToSRGB);
-			DestData[i] = Texel;
-		}
+		ConvertImageRows(SourceImage, bConvertToSRGB, reinterpret_cast<FColor*>(DestData));
 	}
 	else if (SourceDataFormat == TSF_RGBA16F)
 	{
-		FFloat16Color* DestData = reinterpret_cast<FFloat16Color*>(RawTexture2D->Source.LockMip(0));
-		for (int32 i = 0; i < Num; ++i)
-		{
-			FVector4f Pixel = SourceImage.GetPixel(i);
-			const FFloat16Color Texel(ToLinearColor(Pixel));
-			DestData[i] = Texel;
-		}
+		ConvertImageRows(SourceImage, false, reinterpret_cast<FFloat16Color*>(DestData));
 	}
 
 	RawTexture2D->Source.UnlockMip(0);
-#endif
+	return true;
+#else
 	return false;
+#endif
 }
 
 
@@ -411,7 +435,7 @@ bool FTexture2DBuilder::CopyTo(TImageBuilder<FVector4f>& DestImage) const
 		return false;
 	}
 	int64 Num = Dimensions.Num();
-	for (int32 i = 0; i < Num; ++i)
+	for (int64 i = 0; i < Num; ++i)
 	{
 		if (IsByteTexture())
 		{
@@ -223,7 +223,7 @@ public:
 	void SetTexel(int64 LinearIndex, const FColor& NewValue)
 	{
 		checkSlow(IsEditable() && IsByteTexture());
-		SetTexel(Dimensions.GetCoords(LinearIndex), NewValue);
+		CurrentMipData[LinearIndex] = NewValue;
 	}
 
 
@@ -244,7 +244,7 @@ public:
 	void SetTexel(int64 LinearIndex, const FFloat16Color& NewValue)
 	{
 		checkSlow(IsEditable() && IsFloat16Texture());
-		SetTexel(Dimensions.GetCoords(LinearIndex), NewValue);
+		CurrentMipDataFloat16[LinearIndex] = NewValue;
 	}
 
 
@@ -266,22 +266,23 @@ public:
 
 
 	/**
-	 * populate texel values from floating-point SourceImage
+	 * populate texel values from floating-point SourceImage, converted row by row in parallel into the locked Mip
 	 * @param bConvertToSRGB if true, SourceImage is assumed to be Linear, and converted to SRGB for the Texture
 	 */
 	bool Copy(const TImageBuilder<FVector3f>& SourceImage, const bool bConvertToSRGB = false);
 
 	/**
-	 * Populate texel values from floating-point SourceImage.
+	 * Populate texel values from floating-point SourceImage, converted row by row in parallel into the locked Mip.
 	 * @param bConvertToSRGB if true, SourceImage is assumed to be Linear, and converted to SRGB for the Texture
 	 */
 	bool Copy(const TImageBuilder<FVector4f>& SourceImage, const bool bConvertToSRGB = false);
 
 	/**
-	 * Populate Source Data texel values from a floating point SourceImage
+	 * Populate Source Data texel values from a floating point SourceImage, converted row by row in parallel into the locked Source Mip
 	 * @param SourceImage the image to copy to source data
 	 * @param SourceDataFormat the texture format for the Source Data
 	 * @param bConvertToSRGB if true, SourceImage is assumed to be Linear, and converted to SRGB for the Texture
+	 * @return false if the Source Data could not be written, always the case outside the Editor
 	 */
 	bool CopyImageToSourceData(const TImageBuilder<FVector4f>& SourceImage, const ETextureSourceFormat SourceDataFormat, const bool bConvertToSRGB = false);
 
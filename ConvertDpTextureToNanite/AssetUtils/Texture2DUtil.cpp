@@ -1,26 +1,308 @@
 // Copyright Epic Games, Inc. All Rights Reserved. 
 
 #include "Texture2DUtil.h"
+#include "TexturePixelConversion.h"
 #include "EngineModule.h"
 #include "RendererInterface.h"
 #include "RenderUtils.h"
+#include "PixelFormat.h"
+#include "Async/ParallelFor.h"
 
 #include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
 
 using namespace UE::Geometry;
 
-static bool ReadTexture_PlatformData(
+/** Decode a 4x4 BC1 (DXT1) block into its 16 colors, in row order */
+static void DecodeBC1Block(const uint8* Block, FColor OutColors[16])
+{
+	auto Expand565 = [](const uint32 Color)
+	{
+		const uint32 R = (Color >> 11) & 31;
+		const uint32 G = (Color >> 5) & 63;
+		const uint32 B = Color & 31;
+		return FColor((uint8)((R << 3) | (R >> 2)), (uint8)((G << 2) | (G >> 4)), (uint8)((B << 3) | (B >> 2)), 255);
+	};
+	auto Lerp = [](const FColor& A, const FColor& B, const uint32 WeightA, const uint32 WeightB)
+	{
+		const uint32 Sum = WeightA + WeightB;
+		return FColor((uint8)((WeightA * A.R + WeightB * B.R + Sum / 2) / Sum),
+					  (uint8)((WeightA * A.G + WeightB * B.G + Sum / 2) / Sum),
+					  (uint8)((WeightA * A.B + WeightB * B.B + Sum / 2) / Sum), 255);
+	};
+
+	const uint32 Color0 = Block[0] | (Block[1] << 8);
+	const uint32 Color1 = Block[2] | (Block[3] << 8);
+	FColor Palette[4];
+	Palette[0] = Expand565(Color0);
+	Palette[1] = Expand565(Color1);
+	if (Color0 > Color1)
+	{
+		Palette[2] = Lerp(Palette[0], Palette[1], 2, 1);
+		Palette[3] = Lerp(Palette[0], Palette[1], 1, 2);
+	}
+	else
+	{
+		Palette[2] = Lerp(Palette[0], Palette[1], 1, 1);
+		Palette[3] = FColor(0, 0, 0, 0);
+	}
+
+	const uint32 Indices = Block[4] | (Block[5] << 8) | (Block[6] << 16) | ((uint32)Block[7] << 24);
+	for (int32 i = 0; i < 16; ++i)
+	{
+		OutColors[i] = Palette[(Indices >> (2 * i)) & 3];
+	}
+}
+
+/** Decode a 4x4 BC4 block (or one channel of a BC5 block) into its 16 values, in row order */
+static void DecodeBC4Block(const uint8* Block, uint8 OutValues[16])
+{
+	const uint32 Value0 = Block[0];
+	const uint32 Value1 = Block[1];
+	uint8 Palette[8];
+	Palette[0] = (uint8)Value0;
+	Palette[1] = (uint8)Value1;
+	if (Value0 > Value1)
+	{
+		for (uint32 k = 1; k < 7; ++k)
+		{
+			Palette[k + 1] = (uint8)(((7 - k) * Value0 + k * Value1 + 3) / 7);
+		}
+	}
+	else
+	{
+		for (uint32 k = 1; k < 5; ++k)
+		{
+			Palette[k + 1] = (uint8)(((5 - k) * Value0 + k * Value1 + 2) / 5);
+		}
+		Palette[6] = 0;
+		Palette[7] = 255;
+	}
+
+	uint64 Indices = 0;
+	for (int32 b = 0; b < 6; ++b)
+	{
+		Indices |= (uint64)Block[2 + b] << (8 * b);
+	}
+	for (int32 i = 0; i < 16; ++i)
+	{
+		OutValues[i] = Palette[(Indices >> (3 * i)) & 7];
+	}
+}
+
+static bool IsDirectlyReadablePixelFormat(const EPixelFormat Format)
+{
+	switch (Format)
+	{
+	case PF_B8G8R8A8:
+	case PF_R8G8B8A8:
+	case PF_G8:
+	case PF_G16:
+	case PF_A16B16G16R16:
+	case PF_R16F:
+	case PF_FloatRGBA:
+	case PF_A32B32G32R32F:
+	case PF_DXT1:
+	case PF_BC4:
+	case PF_BC5:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * Decode one row of blocks (of pixels, for the uncompressed formats) of a platform mip. Like the G8/G16 formats, the 
+ * single channel formats (R16F, BC4) are replicated to RGB, so that any channel can be sampled. The two channel BC5 
+ * gets a blue of 1, a blue mask channel keeps everything as it would for a texture without one.
+ * @param NumRows pixel rows to write, the block height or less on the last row of blocks
+ * @param Dest NumRows x Width pixels, row by row
+ */
+static void DecodePlatformBlockRow(
+	const EPixelFormat Format,
+	const bool bSRGB,
+	const uint8* RowData,
+	const int32 Width,
+	const int32 NumRows,
+	FVector4f* Dest)
+{
+	const FPixelFormatInfo& FormatInfo = GPixelFormats[Format];
+	const int64 BlockBytes = FormatInfo.BlockBytes;
+	auto ToLinear = [bSRGB](const FColor& Color)
+	{
+		return ToVector4<float>(bSRGB ? FLinearColor::FromSRGBColor(Color) : Color.ReinterpretAsLinear());
+	};
+
+	if (FormatInfo.BlockSizeX == 1)
+	{
+		for (int32 x = 0; x < Width; ++x)
+		{
+			const uint8* PixelData = RowData + x * BlockBytes;
+			FVector4f Value;
+			switch (Format)
+			{
+			case PF_B8G8R8A8:
+				Value = ToLinear(*reinterpret_cast<const FColor*>(PixelData));
+				break;
+			case PF_R8G8B8A8:
+				Value = ToLinear(FColor(PixelData[0], PixelData[1], PixelData[2], PixelData[3]));
+				break;
+			case PF_G8:
+				Value = ToLinear(FColor(PixelData[0], PixelData[0], PixelData[0], 255));
+				break;
+			case PF_G16:
+			{
+				const float Gray = *reinterpret_cast<const uint16*>(PixelData) / 65535.0f;
+				Value = FVector4f(Gray, Gray, Gray, 1.0f);
+				break;
+			}
+			case PF_A16B16G16R16:
+			{
+				const uint16* Channels = reinterpret_cast<const uint16*>(PixelData);
+				Value = FVector4f(Channels[0] / 65535.0f, Channels[1] / 65535.0f, Channels[2] / 65535.0f, Channels[3] / 65535.0f);
+				break;
+			}
+			case PF_R16F:
+			{
+				const float Red = reinterpret_cast<const FFloat16*>(PixelData)->GetFloat();
+				Value = FVector4f(Red, Red, Red, 1.0f);
+				break;
+			}
+			case PF_FloatRGBA:
+				Value = ToVector4<float>(reinterpret_cast<const FFloat16Color*>(PixelData)->GetFloats());
+				break;
+			default: // PF_A32B32G32R32F
+				Value = ToVector4<float>(*reinterpret_cast<const FLinearColor*>(PixelData));
+				break;
+			}
+			Dest[x] = Value;
+		}
+		return;
+	}
+
+	const int32 NumBlocksX = FMath::DivideAndRoundUp(Width, FormatInfo.BlockSizeX);
+	for (int32 BlockX = 0; BlockX < NumBlocksX; ++BlockX)
+	{
+		const uint8* BlockData = RowData + BlockX * BlockBytes;
+		FVector4f Texels[16];
+		if (Format == PF_DXT1)
+		{
+			FColor Colors[16];
+			DecodeBC1Block(BlockData, Colors);
+			for (int32 i = 0; i < 16; ++i)
+			{
+				Texels[i] = ToLinear(Colors[i]);
+			}
+		}
+		else if (Format == PF_BC4)
+		{
+			uint8 Values[16];
+			DecodeBC4Block(BlockData, Values);
+			for (int32 i = 0; i < 16; ++i)
+			{
+				const float Red = Values[i] / 255.0f;
+				Texels[i] = FVector4f(Red, Red, Red, 1.0f);
+			}
+		}
+		else // PF_BC5, red then green block
+		{
+			uint8 Reds[16], Greens[16];
+			DecodeBC4Block(BlockData, Reds);
+			DecodeBC4Block(BlockData + 8, Greens);
+			for (int32 i = 0; i < 16; ++i)
+			{
+				Texels[i] = FVector4f(Reds[i] / 255.0f, Greens[i] / 255.0f, 1.0f, 1.0f);
+			}
+		}
+
+		// the blocks on the last row and column can overhang the mip
+		for (int32 i = 0; i < 16; ++i)
+		{
+			const int32 x = BlockX * 4 + (i % 4);
+			const int32 y = i / 4;
+			if (x < Width && y < NumRows)
+			{
+				Dest[(int64)y * Width + x] = Texels[i];
+			}
+		}
+	}
+}
+
+/** @return the top mip of the platform data if it can be decoded directly and is resident, nullptr otherwise */
+static FTexture2DMipMap* GetDirectlyReadableMip(UTexture2D* TextureMap)
+{
+	FTexturePlatformData* PlatformData = TextureMap->GetPlatformData();
+	if (PlatformData == nullptr || PlatformData->Mips.Num() == 0 || IsDirectlyReadablePixelFormat(PlatformData->PixelFormat) == false)
+	{
+		return nullptr;
+	}
+
+	FTexture2DMipMap& Mip = PlatformData->Mips[0];
+	const FPixelFormatInfo& FormatInfo = GPixelFormats[PlatformData->PixelFormat];
+	const int64 NumBlocksX = FMath::DivideAndRoundUp(Mip.SizeX, FormatInfo.BlockSizeX);
+	const int64 NumBlocksY = FMath::DivideAndRoundUp(Mip.SizeY, FormatInfo.BlockSizeY);
+	if (Mip.SizeX <= 0 || Mip.SizeY <= 0 || Mip.BulkData.GetBulkDataSize() < NumBlocksX * NumBlocksY * FormatInfo.BlockBytes)
+	{
+		return nullptr;
+	}
+	return &Mip;
+}
+
+/**
+ * Decode the built top mip of the platform data as it is, without rebuilding the texture. Only reads the texture,
+ * so it can run on any thread.
+ * @return false if the pixel format is not supported or the mip data is not resident, DestImage is undefined then
+ */
+static bool ReadTexture_PlatformMip(
 	UTexture2D* TextureMap,
 	TImageBuilder<FVector4f>& DestImage)
 {
-	// Read from PlatformData
-	// UBlueprintMaterialTextureNodesBPLibrary::Texture2D_SampleUV_EditorOnly() shows how to read from PlatformData
-	// without converting formats if it's already uncompressed. And can read PF_FloatRGBA. Would make sense to do
-	// that when possible, and perhaps is possible to convert to PF_FloatRGBA instead of using TC_VectorDisplacementmap?
-	// 
-	// Note that the current code cannot run on a background thread, UpdateResource() will call FlushRenderingCommands()
-	// which will check() if it's on the Game Thread
+	FTexture2DMipMap* Mip = GetDirectlyReadableMip(TextureMap);
+	if (Mip == nullptr)
+	{
+		return false;
+	}
+
+	const uint8* MipData = reinterpret_cast<const uint8*>(Mip->BulkData.LockReadOnly());
+	if (MipData == nullptr)
+	{
+		Mip->BulkData.Unlock();
+		return false;
+	}
+
+	const EPixelFormat Format = TextureMap->GetPlatformData()->PixelFormat;
+	const FPixelFormatInfo& FormatInfo = GPixelFormats[Format];
+	const int32 Width = Mip->SizeX;
+	const int32 Height = Mip->SizeY;
+	const int64 BlockRowBytes = (int64)FMath::DivideAndRoundUp(Width, FormatInfo.BlockSizeX) * FormatInfo.BlockBytes;
+	DestImage.SetDimensions(FImageDimensions(Width, Height));
+	FVector4f* DestPixels = const_cast<FVector4f*>(&DestImage.GetPixel(0));
+
+	// one row of blocks per task, straight into the image storage
+	ParallelFor(FMath::DivideAndRoundUp(Height, FormatInfo.BlockSizeY), [&](int32 BlockY)
+	{
+		const int32 FirstRow = BlockY * FormatInfo.BlockSizeY;
+		DecodePlatformBlockRow(Format, TextureMap->SRGB, MipData + BlockY * BlockRowBytes, Width,
+			FMath::Min(FormatInfo.BlockSizeY, Height - FirstRow), DestPixels + (int64)FirstRow * Width);
+	});
+
+	Mip->BulkData.Unlock();
+	return true;
+}
+
+/**
+ * Read the platform data by rebuilding the texture as uncompressed RGBA8 and restoring it afterwards. Two texture 
+ * rebuilds and render thread flushes, only for the pixel formats ReadTexture_PlatformMip() does not decode.
+ */
+static bool ReadTexture_PlatformDataRebuild(
+	UTexture2D* TextureMap,
+	TImageBuilder<FVector4f>& DestImage)
+{
+	// UpdateResource() calls FlushRenderingCommands(), which will check() if it's not on the Game Thread
+	if (ensureMsgf(IsInGameThread(), TEXT("Reading texture %s requires the game thread, its pixel format is not decoded directly"), *TextureMap->GetName()) == false)
+	{
+		return false;
+	}
 
 	check(TextureMap->GetPlatformData());
 	const int32 Width = TextureMap->GetPlatformData()->Mips[0].SizeX;
@@ -64,6 +346,17 @@ static bool ReadTexture_PlatformData(
 	return true;
 }
 
+static bool ReadTexture_PlatformData(
+	UTexture2D* TextureMap,
+	TImageBuilder<FVector4f>& DestImage)
+{
+	if (ReadTexture_PlatformMip(TextureMap, DestImage))
+	{
+		return true;
+	}
+	return ReadTexture_PlatformDataRebuild(TextureMap, DestImage);
+}
+
 
 #if WITH_EDITOR
 static bool ReadTexture_SourceData(
@@ -78,81 +371,27 @@ static bool ReadTexture_SourceData(
 	DestImage.SetDimensions(Dimensions);
 	const int64 Num = Dimensions.Num();
 
-	TArray64<uint8> SourceData;
-	TextureMap->Source.GetMipData(SourceData, 0, 0, 0);
 	const ETextureSourceFormat SourceFormat = TextureSource.GetFormat();
-	const int32 BytesPerPixel = TextureSource.GetBytesPerPixel();
-	const uint8* SourceDataPtr = SourceData.GetData();
-
-	// code below is derived from UBlueprintMaterialTextureNodesBPLibrary::Texture2D_SampleUV_EditorOnly()
-	if ((SourceFormat == TSF_BGRA8 || SourceFormat == TSF_BGRE8))
+	if (UE::AssetUtils::CanConvertSourceFormat(SourceFormat) == false)
 	{
-		check(BytesPerPixel == sizeof(FColor));
-		for (int64 i = 0; i < Num; ++i)
-		{
-			const uint8* PixelPtr = SourceDataPtr + (i * BytesPerPixel);
-			FColor PixelColor = *((FColor*)PixelPtr);
-
-			FLinearColor FloatColor = (TextureMap->SRGB) ?
-				FLinearColor::FromSRGBColor(PixelColor) :
-				PixelColor.ReinterpretAsLinear();
-
-			DestImage.SetPixel(i, ToVector4<float>(FloatColor));
-		}
+		// a valid source the converters do not handle (e.g. TSF_R16F, TSF_RGBA32F), not a broken asset
+		UE_LOG(LogTemp, Warning, TEXT("2K_DpRA ReadTexture: unsupported source format %d of %s"), (int32)SourceFormat, *TextureMap->GetName());
+		return false;
 	}
-	// code below is also derived from FImage::CopyTo (CopyImage) - invoked during BuildTexture on import.
-	else if (SourceFormat == TSF_RGBA16)
+	if (ensure(TextureSource.CalcMipSize(0, 0, 0) >= Num * TextureSource.GetBytesPerPixel()) == false)
 	{
-		check(BytesPerPixel == sizeof(uint16) * 4);
-		for (int64 i = 0; i < Num; ++i)
-		{
-			const uint8* SourcePtr = SourceDataPtr + (i * BytesPerPixel);
-			const uint16* PixelPtr = (const uint16*)SourcePtr;
-			DestImage.SetPixel(i, FVector4f(
-				PixelPtr[0] / 65535.0f,
-				PixelPtr[1] / 65535.0f,
-				PixelPtr[2] / 65535.0f,
-				PixelPtr[3] / 65535.0f
-				));
-		}
-	}
-	else if (SourceFormat == TSF_RGBA16F)
-	{
-		check(BytesPerPixel == sizeof(FFloat16Color));
-		for (int64 i = 0; i < Num; ++i)
-		{
-			const uint8* PixelPtr = SourceDataPtr + (i * BytesPerPixel);
-			FLinearColor LinearColor = ((const FFloat16Color*)PixelPtr)->GetFloats();
-			DestImage.SetPixel(i, ToVector4<float>(LinearColor) );
-		}
+		return false;
 	}
-	else if ((SourceFormat == TSF_G16))
+
+	// converted row by row in parallel from the locked mip straight into DestImage, the mip is not copied
+	const uint8* SourceData = TextureSource.LockMipReadOnly(0, 0, 0);
+	if (SourceData == nullptr)
 	{
-		check(BytesPerPixel == 2);
-		for (int64 i = 0; i < Num; ++i)
-		{
-			const uint8* PixelPtr = SourceDataPtr + (i * BytesPerPixel);
-			const uint16 ByteColor = *((const uint16*)PixelPtr);
-			const float FloatColor = float(ByteColor) / 65535.0f;
-			DestImage.SetPixel(i, FVector4f(FloatColor, FloatColor, FloatColor, 1.0));
-		}
+		return false;
 	}
-	else if (SourceFormat == TSF_G8)
-	{
-		check(BytesPerPixel == 1);
-		for (int64 i = 0; i < Num; ++i)
-		{
-			const uint8* PixelPtr = SourceDataPtr + (i * BytesPerPixel);
-			const uint8 PixelColor = *PixelPtr;
-			const float PixelColorf = float(PixelColor) / 255.0f;
-			FLinearColor FloatColor = (TextureMap->SRGB) ?
-				FLinearColor::FromSRGBColor(FColor(PixelColor, PixelColor, PixelColor, 255)) :
-				FLinearColor(PixelColorf, PixelColorf, PixelColorf, 1.0);
-			DestImage.SetPixel(i, ToVector4<float>(FloatColor));
-		}
-	}
-
-	return true;
+	const bool bConverted = UE::AssetUtils::ConvertSourceImage(SourceFormat, TextureMap->SRGB, SourceData, Dimensions, DestImage);
+	TextureSource.UnlockMip(0, 0, 0);
+	return bConverted;
 }
 #endif 
 
@@ -180,6 +419,180 @@ bool UE::AssetUtils::ReadTexture(
 
 
 
+bool UE::AssetUtils::FTextureChannelReader::Initialize(UTexture2D* TextureMap, const bool bPreferPlatformData)
+{
+	Reset();
+	if (ensure(TextureMap) == false) return false;
+	bSRGB = TextureMap->SRGB;
+
+#if WITH_EDITOR
+	const bool bHasMips = TextureMap->GetPlatformData()->Mips.Num() != 0;
+	if (TextureMap->Source.IsValid() && (bPreferPlatformData == false || bHasMips == false) && CanConvertSourceFormat(TextureMap->Source.GetFormat()))
+	{
+		FTextureSource& TextureSource = TextureMap->Source;
+		Dimensions = FImageDimensions(TextureSource.GetSizeX(), TextureSource.GetSizeY());
+		SourceFormat = TextureSource.GetFormat();
+		DataSize = TextureSource.CalcMipSize(0, 0, 0);
+		Data = TextureSource.LockMipReadOnly(0, 0, 0);
+		LockedTexture = (Data != nullptr) ? TextureMap : nullptr;
+		Storage = EStorage::SourceData;
+		if (Data == nullptr || ensure(DataSize >= Dimensions.Num() * TextureSource.GetBytesPerPixel()) == false)
+		{
+			Reset();
+			return false;
+		}
+		return true;
+	}
+#endif
+
+	if (FTexture2DMipMap* Mip = GetDirectlyReadableMip(TextureMap))
+	{
+		PixelFormat = TextureMap->GetPlatformData()->PixelFormat;
+		Dimensions = FImageDimensions(Mip->SizeX, Mip->SizeY);
+		DataSize = Mip->BulkData.GetBulkDataSize();
+		Data = reinterpret_cast<const uint8*>(Mip->BulkData.LockReadOnly());
+		LockedTexture = TextureMap;
+		Storage = EStorage::PlatformMip;
+		if (Data != nullptr)
+		{
+			return true;
+		}
+		Reset();
+	}
+
+	if (ReadTexture(TextureMap, Image, bPreferPlatformData) == false)
+	{
+		return false;
+	}
+	Dimensions = Image.GetDimensions();
+	Storage = EStorage::Image;
+	return true;
+}
+
+
+bool UE::AssetUtils::FTextureChannelReader::CanReadOnAnyThread(UTexture2D* TextureMap, const bool bPreferPlatformData)
+{
+	if (TextureMap == nullptr || TextureMap->GetPlatformData() == nullptr)
+	{
+		return false;
+	}
+
+#if WITH_EDITOR
+	const bool bHasMips = TextureMap->GetPlatformData()->Mips.Num() != 0;
+	if (TextureMap->Source.IsValid() && (bPreferPlatformData == false || bHasMips == false) && CanConvertSourceFormat(TextureMap->Source.GetFormat()))
+	{
+		return true;
+	}
+#endif
+
+	return GetDirectlyReadableMip(TextureMap) != nullptr;
+}
+
+
+void UE::AssetUtils::FTextureChannelReader::Reset()
+{
+	if (LockedTexture != nullptr)
+	{
+		if (Storage == EStorage::PlatformMip)
+		{
+			LockedTexture->GetPlatformData()->Mips[0].BulkData.Unlock();
+		}
+#if WITH_EDITOR
+		else if (Storage == EStorage::SourceData)
+		{
+			LockedTexture->Source.UnlockMip(0, 0, 0);
+		}
+#endif
+	}
+	LockedTexture = nullptr;
+	Data = nullptr;
+	DataSize = 0;
+	Storage = EStorage::None;
+	Dimensions = FImageDimensions();
+	Image = TImageBuilder<FVector4f>();
+}
+
+
+void UE::AssetUtils::FTextureChannelReader::ReadRows(int32 Channel, int32 FirstY, int32 NumRows, float* OutValues) const
+{
+	const int64 Width = Dimensions.GetWidth();
+	switch (Storage)
+	{
+	case EStorage::SourceData:
+	{
+		// the rows are contiguous, the band converts in one go
+		const int64 BytesPerPixel = DataSize / FMath::Max(Dimensions.Num(), (int64)1);
+		ConvertSourceChannel(SourceFormat, bSRGB, Channel, Data + FirstY * Width * BytesPerPixel, NumRows * Width, OutValues);
+		break;
+	}
+	case EStorage::PlatformMip:
+	{
+		// decode whole rows of blocks, compressed formats cannot be decoded a pixel row at a time. One block row 
+		// buffer serves the whole band.
+		const FPixelFormatInfo& FormatInfo = GPixelFormats[PixelFormat];
+		const int64 BlockRowBytes = (int64)FMath::DivideAndRoundUp((int32)Width, FormatInfo.BlockSizeX) * FormatInfo.BlockBytes;
+		const int32 EndY = FirstY + NumRows;
+		TArray<FVector4f> Pixels;
+		Pixels.SetNumUninitialized(FormatInfo.BlockSizeY * Width);
+		for (int32 Y = FirstY; Y < EndY;)
+		{
+			const int32 BlockY = Y / FormatInfo.BlockSizeY;
+			const int32 BlockFirstRow = BlockY * FormatInfo.BlockSizeY;
+			const int32 NumBlockRows = FMath::Min(FormatInfo.BlockSizeY, Dimensions.GetHeight() - BlockFirstRow);
+			DecodePlatformBlockRow(PixelFormat, bSRGB, Data + BlockY * BlockRowBytes, (int32)Width, NumBlockRows, Pixels.GetData());
+			for (const int32 BlockEndY = FMath::Min(BlockFirstRow + NumBlockRows, EndY); Y < BlockEndY; ++Y)
+			{
+				const FVector4f* RowPixels = Pixels.GetData() + (Y - BlockFirstRow) * Width;
+				float* RowValues = OutValues + (Y - FirstY) * Width;
+				for (int64 x = 0; x < Width; ++x)
+				{
+					RowValues[x] = RowPixels[x][Channel];
+				}
+			}
+		}
+		break;
+	}
+	case EStorage::Image:
+	{
+		const int64 FirstIndex = FirstY * Width;
+		for (int64 i = 0; i < NumRows * Width; ++i)
+		{
+			OutValues[i] = Image.GetPixel(FirstIndex + i)[Channel];
+		}
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+
+bool UE::AssetUtils::FTextureChannelReader::HasUnorm8Values() const
+{
+	if (bSRGB)
+	{
+		return false;
+	}
+	switch (Storage)
+	{
+	case EStorage::SourceData:
+		return SourceFormat == TSF_G8 || SourceFormat == TSF_BGRA8;
+	case EStorage::PlatformMip:
+		return PixelFormat == PF_B8G8R8A8 || PixelFormat == PF_R8G8B8A8 || PixelFormat == PF_G8 || 
+			PixelFormat == PF_DXT1 || PixelFormat == PF_BC4 || PixelFormat == PF_BC5;
+	default:
+		// the image may hold a float source
+		return false;
+	}
+}
+
+
+SIZE_T UE::AssetUtils::FTextureChannelReader::GetAllocatedSize() const
+{
+	return DataSize + Dimensions.Num() * (Storage == EStorage::Image ? sizeof(FVector4f) : 0);
+}
+
+
 bool UE::AssetUtils::ConvertToSingleChannel(UTexture2D* TextureMap)
 {
 	if (ensure(TextureMap) == false) return false;
@@ -7,6 +7,7 @@
 #include "Image/ImageBuilder.h"
 #include "Engine/Texture2D.h"
 #include "Math/Color.h"
+#include "PixelFormat.h"
 
 
 
@@ -22,6 +23,9 @@ namespace AssetUtils
 	 * @param TextureMap the texture map to read
 	 * @param DestImageOut the result of the texture read
 	 * @param bPreferPlatformData if true, platform data will be returned even in-Editor.
+	 * Platform data in uncompressed 8/16 bit, float, BC1, BC4 or BC5 formats is decoded straight from the built top
+	 * mip, without modifying the texture, and can be read on any thread. Other formats are read by temporarily
+	 * rebuilding the texture uncompressed, which requires the game thread.
 	 * @return true on success
 	 */
 	 bool ReadTexture(
@@ -29,6 +33,82 @@ namespace AssetUtils
 		TImageBuilder<FVector4f>& DestImageOut,
 		const bool bPreferPlatformData = false);
 
+	/**
+	 * Reads single channels of a texture in bands of rows, for building compact per-channel fields without decoding 
+	 * the whole texture into a TImageBuilder<FVector4f> (16 bytes per pixel). The texture data is not copied: the 
+	 * source mip, or the built top mip for the platform formats ReadTexture() decodes directly, stays locked read-only
+	 * in its stored format while the reader exists, and each band is decoded on demand into the caller's buffer.
+	 * Only compressed (PNG/JPEG) source data is decompressed once by the lock. Other platform formats are read with 
+	 * ReadTexture() into a float image, so they take as much memory as before.
+	 * The memory is not bounded by the bands: Initialize() locks the whole mip, since neither FTextureSource nor the
+	 * mip bulk data can lock or decompress part of a mip. Reading in bands only bounds the decoded floats.
+	 * Same source selection and values as ReadTexture(). The texture must outlive the reader.
+	 */
+	class FTextureChannelReader
+	{
+	public:
+		FTextureChannelReader() = default;
+		FTextureChannelReader(const FTextureChannelReader&) = delete;
+		FTextureChannelReader& operator=(const FTextureChannelReader&) = delete;
+
+		~FTextureChannelReader()
+		{
+			Reset();
+		}
+
+		/** @return false if the texture cannot be read */
+		bool Initialize(UTexture2D* TextureMap, const bool bPreferPlatformData = false);
+
+		/**
+		 * @return true if Initialize() reads the texture data as it is, which works on any thread. Otherwise it falls 
+		 * back to rebuilding the texture, which requires the game thread.
+		 */
+		static bool CanReadOnAnyThread(UTexture2D* TextureMap, const bool bPreferPlatformData = false);
+
+		/** Unlock the texture data */
+		void Reset();
+
+		FImageDimensions GetDimensions() const
+		{
+			return Dimensions;
+		}
+
+		/**
+		 * Decode Channel (0..3 = RGBA) of rows FirstY..FirstY+NumRows-1 into OutValues, Width values per row. 
+		 * Compressed block rows are decoded once per call, so bands aligned to 4 rows decode each block once.
+		 * Can be called concurrently.
+		 */
+		void ReadRows(int32 Channel, int32 FirstY, int32 NumRows, float* OutValues) const;
+
+		/**
+		 * @return true if every value ReadRows() returns is an 8 bit unorm value k/255: the data read is 8 bits per 
+		 * channel and is not converted from sRGB
+		 */
+		bool HasUnorm8Values() const;
+
+		/** @return bytes of texture data locked or decoded by the reader */
+		SIZE_T GetAllocatedSize() const;
+
+	private:
+		enum class EStorage : uint8
+		{
+			None,
+			SourceData,
+			PlatformMip,
+			Image
+		};
+
+		EStorage Storage = EStorage::None;
+		FImageDimensions Dimensions;
+		bool bSRGB = false;
+		ETextureSourceFormat SourceFormat = TSF_Invalid;
+		EPixelFormat PixelFormat = PF_Unknown;
+		UTexture2D* LockedTexture = nullptr;
+		const uint8* Data = nullptr;
+		int64 DataSize = 0;
+		TImageBuilder<FVector4f> Image;
+	};
+
 	/**
 	 * Convert input UTexture2D to single-channel. Assumption is it has more than one channel. Red channel is used.
 	 * @return true on success
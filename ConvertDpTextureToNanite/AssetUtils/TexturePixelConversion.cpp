@@ -0,0 +1,353 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TexturePixelConversion.h"
+#include "Async/ParallelFor.h"
+#include "Math/VectorRegister.h"
+#include "Math/Float16.h"
+#include "Math/Float16Color.h"
+
+using namespace UE::Geometry;
+
+static int32 GetSourceBytesPerPixel(ETextureSourceFormat SourceFormat)
+{
+	switch (SourceFormat)
+	{
+	case TSF_BGRA8:
+	case TSF_BGRE8:
+		return 4;
+	case TSF_RGBA16:
+	case TSF_RGBA16F:
+		return 8;
+	case TSF_G16:
+		return 2;
+	case TSF_G8:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+// 8 bit BGRA, one pixel per vector register. The sRGB decode goes through the table, alpha is always linear.
+static void ConvertBGRA8(const uint8* Source, int64 NumPixels, bool bSRGB, FVector4f* Dest)
+{
+	constexpr float Scale = 1.0f / 255.0f;
+	if (bSRGB)
+	{
+		const float* SRGBToLinear = UE::AssetUtils::GetSRGBToLinearTable();
+		for (int64 i = 0; i < NumPixels; ++i)
+		{
+			const uint8* Pixel = Source + 4 * i;
+			Dest[i] = FVector4f(SRGBToLinear[Pixel[2]], SRGBToLinear[Pixel[1]], SRGBToLinear[Pixel[0]], Pixel[3] * Scale);
+		}
+		return;
+	}
+
+	const VectorRegister4Float ScaleReg = VectorSetFloat1(Scale);
+	for (int64 i = 0; i < NumPixels; ++i)
+	{
+		const VectorRegister4Float BGRA = VectorLoadByte4(Source + 4 * i);
+		VectorStore(VectorMultiply(VectorSwizzle(BGRA, 2, 1, 0, 3), ScaleReg), &Dest[i].X);
+	}
+}
+
+// The remaining converters are plain loops over flat arrays with a constant scale, which the compiler vectorizes
+static void ConvertRGBA16(const uint16* Source, int64 NumPixels, FVector4f* Dest)
+{
+	constexpr float Scale = 1.0f / 65535.0f;
+	float* DestValues = &Dest[0].X;
+	for (int64 i = 0; i < 4 * NumPixels; ++i)
+	{
+		DestValues[i] = Source[i] * Scale;
+	}
+}
+
+static void ConvertRGBA16F(const FFloat16* Source, int64 NumPixels, FVector4f* Dest)
+{
+	float* DestValues = &Dest[0].X;
+	for (int64 i = 0; i < 4 * NumPixels; ++i)
+	{
+		DestValues[i] = Source[i].GetFloat();
+	}
+}
+
+static void ConvertG16(const uint16* Source, int64 NumPixels, FVector4f* Dest)
+{
+	constexpr float Scale = 1.0f / 65535.0f;
+	for (int64 i = 0; i < NumPixels; ++i)
+	{
+		const float Gray = Source[i] * Scale;
+		Dest[i] = FVector4f(Gray, Gray, Gray, 1.0f);
+	}
+}
+
+static void ConvertG8(const uint8* Source, int64 NumPixels, bool bSRGB, FVector4f* Dest)
+{
+	constexpr float Scale = 1.0f / 255.0f;
+	const float* SRGBToLinear = UE::AssetUtils::GetSRGBToLinearTable();
+	for (int64 i = 0; i < NumPixels; ++i)
+	{
+		const float Gray = bSRGB ? SRGBToLinear[Source[i]] : Source[i] * Scale;
+		Dest[i] = FVector4f(Gray, Gray, Gray, 1.0f);
+	}
+}
+
+// Strided single channel reads, NumChannels values per pixel
+template<typename SourceType, typename ConvertType>
+static void ConvertChannel(const SourceType* Source, int32 NumChannels, int32 Offset, int64 NumPixels, float* Dest, ConvertType Convert)
+{
+	for (int64 i = 0; i < NumPixels; ++i)
+	{
+		Dest[i] = Convert(Source[i * NumChannels + Offset]);
+	}
+}
+
+// Linear pixels to vector registers, FVector3f gets an alpha of 1
+static FORCEINLINE VectorRegister4Float LoadLinearPixel(const FVector4f& Pixel)
+{
+	return VectorLoad(&Pixel.X);
+}
+
+static FORCEINLINE VectorRegister4Float LoadLinearPixel(const FVector3f& Pixel)
+{
+	return VectorLoadFloat3_W1(&Pixel.X);
+}
+
+// Clamp and quantize to 8 bit BGRA. The linear case matches ToFColor(false): floor(Clamp(Value) * 255.999),
+// VectorStoreByte4() truncates. The sRGB encode needs a pow per channel and stays scalar.
+template<typename PixelType>
+static void ConvertToBGRA8(const PixelType* Source, int64 NumPixels, bool bSRGB, FColor* Dest)
+{
+	if (bSRGB)
+	{
+		for (int64 i = 0; i < NumPixels; ++i)
+		{
+			Dest[i] = ToLinearColor(Source[i]).ToFColor(true);
+		}
+		return;
+	}
+
+	const VectorRegister4Float ScaleReg = VectorSetFloat1(255.999f);
+	for (int64 i = 0; i < NumPixels; ++i)
+	{
+		const VectorRegister4Float RGBA = VectorMin(VectorMax(LoadLinearPixel(Source[i]), VectorZeroFloat()), VectorOneFloat());
+		VectorStoreByte4(VectorMultiply(VectorSwizzle(RGBA, 2, 1, 0, 3), ScaleReg), &Dest[i]);
+	}
+}
+
+template<typename PixelType>
+static void ConvertToRGBA16F(const PixelType* Source, int64 NumPixels, FFloat16Color* Dest)
+{
+	for (int64 i = 0; i < NumPixels; ++i)
+	{
+		alignas(16) float RGBA[4];
+		VectorStoreAligned(LoadLinearPixel(Source[i]), RGBA);
+		FPlatformMath::VectorStoreHalf(reinterpret_cast<uint16*>(&Dest[i]), RGBA);
+	}
+}
+
+
+const float* UE::AssetUtils::GetSRGBToLinearTable()
+{
+	struct FSRGBToLinearTable
+	{
+		float Values[256];
+
+		FSRGBToLinearTable()
+		{
+			for (int32 i = 0; i < 256; ++i)
+			{
+				Values[i] = FLinearColor::FromSRGBColor(FColor((uint8)i, 0, 0, 255)).R;
+			}
+		}
+	};
+	static const FSRGBToLinearTable Table;
+	return Table.Values;
+}
+
+
+bool UE::AssetUtils::CanConvertSourceFormat(ETextureSourceFormat SourceFormat)
+{
+	return GetSourceBytesPerPixel(SourceFormat) > 0;
+}
+
+
+void UE::AssetUtils::ConvertSourcePixels(
+	ETextureSourceFormat SourceFormat,
+	bool bSRGB,
+	const uint8* Source,
+	int64 NumPixels,
+	FVector4f* Dest)
+{
+	switch (SourceFormat)
+	{
+	case TSF_BGRA8:
+	case TSF_BGRE8:
+		ConvertBGRA8(Source, NumPixels, bSRGB, Dest);
+		break;
+	case TSF_RGBA16:
+		ConvertRGBA16(reinterpret_cast<const uint16*>(Source), NumPixels, Dest);
+		break;
+	case TSF_RGBA16F:
+		ConvertRGBA16F(reinterpret_cast<const FFloat16*>(Source), NumPixels, Dest);
+		break;
+	case TSF_G16:
+		ConvertG16(reinterpret_cast<const uint16*>(Source), NumPixels, Dest);
+		break;
+	case TSF_G8:
+		ConvertG8(Source, NumPixels, bSRGB, Dest);
+		break;
+	default:
+		ensureMsgf(false, TEXT("ConvertSourcePixels: unsupported source format"));
+		break;
+	}
+}
+
+
+void UE::AssetUtils::ConvertSourceChannel(
+	ETextureSourceFormat SourceFormat,
+	bool bSRGB,
+	int32 Channel,
+	const uint8* Source,
+	int64 NumPixels,
+	float* Dest)
+{
+	check(Channel >= 0 && Channel < 4);
+	const bool bColorChannel = Channel < 3;
+	const float* SRGBToLinear = GetSRGBToLinearTable();
+	auto FillConstant = [NumPixels, Dest](float Value)
+	{
+		for (int64 i = 0; i < NumPixels; ++i)
+		{
+			Dest[i] = Value;
+		}
+	};
+
+	switch (SourceFormat)
+	{
+	case TSF_BGRA8:
+	case TSF_BGRE8:
+	{
+		static constexpr int32 BGRAOffsets[4] = { 2, 1, 0, 3 };
+		if (bSRGB && bColorChannel)
+		{
+			ConvertChannel(Source, 4, BGRAOffsets[Channel], NumPixels, Dest, [SRGBToLinear](uint8 Value) { return SRGBToLinear[Value]; });
+		}
+		else
+		{
+			ConvertChannel(Source, 4, BGRAOffsets[Channel], NumPixels, Dest, [](uint8 Value) { return Value * (1.0f / 255.0f); });
+		}
+		break;
+	}
+	case TSF_RGBA16:
+		ConvertChannel(reinterpret_cast<const uint16*>(Source), 4, Channel, NumPixels, Dest, [](uint16 Value) { return Value * (1.0f / 65535.0f); });
+		break;
+	case TSF_RGBA16F:
+		ConvertChannel(reinterpret_cast<const FFloat16*>(Source), 4, Channel, NumPixels, Dest, [](const FFloat16& Value) { return Value.GetFloat(); });
+		break;
+	case TSF_G16:
+		if (bColorChannel)
+		{
+			ConvertChannel(reinterpret_cast<const uint16*>(Source), 1, 0, NumPixels, Dest, [](uint16 Value) { return Value * (1.0f / 65535.0f); });
+		}
+		else
+		{
+			FillConstant(1.0f);
+		}
+		break;
+	case TSF_G8:
+		if (bColorChannel == false)
+		{
+			FillConstant(1.0f);
+		}
+		else if (bSRGB)
+		{
+			ConvertChannel(Source, 1, 0, NumPixels, Dest, [SRGBToLinear](uint8 Value) { return SRGBToLinear[Value]; });
+		}
+		else
+		{
+			ConvertChannel(Source, 1, 0, NumPixels, Dest, [](uint8 Value) { return Value * (1.0f / 255.0f); });
+		}
+		break;
+	default:
+		ensureMsgf(false, TEXT("ConvertSourceChannel: unsupported source format"));
+		break;
+	}
+}
+
+
+bool UE::AssetUtils::ConvertSourceImage(
+	ETextureSourceFormat SourceFormat,
+	bool bSRGB,
+	const uint8* Source,
+	FImageDimensions Dimensions,
+	TImageBuilder<FVector4f>& DestImage)
+{
+	const int32 BytesPerPixel = GetSourceBytesPerPixel(SourceFormat);
+	if (BytesPerPixel == 0)
+	{
+		return false;
+	}
+
+	DestImage.SetDimensions(Dimensions);
+	if (Dimensions.Num() == 0)
+	{
+		return true;
+	}
+
+	// the builder storage is one contiguous array of pixels, written row by row
+	const int64 Width = Dimensions.GetWidth();
+	FVector4f* DestPixels = const_cast<FVector4f*>(&DestImage.GetPixel(0));
+	ParallelFor(Dimensions.GetHeight(), [&](int32 y)
+	{
+		ConvertSourcePixels(SourceFormat, bSRGB, Source + y * Width * BytesPerPixel, Width, DestPixels + y * Width);
+	});
+	return true;
+}
+
+
+bool UE::AssetUtils::ConvertSourceImageChannel(
+	ETextureSourceFormat SourceFormat,
+	bool bSRGB,
+	int32 Channel,
+	const uint8* Source,
+	FImageDimensions Dimensions,
+	TArray64<float>& DestPlane)
+{
+	const int32 BytesPerPixel = GetSourceBytesPerPixel(SourceFormat);
+	if (BytesPerPixel == 0 || Channel < 0 || Channel > 3)
+	{
+		return false;
+	}
+
+	DestPlane.SetNumUninitialized(Dimensions.Num());
+	const int64 Width = Dimensions.GetWidth();
+	ParallelFor(Dimensions.GetHeight(), [&](int32 y)
+	{
+		ConvertSourceChannel(SourceFormat, bSRGB, Channel, Source + y * Width * BytesPerPixel, Width, DestPlane.GetData() + y * Width);
+	});
+	return true;
+}
+
+
+void UE::AssetUtils::ConvertLinearPixels(const FVector4f* Source, int64 NumPixels, bool bSRGB, FColor* Dest)
+{
+	ConvertToBGRA8(Source, NumPixels, bSRGB, Dest);
+}
+
+
+void UE::AssetUtils::ConvertLinearPixels(const FVector3f* Source, int64 NumPixels, bool bSRGB, FColor* Dest)
+{
+	ConvertToBGRA8(Source, NumPixels, bSRGB, Dest);
+}
+
+
+void UE::AssetUtils::ConvertLinearPixels(const FVector4f* Source, int64 NumPixels, FFloat16Color* Dest)
+{
+	ConvertToRGBA16F(Source, NumPixels, Dest);
+}
+
+
+void UE::AssetUtils::ConvertLinearPixels(const FVector3f* Source, int64 NumPixels, FFloat16Color* Dest)
+{
+	ConvertToRGBA16F(Source, NumPixels, Dest);
+}
@@ -0,0 +1,89 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "VectorTypes.h"
+#include "Image/ImageBuilder.h"
+#include "Engine/Texture.h"
+
+
+namespace UE
+{
+namespace AssetUtils
+{
+	using namespace UE::Geometry;
+
+	/**
+	 * Linear value of each of the 256 sRGB encoded 8 bit values, same results as FLinearColor::FromSRGBColor().
+	 */
+	const float* GetSRGBToLinearTable();
+
+	/**
+	 * @return true if the converters below can read SourceFormat: TSF_BGRA8, TSF_BGRE8, TSF_RGBA16, TSF_RGBA16F,
+	 * TSF_G16 and TSF_G8
+	 */
+	bool CanConvertSourceFormat(ETextureSourceFormat SourceFormat);
+
+	/**
+	 * Convert NumPixels tightly packed pixels of SourceFormat to linear RGBA. 8 bit color channels are decoded from
+	 * sRGB if bSRGB is set, alpha never is. Gray formats are replicated to RGB with an alpha of 1.
+	 */
+	void ConvertSourcePixels(
+		ETextureSourceFormat SourceFormat,
+		bool bSRGB,
+		const uint8* Source,
+		int64 NumPixels,
+		FVector4f* Dest);
+
+	/**
+	 * Same as ConvertSourcePixels(), but only decodes Channel (0..3 = RGBA) into a compact plane of floats, e.g. when
+	 * only the displacement channel is needed.
+	 */
+	void ConvertSourceChannel(
+		ETextureSourceFormat SourceFormat,
+		bool bSRGB,
+		int32 Channel,
+		const uint8* Source,
+		int64 NumPixels,
+		float* Dest);
+
+	/**
+	 * Convert a Width x Height image of SourceFormat, row by row in parallel, straight into the pixel storage of
+	 * DestImage.
+	 * @return false if the format is not supported
+	 */
+	bool ConvertSourceImage(
+		ETextureSourceFormat SourceFormat,
+		bool bSRGB,
+		const uint8* Source,
+		FImageDimensions Dimensions,
+		TImageBuilder<FVector4f>& DestImage);
+
+	/**
+	 * Convert one channel of a Width x Height image of SourceFormat, row by row in parallel, into DestPlane.
+	 * @return false if the format is not supported
+	 */
+	bool ConvertSourceImageChannel(
+		ETextureSourceFormat SourceFormat,
+		bool bSRGB,
+		int32 Channel,
+		const uint8* Source,
+		FImageDimensions Dimensions,
+		TArray64<float>& DestPlane);
+
+	/**
+	 * Clamp NumPixels linear RGBA pixels to [0,1] and quantize them to 8 bit BGRA, the inverse of
+	 * ConvertSourcePixels(). Same results as FLinearColor::ToFColor(bSRGB), the linear case is one vector register
+	 * per pixel. FVector3f pixels get an alpha of 1.
+	 */
+	void ConvertLinearPixels(const FVector4f* Source, int64 NumPixels, bool bSRGB, FColor* Dest);
+	void ConvertLinearPixels(const FVector3f* Source, int64 NumPixels, bool bSRGB, FColor* Dest);
+
+	/**
+	 * Convert NumPixels linear RGBA pixels to half floats, without clamping, four channels at a time.
+	 * FVector3f pixels get an alpha of 1.
+	 */
+	void ConvertLinearPixels(const FVector4f* Source, int64 NumPixels, FFloat16Color* Dest);
+	void ConvertLinearPixels(const FVector3f* Source, int64 NumPixels, FFloat16Color* Dest);
+}
+}
@@ -0,0 +1,182 @@
+#include "DpAdaptiveTessellate.h"
+#include "DynamicMesh/DynamicMesh3.h"
+#include "Async/ParallelFor.h"
+#include "Util/ProgressCancel.h"
+
+using namespace UE::Geometry;
+
+namespace AdaptiveTessellateLocals
+{
+	/** Entry of the split queue. Stale once the edge has been modified after the entry was pushed. */
+	struct FSplitCandidate
+	{
+		double Error;
+		int32 EdgeID;
+		uint32 Stamp;
+	};
+
+	struct FLargerError
+	{
+		bool operator()(const FSplitCandidate& A, const FSplitCandidate& B) const
+		{
+			return A.Error > B.Error;
+		}
+	};
+
+	/** @return the longest edge of the triangles adjacent to EdgeID, EdgeID itself if none is longer */
+	int32 FindLongestAdjacentEdge(const FDynamicMesh3& Mesh, int32 EdgeID)
+	{
+		auto EdgeLengthSquared = [&Mesh](int32 EID)
+		{
+			const FIndex2i EdgeV = Mesh.GetEdgeV(EID);
+			return DistanceSquared(Mesh.GetVertex(EdgeV.A), Mesh.GetVertex(EdgeV.B));
+		};
+
+		int32 LongestEID = EdgeID;
+		double LongestLengthSquared = EdgeLengthSquared(EdgeID);
+
+		const FIndex2i EdgeT = Mesh.GetEdgeT(EdgeID);
+		for (int32 TIdx = 0; TIdx < 2; ++TIdx)
+		{
+			if (EdgeT[TIdx] == FDynamicMesh3::InvalidID)
+			{
+				continue;
+			}
+			const FIndex3i TriEdges = Mesh.GetTriEdges(EdgeT[TIdx]);
+			for (int32 EIdx = 0; EIdx < 3; ++EIdx)
+			{
+				const double LengthSquared = EdgeLengthSquared(TriEdges[EIdx]);
+				if (LengthSquared > LongestLengthSquared)
+				{
+					LongestLengthSquared = LengthSquared;
+					LongestEID = TriEdges[EIdx];
+				}
+			}
+		}
+
+		return LongestEID;
+	}
+}
+
+bool FDpAdaptiveTessellate::Cancelled()
+{
+	return (Progress == nullptr) ? false : Progress->Cancelled();
+}
+
+bool FDpAdaptiveTessellate::Compute()
+{
+	using namespace AdaptiveTessellateLocals;
+
+	if (Validate() != EOperationValidationResult::Ok)
+	{
+		return false;
+	}
+
+	NewVertices.Reset();
+	ResultMesh->Copy(*Mesh);
+
+	// Input mesh triangle each result triangle was split from
+	TArray<int32> TriangleOrigin;
+	TriangleOrigin.SetNumUninitialized(ResultMesh->MaxTriangleID());
+	for (int32 TID = 0; TID < TriangleOrigin.Num(); ++TID)
+	{
+		TriangleOrigin[TID] = TID;
+	}
+
+	// Evaluating the error is the expensive part, do it for all the input edges at once
+	TArray<double> InitialErrors;
+	InitialErrors.SetNumZeroed(ResultMesh->MaxEdgeID());
+	ParallelFor(ResultMesh->MaxEdgeID(), [&](int32 EID)
+	{
+		if (ResultMesh->IsEdge(EID))
+		{
+			InitialErrors[EID] = EdgeError(*ResultMesh, EID);
+		}
+	}, bUseParallel == false);
+
+	if (Cancelled())
+	{
+		ResultMesh->Clear();
+		return false;
+	}
+
+	TArray<uint32> EdgeStamps;
+	EdgeStamps.SetNumZeroed(ResultMesh->MaxEdgeID());
+
+	TArray<FSplitCandidate> Queue;
+	for (int32 EID = 0; EID < InitialErrors.Num(); ++EID)
+	{
+		if (InitialErrors[EID] > ErrorThreshold)
+		{
+			Queue.Add({ InitialErrors[EID], EID, 0 });
+		}
+	}
+	InitialErrors.Empty();
+	Queue.Heapify(FLargerError());
+
+	// Re-evaluate an edge whose geometry changed, invalidating its older queue entries
+	auto PushEdge = [&](int32 EID)
+	{
+		if (EID >= EdgeStamps.Num())
+		{
+			EdgeStamps.SetNumZeroed(ResultMesh->MaxEdgeID());
+		}
+		const uint32 Stamp = ++EdgeStamps[EID];
+		const double Error = EdgeError(*ResultMesh, EID);
+		if (Error > ErrorThreshold)
+		{
+			Queue.HeapPush({ Error, EID, Stamp }, FLargerError());
+		}
+	};
+
+	// a split adds two triangles, one on a boundary edge
+	int32 NumSplits = 0;
+	while (Queue.Num() > 0 && ResultMesh->TriangleCount() + 2 <= TriangleBudget)
+	{
+		FSplitCandidate Candidate;
+		Queue.HeapPop(Candidate, FLargerError(), false);
+		if (ResultMesh->IsEdge(Candidate.EdgeID) == false || EdgeStamps[Candidate.EdgeID] != Candidate.Stamp)
+		{
+			continue;
+		}
+
+		const int32 SplitEID = FindLongestAdjacentEdge(*ResultMesh, Candidate.EdgeID);
+		FDynamicMesh3::FEdgeSplitInfo SplitInfo;
+		if (ResultMesh->SplitEdge(SplitEID, SplitInfo) != EMeshResult::Ok)
+		{
+			continue;
+		}
+
+		TriangleOrigin.SetNum(ResultMesh->MaxTriangleID());
+		for (int32 TIdx = 0; TIdx < 2; ++TIdx)
+		{
+			if (SplitInfo.NewTriangles[TIdx] != FDynamicMesh3::InvalidID)
+			{
+				TriangleOrigin[SplitInfo.NewTriangles[TIdx]] = TriangleOrigin[SplitInfo.OriginalTriangles[TIdx]];
+			}
+		}
+		NewVertices.Add(FIndex2i(SplitInfo.NewVertex, TriangleOrigin[SplitInfo.OriginalTriangles.A]));
+
+		PushEdge(SplitEID);
+		for (int32 EIdx = 0; EIdx < 3; ++EIdx)
+		{
+			if (SplitInfo.NewEdges[EIdx] != FDynamicMesh3::InvalidID)
+			{
+				PushEdge(SplitInfo.NewEdges[EIdx]);
+			}
+		}
+		if (SplitEID != Candidate.EdgeID)
+		{
+			// only a neighbour was split, the candidate still needs refining
+			PushEdge(Candidate.EdgeID);
+		}
+
+		if ((++NumSplits % 1024) == 0 && Cancelled())
+		{
+			ResultMesh->Clear();
+			return false;
+		}
+	}
+
+	return true;
+}
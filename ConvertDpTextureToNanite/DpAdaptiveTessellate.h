@@ -0,0 +1,108 @@
+#pragma once
+
+#include "GeometryTypes.h"
+#include "IndexTypes.h"
+
+class FProgressCancel;
+
+namespace UE
+{
+namespace Geometry
+{
+
+class FDynamicMesh3;
+
+/**
+ * Error driven alternative to FDpUniformTessellate. Instead of splitting every triangle the same number of times,
+ * edges are bisected in order of an error measured by the caller (e.g. how far the displacement map deviates from
+ * the tessellation along the edge) until every error is below a threshold or the triangle budget is used up.
+ *
+ * Edges are split with FDynamicMesh3::SplitEdge, which splits the triangles on both sides of the edge, so triangles
+ * refined to different levels always stay connected and the result is crack free. Attributes and overlays are
+ * interpolated to the new vertices the same way SplitEdge always does. When an edge is picked for splitting, the
+ * longest edge of its triangles is split first (longest edge bisection), which keeps the triangles well shaped.
+ */
+class FDpAdaptiveTessellate
+{
+public:
+	//
+	// Inputs
+	//
+
+	/** Set this to be able to cancel running operation. */
+	FProgressCancel* Progress = nullptr;
+
+	/** Error of an edge of the mesh being refined. Edges are split largest error first. */
+	TFunction<double(const FDynamicMesh3& Mesh, int32 EdgeID)> EdgeError;
+
+	/** Edges with an error at or below this are not split. */
+	double ErrorThreshold = 0.0;
+
+	/** Hard cap on the triangle count of the result: no split is made that could take it above this. */
+	int32 TriangleBudget = 3000000;
+
+	/** Should multi-threading be enabled for the initial error evaluation. */
+	bool bUseParallel = true;
+
+	//
+	// Output
+	//
+
+	/** The tessellated mesh. */
+	FDynamicMesh3* ResultMesh = nullptr;
+
+	/**
+	 * For every vertex added by the tessellation, its ID and the ID of the input mesh triangle it was inserted into.
+	 * A vertex inserted on an input mesh edge is mapped to either of the triangles sharing that edge.
+	 */
+	TArray<FIndex2i> NewVertices;
+
+protected:
+
+	/** The mesh to tessellate. */
+	const FDynamicMesh3* Mesh = nullptr;
+
+public:
+
+	/**
+	 * Tessellate the mesh and write the result into another mesh. This will overwrite any data stored in the OutMesh.
+	 */
+	FDpAdaptiveTessellate(const FDynamicMesh3* Mesh, FDynamicMesh3* OutMesh)
+	:
+	ResultMesh(OutMesh), Mesh(Mesh)
+	{
+	}
+
+	virtual ~FDpAdaptiveTessellate()
+	{
+	}
+
+	/**
+	 * @return EOperationValidationResult::Ok if we can apply operation, or error code if we cannot.
+	 */
+	virtual EOperationValidationResult Validate()
+	{
+		if (Mesh == nullptr || ResultMesh == nullptr || !EdgeError || TriangleBudget < 0)
+		{
+			return EOperationValidationResult::Failed_UnknownReason;
+		}
+
+		return EOperationValidationResult::Ok;
+	}
+
+	/**
+	 * Generate tessellated geometry.
+	 *
+	 * @return true if the algorithm succeeds, false if it failed or was cancelled by the user. On failure the
+	 * ResultMesh is cleared.
+	 */
+	virtual bool Compute();
+
+protected:
+
+	/** If this returns true, abort computation. */
+	virtual bool Cancelled();
+};
+
+} // end namespace UE::Geometry
+} // end namespace UE
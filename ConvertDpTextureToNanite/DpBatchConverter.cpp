@@ -0,0 +1,168 @@
+#include "DpBatchConverter.h"
+
+#include "DpMeshOptional.h"
+#include "Async/Async.h"
+#include "Engine/Texture2D.h"
+#include "Misc/QueuedThreadPool.h"
+#include "Util/ProgressCancel.h"
+
+FDpBatchConverter::FDpBatchConverter(const TArray<FDpBatchConversionItem>& ItemsIn, int32 MaxConcurrentConversionsIn)
+	: Items(ItemsIn)
+{
+	// leave half of the cores to the game thread and the task graph, which still decode the textures
+	MaxConcurrentConversions = (MaxConcurrentConversionsIn > 0) ? MaxConcurrentConversionsIn : FPlatformMisc::NumberOfCores() / 2;
+	MaxConcurrentConversions = FMath::Max(MaxConcurrentConversions, 1);
+}
+
+FDpBatchConverter::~FDpBatchConverter()
+{
+	check(Pool == nullptr);
+}
+
+TSharedRef<FDpBatchConverter> FDpBatchConverter::Launch(const TArray<FDpBatchConversionItem>& Items, int32 MaxConcurrentConversions)
+{
+	TSharedRef<FDpBatchConverter> Converter = MakeShared<FDpBatchConverter>(Items, MaxConcurrentConversions);
+	Converter->Start();
+	return Converter;
+}
+
+void FDpBatchConverter::Start()
+{
+	check(IsInGameThread());
+	check(Pool == nullptr);
+
+	StartTime = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
+	if (Items.Num() == 0)
+	{
+		return;
+	}
+
+	SelfRef = AsShared();
+	Pool = FQueuedThreadPool::Allocate();
+	verify(Pool->Create(MaxConcurrentConversions, 1024 * 1024, TPri_Normal, TEXT("DpConvertPool")));
+
+	UE_LOG(LogTemp,Warning,TEXT("2K_DpRA Batch conversion of %d assets on %d threads"), Items.Num(), MaxConcurrentConversions);
+	SubmitPending();
+}
+
+void FDpBatchConverter::SubmitPending()
+{
+	// keep one extra conversion per thread queued so the pool does not idle while the game thread commits
+	const int32 MaxInFlight = MaxConcurrentConversions * 2;
+	while (NumInFlight < MaxInFlight && NextItem < Items.Num())
+	{
+		const int32 ItemIndex = NextItem++;
+		FDpBatchConversionItem& Item = Items[ItemIndex];
+
+		TSharedPtr<FDpMeshOptional> Optional = MakeShared<FDpMeshOptional>(Item.Target, Item.DpTexture);
+		if (!Optional->PrepareConversion(false))
+		{
+			UE_LOG(LogTemp,Warning,TEXT("2K_DpRA Batch conversion skipped item %d, no static mesh or texture"), ItemIndex);
+			NumCommitted++;
+			continue;
+		}
+
+		NumInFlight++;
+		// the worker only touches this converter before handing the result back, the converter
+		// can not finish before that commit has run
+		AsyncPool(*Pool, [this, ItemIndex, Optional]() mutable
+		{
+			FProgressCancel Progress;
+			Progress.CancelF = [this]() { return bCancelled.load(std::memory_order_relaxed); };
+			double ComputeStartTime = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
+			Optional->ComputeConversion(&Progress);
+			double ComputeEndTime = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
+			Items[ItemIndex].ComputeTime = ComputeEndTime - ComputeStartTime;
+
+			// hand over the reference so the optional is released on the game thread
+			AsyncTask(ENamedThreads::GameThread, [this, ItemIndex, Optional = MoveTemp(Optional)]()
+			{
+				CommitItem(ItemIndex, Optional);
+			});
+		});
+	}
+
+	if (NumInFlight == 0 && IsDone())
+	{
+		Finish();
+	}
+}
+
+void FDpBatchConverter::CommitItem(int32 ItemIndex, TSharedPtr<FDpMeshOptional> Optional)
+{
+	check(IsInGameThread());
+
+	// commits run one at a time on the game thread, CommitMeshDescription/PostEditChange are not thread safe
+	const bool bComputed = Optional->ConversionProgress.GetStage() == EDpConversionStage::Commit;
+	if (bComputed)
+	{
+		Optional->SaveMeshToStaticMesh();
+	}
+	else
+	{
+		Optional->RestoreTarget();
+	}
+	Optional->ReleaseConversion();
+
+	FDpBatchConversionItem& Item = Items[ItemIndex];
+	Item.CommitTime = Optional->Report.CommitTime;
+	Item.ResultTriangleCount = Optional->Report.ResultTriangleCount;
+	Item.bConverted = bComputed;
+
+	NumInFlight--;
+	NumCommitted++;
+	SubmitPending();
+}
+
+void FDpBatchConverter::Cancel()
+{
+	check(IsInGameThread());
+	if (Pool == nullptr || bCancelled)
+	{
+		return;
+	}
+
+	UE_LOG(LogTemp,Warning,TEXT("2K_DpRA Batch conversion cancelled, %d items not started, %d running"), Items.Num() - NextItem, NumInFlight);
+	bCancelled = true;
+	NumCommitted += Items.Num() - NextItem;
+	NextItem = Items.Num();
+
+	// the running conversions still hand their (discarded) result back, the last one finishes the batch
+	if (NumInFlight == 0)
+	{
+		Finish();
+	}
+}
+
+void FDpBatchConverter::Finish()
+{
+	double EndTime = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
+	double TotalTime = FMath::Max(EndTime - StartTime, 0.001);
+
+	int32 NumConverted = 0;
+	int64 TotalTriangles = 0;
+	double TotalComputeTime = 0;
+	double TotalCommitTime = 0;
+	for (const FDpBatchConversionItem& Item : Items)
+	{
+		if (Item.bConverted)
+		{
+			NumConverted++;
+			TotalTriangles += Item.ResultTriangleCount;
+			TotalComputeTime += Item.ComputeTime;
+			TotalCommitTime += Item.CommitTime;
+		}
+	}
+
+	UE_LOG(LogTemp,Warning,TEXT("2K_DpRA Batch conversion of %d/%d assets consuming：%f, %f assets/s, %f triangles/s (compute %f ms, commit %f ms summed over assets)"),
+		NumConverted, Items.Num(), TotalTime, NumConverted * 1000.0 / TotalTime, TotalTriangles * 1000.0 / TotalTime,
+		TotalComputeTime, TotalCommitTime);
+
+	// the pool threads are idle, every worker handed its result back before the last commit
+	Pool->Destroy();
+	delete Pool;
+	Pool = nullptr;
+
+	// may delete this
+	SelfRef.Reset();
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "CoreMinimal.h"
+#include <atomic>
+
+class FDpMeshOptional;
+class FQueuedThreadPool;
+class UMeshComponent;
+class UTexture2D;
+
+/** One target/texture pair of a batch conversion, with the timings of its conversion */
+struct FDpBatchConversionItem
+{
+	UMeshComponent* Target = nullptr;
+	UTexture2D* DpTexture = nullptr;
+
+	/** Tessellation and displacement time on a pool thread, in ms */
+	double ComputeTime = 0;
+	/** Game thread time spent committing the result to the static mesh, in ms */
+	double CommitTime = 0;
+	int32 ResultTriangleCount = 0;
+	bool bConverted = false;
+};
+
+/**
+ * Converts many displacement textured meshes to nanite. Tessellation and displacement run on a bounded
+ * thread pool, the game thread only prepares the source meshes and commits the results one at a time.
+ * Only a window of conversions is kept in flight so the number of tessellated meshes held in memory stays bounded.
+ * The converter keeps itself alive until every item has been committed.
+ */
+class FDpBatchConverter : public TSharedFromThis<FDpBatchConverter>
+{
+public:
+	/**
+	 * @param ItemsIn target/texture pairs to convert
+	 * @param MaxConcurrentConversionsIn number of pool threads, 0 uses half of the cores
+	 */
+	FDpBatchConverter(const TArray<FDpBatchConversionItem>& ItemsIn, int32 MaxConcurrentConversionsIn = 0);
+	~FDpBatchConverter();
+
+	/** Create and start a batch conversion, must be called on the game thread */
+	static TSharedRef<FDpBatchConverter> Launch(const TArray<FDpBatchConversionItem>& Items, int32 MaxConcurrentConversions = 0);
+
+	void Start();
+	/** Skip the items not started yet and abort the running ones, which are not committed. Game thread only. */
+	void Cancel();
+	bool IsDone() const { return NumCommitted == Items.Num(); }
+
+public:
+	TArray<FDpBatchConversionItem> Items;
+	int32 MaxConcurrentConversions = 1;
+
+private:
+	/** Prepare and submit items until the in flight window is full */
+	void SubmitPending();
+	void CommitItem(int32 ItemIndex, TSharedPtr<FDpMeshOptional> Optional);
+	void Finish();
+
+	FQueuedThreadPool* Pool = nullptr;
+	TSharedPtr<FDpBatchConverter> SelfRef;
+	int32 NextItem = 0;
+	int32 NumInFlight = 0;
+	int32 NumCommitted = 0;
+	double StartTime = 0;
+	/** Read by the pool threads through the FProgressCancel of their conversion */
+	std::atomic<bool> bCancelled{ false };
+};
@@ -0,0 +1,883 @@
+#include "DpDisplacementLocals.h"
+
+#include "DpUniformTessellate.h"
+#include "DpScalarFieldPyramid.h"
+#include "DynamicMesh/MeshNormals.h"
+#include "Image/ImageBuilder.h"
+#include "AssetUtils/TexturePixelConversion.h"
+#include "AssetUtils/Texture2DBuilder.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "Generators/RectangleMeshGenerator.h"
+#include "Generators/SphereGenerator.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "Math/RandomStream.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/DateTime.h"
+#include "UObject/Package.h"
+#include <atomic>
+
+/** DpNanite.Benchmark* console commands, on synthetic meshes and images. Results are logged with the 2K_DpRA prefix. */
+namespace DpBenchmarks
+{
+	using namespace DisplaceMeshToolLocals;
+
+	//
+	// Harness shared by the benchmarks
+	//
+
+	/** Milliseconds since an arbitrary origin, to time benchmark stages */
+	static double Now()
+	{
+		return FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
+	}
+
+	/** @return how many times faster Time is than BaselineTime */
+	static double Speedup(double BaselineTime, double Time)
+	{
+		return BaselineTime / FMath::Max(Time, 0.001);
+	}
+
+	template<typename FormatType, typename... ArgTypes>
+	static void Log(const FormatType& Format, ArgTypes... Args)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("2K_DpRA %s"), *FString::Printf(Format, Args...));
+	}
+
+	/** Positional sizes, e.g. "DpNanite.BenchmarkMapDisplacement 500000 2000000", or Defaults if there are none */
+	static TArray<int32> ParseSizes(const TArray<FString>& Args, const TArray<int32>& Defaults)
+	{
+		TArray<int32> Sizes;
+		for (const FString& Arg : Args)
+		{
+			Sizes.Add(FCString::Atoi(*Arg));
+		}
+		return Sizes.Num() > 0 ? Sizes : Defaults;
+	}
+
+	/** Key=Value arguments, e.g. "DpNanite.BenchmarkPixelConversion Size=4096" */
+	class FArguments
+	{
+	public:
+		explicit FArguments(const TArray<FString>& Args) : CommandLine(FString::Join(Args, TEXT(" ")))
+		{
+		}
+
+		/** @return the value of Key, or Default if it is not given */
+		template<typename ValueType>
+		ValueType Get(const TCHAR* Key, ValueType Default) const
+		{
+			FParse::Value(*CommandLine, Key, Default);
+			return Default;
+		}
+
+	private:
+		FString CommandLine;
+	};
+
+	/** Samples the process memory on its own thread while a benchmark stage runs, to report its peak */
+	class FPeakMemorySampler
+	{
+	public:
+		FPeakMemorySampler()
+		{
+			BaseUsed = (int64)FPlatformMemory::GetStats().UsedPhysical;
+			PeakUsed = BaseUsed;
+			Sampler = Async(EAsyncExecution::Thread, [this]()
+			{
+				while (bStop == false)
+				{
+					PeakUsed = FMath::Max(PeakUsed.load(), (int64)FPlatformMemory::GetStats().UsedPhysical);
+					FPlatformProcess::Sleep(0.001f);
+				}
+			});
+		}
+
+		/** @return the peak used physical memory above the memory used when the sampler started, in bytes */
+		int64 Stop()
+		{
+			bStop = true;
+			Sampler.Wait();
+			return FMath::Max(PeakUsed.load(), (int64)FPlatformMemory::GetStats().UsedPhysical) - BaseUsed;
+		}
+
+	private:
+		int64 BaseUsed = 0;
+		std::atomic<int64> PeakUsed{ 0 };
+		std::atomic<bool> bStop{ false };
+		TFuture<void> Sampler;
+	};
+
+	//
+	// Benchmarks
+	//
+
+	/**
+	 * Compare ComputeDisplacement::Map with ComputeDisplacement::ParallelMap on synthetic grids.
+	 * Usage: DpNanite.BenchmarkMapDisplacement [TriangleCount ...], defaults to 1M and 3M triangles.
+	 */
+	static void BenchmarkMapDisplacement(const TArray<FString>& Args)
+	{
+		const TArray<int32> TriangleCounts = ParseSizes(Args, { 1000000, 3000000 });
+
+		// 2K displacement field with a few bumps, cull the lower-left corner
+		constexpr int64 FieldSize = 2048;
+		FSampledScalarField2f DisplaceField, CullField;
+		DisplaceField.Resize(FieldSize, FieldSize, 0.0f);
+		CullField.Resize(FieldSize, FieldSize, 1.0f);
+		DisplaceField.SetCellSize(1.0f / (float)FieldSize);
+		CullField.SetCellSize(1.0f / (float)FieldSize);
+		for (int64 y = 0; y < FieldSize; ++y)
+		{
+			for (int64 x = 0; x < FieldSize; ++x)
+			{
+				DisplaceField.GridValues[y * FieldSize + x] = 0.5f + 0.5f * FMath::Sin(x * 0.05f) * FMath::Cos(y * 0.05f);
+				CullField.GridValues[y * FieldSize + x] = (x < FieldSize / 8 && y < FieldSize / 8) ? 0.0f : 1.0f;
+			}
+		}
+
+		auto IntensityFunc = [](int32, const FVector3d&, const FVector3d&) { return 5.0f; };
+
+		for (int32 TriangleCount : TriangleCounts)
+		{
+			FRectangleMeshGenerator Generator;
+			Generator.Width = 1000.0;
+			Generator.Height = 1000.0;
+			Generator.WidthVertexCount = Generator.HeightVertexCount = FMath::Max(2, (int32)FMath::Sqrt(TriangleCount / 2.0) + 1);
+			Generator.Generate();
+			FDynamicMesh3 Mesh(&Generator);
+
+			FMeshNormals Normals(&Mesh);
+			Normals.ComputeVertexNormals();
+			TArray<FVector3d> Positions;
+			Positions.SetNum(Mesh.MaxVertexID());
+			for (int32 vid : Mesh.VertexIndicesItr())
+			{
+				Positions[vid] = Mesh.GetVertex(vid);
+			}
+
+			TArray<FVector3d> SerialPositions, ParallelPositions;
+			SerialPositions.SetNum(Mesh.MaxVertexID());
+			ParallelPositions.SetNum(Mesh.MaxVertexID());
+			TArray<int> SerialCullIDs, ParallelCullIDs;
+
+			double StartTime = Now();
+			ComputeDisplacement::Map(Mesh, Positions, Normals, IntensityFunc, DisplaceField, CullField, SerialPositions, SerialCullIDs);
+			double SerialTime = Now() - StartTime;
+
+			StartTime = Now();
+			ComputeDisplacement::ParallelMap(Mesh, Positions, Normals, IntensityFunc, DisplaceField, CullField, ParallelPositions, ParallelCullIDs);
+			double ParallelTime = Now() - StartTime;
+
+			double MaxError = 0;
+			for (int32 vid : Mesh.VertexIndicesItr())
+			{
+				MaxError = FMath::Max(MaxError, Distance(SerialPositions[vid], ParallelPositions[vid]));
+			}
+
+			Log(TEXT("Map displacement %d triangles: serial %f ms, parallel %f ms (x%.2f), culled %d/%d, max error %g"),
+				Mesh.TriangleCount(), SerialTime, ParallelTime, Speedup(SerialTime, ParallelTime),
+				SerialCullIDs.Num(), ParallelCullIDs.Num(), MaxError);
+		}
+	}
+
+	static FAutoConsoleCommand BenchmarkMapDisplacementCommand(
+		TEXT("DpNanite.BenchmarkMapDisplacement"),
+		TEXT("Compare serial and parallel displacement-map sampling on synthetic 1M/3M triangle grids"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkMapDisplacement));
+
+	/**
+	 * Compare the bulk and the incremental (AppendTriangle) mesh assembly of the uniform tessellation.
+	 * Usage: DpNanite.BenchmarkTessellateAssembly [TessellationNum ...], defaults to 16, 64 and 128 on an 800 triangle grid.
+	 */
+	static void BenchmarkTessellateAssembly(const TArray<FString>& Args)
+	{
+		const TArray<int32> TessellationNums = ParseSizes(Args, { 16, 64, 128 });
+
+		FRectangleMeshGenerator Generator;
+		Generator.Width = 1000.0;
+		Generator.Height = 1000.0;
+		Generator.WidthVertexCount = Generator.HeightVertexCount = 21;
+		Generator.Generate();
+		FDynamicMesh3 Mesh(&Generator);
+
+		for (int32 TessellationNum : TessellationNums)
+		{
+			double Times[2] = { 0, 0 };
+			FDynamicMesh3 Results[2];
+			for (int32 Pass = 0; Pass < 2; ++Pass)
+			{
+				FDpUniformTessellate Tessellator(&Mesh, &Results[Pass]);
+				Tessellator.TessellationNum = TessellationNum;
+				Tessellator.bBulkAssembly = Pass == 1;
+
+				const double StartTime = Now();
+				if (Tessellator.Validate() != EOperationValidationResult::Ok || Tessellator.Compute() == false)
+				{
+					Log(TEXT("Tessellate assembly level %d failed"), TessellationNum);
+					return;
+				}
+				Times[Pass] = Now() - StartTime;
+
+				const FDpUniformTessellate::FStageTimings& Timings = Tessellator.Timings;
+				Log(TEXT("  %s: topology %f ms, assembly %f ms, attribute wait %f ms, attribute copy %f ms"),
+					Pass == 1 ? TEXT("bulk") : TEXT("incremental"), Timings.TopologyTime, Timings.AssemblyTime, Timings.AttributeWaitTime, Timings.AttributeCopyTime);
+				for (const FDpUniformTessellate::FStageTimings::FLayer& Layer : Timings.Layers)
+				{
+					Log(TEXT("    %s: generate %f ms, copy %f ms"), *Layer.Name, Layer.GenerateTime, Layer.CopyTime);
+				}
+			}
+
+			const bool bSameTopology = Results[0].VertexCount() == Results[1].VertexCount() 
+				&& Results[0].TriangleCount() == Results[1].TriangleCount() 
+				&& Results[0].EdgeCount() == Results[1].EdgeCount() 
+				&& Results[1].CheckValidity(FDynamicMesh3::FValidityOptions(), EValidityCheckFailMode::ReturnOnly);
+			const double NumVertices = (double)Results[1].VertexCount();
+			Log(TEXT("Tessellate assembly level %d, %d vertices: incremental %f ms (%.1f Mvert/s), bulk %f ms (%.1f Mvert/s) (x%.2f), same topology %d"),
+				TessellationNum, Results[1].VertexCount(), 
+				Times[0], NumVertices / FMath::Max(Times[0], 0.001) / 1000.0,
+				Times[1], NumVertices / FMath::Max(Times[1], 0.001) / 1000.0,
+				Speedup(Times[0], Times[1]), bSameTopology);
+		}
+	}
+
+	static FAutoConsoleCommand BenchmarkTessellateAssemblyCommand(
+		TEXT("DpNanite.BenchmarkTessellateAssembly"),
+		TEXT("Compare bulk and incremental mesh assembly of the uniform tessellation, reports vertices per second"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkTessellateAssembly));
+
+	/**
+	 * Compare the vector and the scalar lerp of the uniform tessellation lattice (FDpUniformTessellate::bVectorLerp).
+	 * Usage: DpNanite.BenchmarkLatticeLerp [TessellationNum ...], defaults to 16, 64 and 128 on an 800 triangle grid.
+	 */
+	static void BenchmarkLatticeLerp(const TArray<FString>& Args)
+	{
+		const TArray<int32> TessellationNums = ParseSizes(Args, { 16, 64, 128 });
+
+		FRectangleMeshGenerator Generator;
+		Generator.Width = 1000.0;
+		Generator.Height = 1000.0;
+		Generator.WidthVertexCount = Generator.HeightVertexCount = 21;
+		Generator.Generate();
+		FDynamicMesh3 Mesh(&Generator);
+
+		for (int32 TessellationNum : TessellationNums)
+		{
+			// The vertex positions are generated on this thread and the attribute layers on the task graph, the lerp 
+			// shows in the topology time and in the layer generate times
+			double TopologyTimes[2] = { 0, 0 };
+			double LayerTimes[2] = { 0, 0 };
+			FDynamicMesh3 Results[2];
+			for (int32 Pass = 0; Pass < 2; ++Pass)
+			{
+				FDpUniformTessellate Tessellator(&Mesh, &Results[Pass]);
+				Tessellator.TessellationNum = TessellationNum;
+				Tessellator.bVectorLerp = Pass == 1;
+				if (Tessellator.Validate() != EOperationValidationResult::Ok || Tessellator.Compute() == false)
+				{
+					Log(TEXT("Lattice lerp level %d failed"), TessellationNum);
+					return;
+				}
+				TopologyTimes[Pass] = Tessellator.Timings.TopologyTime;
+				for (const FDpUniformTessellate::FStageTimings::FLayer& Layer : Tessellator.Timings.Layers)
+				{
+					LayerTimes[Pass] += Layer.GenerateTime;
+				}
+			}
+
+			double MaxError = 0;
+			for (int32 vid : Results[1].VertexIndicesItr())
+			{
+				MaxError = FMath::Max(MaxError, Distance(Results[0].GetVertex(vid), Results[1].GetVertex(vid)));
+			}
+
+			Log(TEXT("Lattice lerp level %d, %d vertices: topology scalar %f ms, vector %f ms (x%.2f), layers scalar %f ms, vector %f ms (x%.2f), max error %g"),
+				TessellationNum, Results[1].VertexCount(), 
+				TopologyTimes[0], TopologyTimes[1], Speedup(TopologyTimes[0], TopologyTimes[1]),
+				LayerTimes[0], LayerTimes[1], Speedup(LayerTimes[0], LayerTimes[1]), MaxError);
+		}
+	}
+
+	static FAutoConsoleCommand BenchmarkLatticeLerpCommand(
+		TEXT("DpNanite.BenchmarkLatticeLerp"),
+		TEXT("Compare the vector and the scalar lerp of the uniform tessellation lattice"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkLatticeLerp));
+
+	/**
+	 * Compare the tessellation strategies end to end on a synthetic sphere and displacement field: flat and PN 
+	 * triangles, each uniform and adaptive, followed by the displacement. Reports the wall time of each stage, the 
+	 * peak memory, the output triangle count and the geometric error against a reference, a finely tessellated 
+	 * analytic sphere displaced by the same field. The adaptive strategies get the triangle budget of the uniform 
+	 * level, so the errors compare at the same size. Every run also appends a row per strategy to 
+	 * Saved/DpNanite/Benchmarks/TessellationStrategies.csv.
+	 * 
+	 * Needs no GPU or asset, e.g. for nightly runs on a Linux box:
+	 *   UnrealEditor-Cmd <Project> -unattended -nullrhi -ExecCmds="DpNanite.BenchmarkTessellationStrategies; Quit"
+	 * Usage: DpNanite.BenchmarkTessellationStrategies [Triangles=2000] [FieldSize=1024] [Level=16] 
+	 *        [ReferenceTriangles=4000000] [Tolerance=0.01] [Budget=<uniform level triangles>]
+	 */
+	static void BenchmarkTessellationStrategies(const TArray<FString>& Args)
+	{
+		const FArguments Arguments(Args);
+		const int32 NumTriangles = Arguments.Get(TEXT("Triangles="), 2000);
+		const int32 FieldSize = Arguments.Get(TEXT("FieldSize="), 1024);
+		const int32 Level = Arguments.Get(TEXT("Level="), 16);
+		const int32 ReferenceTriangles = Arguments.Get(TEXT("ReferenceTriangles="), 4000000);
+		const float Tolerance = Arguments.Get(TEXT("Tolerance="), 0.01f);
+		int32 Budget = Arguments.Get(TEXT("Budget="), 0);
+
+		constexpr double Radius = 100.0;
+		constexpr float Intensity = 5.0f;
+
+		auto MakeSphere = [](int32 TriangleCount, FDynamicMesh3& OutMesh)
+		{
+			FSphereGenerator Generator;
+			Generator.Radius = Radius;
+			Generator.NumPhi = Generator.NumTheta = FMath::Max(4, (int32)FMath::Sqrt(TriangleCount / 2.0));
+			Generator.Generate();
+			OutMesh.Copy(&Generator);
+		};
+
+		// Bumps of a few sizes, so the adaptive refinement has both flat and detailed regions. Nothing is culled.
+		TImageBuilder<FVector4f> DisplaceImage, CullImage;
+		DisplaceImage.SetDimensions(FImageDimensions(FieldSize, FieldSize));
+		CullImage.SetDimensions(FImageDimensions(FieldSize, FieldSize));
+		ParallelFor(FieldSize, [&](int32 y)
+		{
+			for (int32 x = 0; x < FieldSize; ++x)
+			{
+				const float U = (float)x / FieldSize;
+				const float V = (float)y / FieldSize;
+				const float Value = 0.5f + 0.3f * FMath::Sin(U * 12.0f * PI) * FMath::Cos(V * 6.0f * PI) 
+					+ (U > 0.5f ? 0.2f * FMath::Sin(U * 96.0f * PI) * FMath::Sin(V * 96.0f * PI) : 0.0f);
+				DisplaceImage.SetPixel((int64)y * FieldSize + x, FVector4f(Value, Value, Value, 1.0f));
+				CullImage.SetPixel((int64)y * FieldSize + x, FVector4f::One());
+			}
+		});
+		FDpScalarFieldPyramid DisplacePyramid, CullPyramid;
+		DisplacePyramid.Build(DisplaceImage, 0, FDpScalarFieldPyramid::EPrecision::Unorm16);
+		CullPyramid.Build(CullImage, 0, FDpScalarFieldPyramid::EPrecision::Unorm8);
+
+		auto IntensityFunc = [](int32, const FVector3d&, const FVector3d&) { return Intensity; };
+		auto Displace = [&](FDynamicMesh3& Mesh)
+		{
+			FMeshNormals Normals(&Mesh);
+			Normals.ComputeVertexNormals();
+			TArray<int> CullIDs;
+			ComputeDisplacement::ParallelMapInPlace(Mesh, Normals, IntensityFunc, DisplacePyramid, CullPyramid, CullIDs);
+		};
+
+		FDynamicMesh3 Source;
+		MakeSphere(NumTriangles, Source);
+		if (Budget <= 0)
+		{
+			Budget = (int32)FMath::Min(FDpUniformTessellate::ExpectedNumTriangles(Source, Level), (int64)MAX_int32);
+		}
+
+		// The reference vertices lie on the sphere, with the same UV parametrization as the source
+		FDynamicMesh3 Reference;
+		MakeSphere(ReferenceTriangles, Reference);
+		Displace(Reference);
+		FDynamicMeshAABBTree3 ReferenceSpatial(&Reference, true);
+
+		Log(TEXT("Tessellation strategies: %d triangle sphere, %d field, level %d, budget %d, reference %d triangles"),
+			Source.TriangleCount(), FieldSize, Level, Budget, Reference.TriangleCount());
+
+		struct FStrategy
+		{
+			const TCHAR* Name;
+			EDisplaceMeshToolSubdivisionType SubdivisionType;
+			bool bAdaptive;
+		};
+		const FStrategy Strategies[] = {
+			{ TEXT("flat uniform"), EDisplaceMeshToolSubdivisionType::Flat, false },
+			{ TEXT("pn uniform"), EDisplaceMeshToolSubdivisionType::PNTriangles, false },
+			{ TEXT("flat adaptive"), EDisplaceMeshToolSubdivisionType::Flat, true },
+			{ TEXT("pn adaptive"), EDisplaceMeshToolSubdivisionType::PNTriangles, true },
+		};
+
+		FString Csv;
+		const FString CsvPath = FPaths::ProjectSavedDir() / TEXT("DpNanite") / TEXT("Benchmarks") / TEXT("TessellationStrategies.csv");
+		if (IFileManager::Get().FileExists(*CsvPath) == false)
+		{
+			Csv += TEXT("Date,Strategy,SourceTriangles,FieldSize,Level,Budget,Triangles,TessellateMs,DisplaceMs,PeakMB,MaxError,RmsError\n");
+		}
+		const FString Date = FDateTime::UtcNow().ToIso8601();
+
+		for (const FStrategy& Strategy : Strategies)
+		{
+			FPeakMemorySampler MemorySampler;
+			FDynamicMesh3 Result;
+
+			double StartTime = Now();
+			bool bTessellated = false;
+			if (Strategy.bAdaptive)
+			{
+				auto EdgeError = [&](const FDynamicMesh3& Mesh, int32 EdgeID)
+				{
+					return ComputeDisplacement::EdgeDisplacementError(Mesh, EdgeID, DisplacePyramid, CullPyramid, Tolerance);
+				};
+				bTessellated = SubdivideAdaptiveInto(Source, Strategy.SubdivisionType, EdgeError, Tolerance, Budget, nullptr, nullptr, Result);
+			}
+			else
+			{
+				bTessellated = SubdivideInto(Source, Strategy.SubdivisionType, Level, Budget, true, nullptr, nullptr, Result);
+			}
+			const double TessellateTime = Now() - StartTime;
+
+			if (bTessellated == false)
+			{
+				MemorySampler.Stop();
+				Log(TEXT("  %s failed"), Strategy.Name);
+				continue;
+			}
+
+			StartTime = Now();
+			Displace(Result);
+			const double DisplaceTime = Now() - StartTime;
+			const double PeakMB = MemorySampler.Stop() / (1024.0 * 1024.0);
+
+			// Distance of every result vertex to the reference surface
+			TArray<double> VertexErrors;
+			VertexErrors.SetNumZeroed(Result.MaxVertexID());
+			ParallelFor(Result.MaxVertexID(), [&](int32 vid)
+			{
+				if (Result.IsVertex(vid))
+				{
+					double NearDistSqr = 0;
+					ReferenceSpatial.FindNearestTriangle(Result.GetVertex(vid), NearDistSqr);
+					VertexErrors[vid] = NearDistSqr;
+				}
+			});
+			double MaxError = 0, SumSquaredError = 0;
+			for (double ErrorSqr : VertexErrors)
+			{
+				MaxError = FMath::Max(MaxError, ErrorSqr);
+				SumSquaredError += ErrorSqr;
+			}
+			MaxError = FMath::Sqrt(MaxError);
+			const double RmsError = FMath::Sqrt(SumSquaredError / FMath::Max(Result.VertexCount(), 1));
+
+			Log(TEXT("  %s: %d triangles, tessellate %f ms, displace %f ms, peak memory %.1f MB, error max %g rms %g (%.3f%% of radius)"),
+				Strategy.Name, Result.TriangleCount(), TessellateTime, DisplaceTime, PeakMB, MaxError, RmsError, 100.0 * MaxError / Radius);
+			Csv += FString::Printf(TEXT("%s,%s,%d,%d,%d,%d,%d,%f,%f,%.1f,%g,%g\n"), *Date, Strategy.Name, Source.TriangleCount(), FieldSize, Level, Budget,
+				Result.TriangleCount(), TessellateTime, DisplaceTime, PeakMB, MaxError, RmsError);
+		}
+
+		FFileHelper::SaveStringToFile(Csv, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+	}
+
+	static FAutoConsoleCommand BenchmarkTessellationStrategiesCommand(
+		TEXT("DpNanite.BenchmarkTessellationStrategies"),
+		TEXT("Compare flat/PN uniform/adaptive tessellation plus displacement on a synthetic sphere: time, peak memory, triangles, error against a reference"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkTessellationStrategies));
+
+	/**
+	 * Compare the per pixel source texture conversion ReadTexture used before (SetPixel and FromSRGBColor per pixel)
+	 * with the row parallel converters, for the full RGBA image and for a single channel plane.
+	 * Usage: DpNanite.BenchmarkPixelConversion [Size=8192]
+	 */
+	static void BenchmarkPixelConversion(const TArray<FString>& Args)
+	{
+		const int32 Size = FArguments(Args).Get(TEXT("Size="), 8192);
+		const FImageDimensions Dimensions(Size, Size);
+		const int64 NumPixels = Dimensions.Num();
+
+		TArray64<uint8> Source;
+		Source.SetNumUninitialized(NumPixels * 8);
+		ParallelFor(Size, [&](int32 y)
+		{
+			FRandomStream Random(y);
+			for (int64 i = (int64)y * Size * 8; i < ((int64)y + 1) * Size * 8; ++i)
+			{
+				// keep the high byte of every 16 bit value below the half float Inf/NaN exponent
+				Source[i] = (uint8)Random.RandHelper((i & 1) ? 0x7C : 256);
+			}
+		});
+
+		struct FCase
+		{
+			const TCHAR* Name;
+			ETextureSourceFormat Format;
+			bool bSRGB;
+		};
+		const FCase Cases[] = {
+			{ TEXT("BGRA8 sRGB"), TSF_BGRA8, true },
+			{ TEXT("BGRA8 linear"), TSF_BGRA8, false },
+			{ TEXT("RGBA16"), TSF_RGBA16, false },
+			{ TEXT("RGBA16F"), TSF_RGBA16F, false },
+			{ TEXT("G8"), TSF_G8, false },
+		};
+
+		for (const FCase& Case : Cases)
+		{
+			TImageBuilder<FVector4f> Image;
+			double StartTime = Now();
+			Image.SetDimensions(Dimensions);
+			for (int64 i = 0; i < NumPixels; ++i)
+			{
+				if (Case.Format == TSF_BGRA8)
+				{
+					const FColor PixelColor = reinterpret_cast<const FColor*>(Source.GetData())[i];
+					Image.SetPixel(i, ToVector4<float>(Case.bSRGB ? FLinearColor::FromSRGBColor(PixelColor) : PixelColor.ReinterpretAsLinear()));
+				}
+				else if (Case.Format == TSF_RGBA16)
+				{
+					const uint16* PixelPtr = reinterpret_cast<const uint16*>(Source.GetData()) + 4 * i;
+					Image.SetPixel(i, FVector4f(PixelPtr[0] / 65535.0f, PixelPtr[1] / 65535.0f, PixelPtr[2] / 65535.0f, PixelPtr[3] / 65535.0f));
+				}
+				else if (Case.Format == TSF_RGBA16F)
+				{
+					Image.SetPixel(i, ToVector4<float>(reinterpret_cast<const FFloat16Color*>(Source.GetData())[i].GetFloats()));
+				}
+				else
+				{
+					const float Gray = Source[i] / 255.0f;
+					Image.SetPixel(i, FVector4f(Gray, Gray, Gray, 1.0f));
+				}
+			}
+			const double PerPixelTime = Now() - StartTime;
+
+			TImageBuilder<FVector4f> ConvertedImage;
+			StartTime = Now();
+			UE::AssetUtils::ConvertSourceImage(Case.Format, Case.bSRGB, Source.GetData(), Dimensions, ConvertedImage);
+			const double ImageTime = Now() - StartTime;
+
+			TArray64<float> Plane;
+			StartTime = Now();
+			UE::AssetUtils::ConvertSourceImageChannel(Case.Format, Case.bSRGB, 0, Source.GetData(), Dimensions, Plane);
+			const double ChannelTime = Now() - StartTime;
+
+			float MaxDifference = 0;
+			for (int64 i = 0; i < NumPixels; i += 97)
+			{
+				const FVector4f Difference = Image.GetPixel(i) - ConvertedImage.GetPixel(i);
+				MaxDifference = FMath::Max(MaxDifference, FMath::Max(FMath::Max(FMath::Abs(Difference.X), FMath::Abs(Difference.Y)), FMath::Max(FMath::Abs(Difference.Z), FMath::Abs(Difference.W))));
+				MaxDifference = FMath::Max(MaxDifference, FMath::Abs(Image.GetPixel(i).X - Plane[i]));
+			}
+
+			Log(TEXT("%dx%d %s: per pixel %f ms, converters %f ms (%.1fx), red plane %f ms (%.1fx), max difference %g"),
+				Size, Size, Case.Name, PerPixelTime, ImageTime, Speedup(PerPixelTime, ImageTime), ChannelTime, Speedup(PerPixelTime, ChannelTime), MaxDifference);
+		}
+	}
+
+	static FAutoConsoleCommand BenchmarkPixelConversionCommand(
+		TEXT("DpNanite.BenchmarkPixelConversion"),
+		TEXT("Compare per pixel texture source conversion with the row parallel converters"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkPixelConversion));
+
+	/**
+	 * Memory and throughput of the displacement fields: decoding a BGRA8 source to a float RGBA image and copying the
+	 * displacement and cull channels to FSampledScalarField2f grids, as the displacement used to, against building 
+	 * the FDpScalarFieldPyramid planes straight from the source rows. Then bilinear sampling throughput of both, and
+	 * the largest difference between their samples.
+	 * Usage: DpNanite.BenchmarkDisplacementField [Size=8192] [Samples=10000000]
+	 */
+	static void BenchmarkDisplacementField(const TArray<FString>& Args)
+	{
+		const FArguments Arguments(Args);
+		const int32 Size = Arguments.Get(TEXT("Size="), 8192);
+		const int32 NumSamples = Arguments.Get(TEXT("Samples="), 10000000);
+		const FImageDimensions Dimensions(Size, Size);
+		const int64 NumPixels = Dimensions.Num();
+
+		TArray64<uint8> Source;
+		Source.SetNumUninitialized(NumPixels * 4);
+		ParallelFor(Size, [&](int32 y)
+		{
+			for (int32 x = 0; x < Size; ++x)
+			{
+				const float Value = 0.5f + 0.5f * FMath::Sin(x * 0.01f) * FMath::Cos(y * 0.013f);
+				FColor* Pixel = reinterpret_cast<FColor*>(Source.GetData()) + (int64)y * Size + x;
+				*Pixel = FColor((uint8)(Value * 255.0f), 0, (x % 512 < 16) ? 0 : 255, 255);
+			}
+		});
+
+		// float path: RGBA image, then two float grids
+		double StartTime = Now();
+		FSampledScalarField2f DisplaceField, CullField;
+		int64 FloatPeakBytes = 0;
+		{
+			TImageBuilder<FVector4f> Image;
+			UE::AssetUtils::ConvertSourceImage(TSF_BGRA8, false, Source.GetData(), Dimensions, Image);
+			DisplaceField.Resize(Size, Size, 0.0f);
+			CullField.Resize(Size, Size, 0.0f);
+			DisplaceField.SetCellSize(1.0f / (float)Size);
+			CullField.SetCellSize(1.0f / (float)Size);
+			ParallelFor(Size, [&](int32 y)
+			{
+				for (int64 Index = (int64)y * Size; Index < ((int64)y + 1) * Size; ++Index)
+				{
+					DisplaceField.GridValues[Index] = Image.GetPixel(Index).X;
+					CullField.GridValues[Index] = Image.GetPixel(Index).Z;
+				}
+			});
+			FloatPeakBytes = NumPixels * (int64)sizeof(FVector4f) + 2 * NumPixels * (int64)sizeof(float);
+		}
+		const double FloatBuildTime = Now() - StartTime;
+
+		// compact path: both pyramids straight from the source rows
+		StartTime = Now();
+		FDpScalarFieldPyramid DisplacePyramid, CullPyramid;
+		DisplacePyramid.Build(Dimensions, [&](int32 FirstY, int32 NumRows, float* OutValues)
+		{
+			UE::AssetUtils::ConvertSourceChannel(TSF_BGRA8, false, 0, Source.GetData() + (int64)FirstY * Size * 4, (int64)NumRows * Size, OutValues);
+		}, FDpScalarFieldPyramid::EPrecision::Unorm8);
+		CullPyramid.Build(Dimensions, [&](int32 FirstY, int32 NumRows, float* OutValues)
+		{
+			UE::AssetUtils::ConvertSourceChannel(TSF_BGRA8, false, 2, Source.GetData() + (int64)FirstY * Size * 4, (int64)NumRows * Size, OutValues);
+		}, FDpScalarFieldPyramid::EPrecision::Unorm8);
+		const double CompactBuildTime = Now() - StartTime;
+		const int64 CompactBytes = DisplacePyramid.GetAllocatedSize() + CullPyramid.GetAllocatedSize();
+
+		TArray<FVector2f> UVs;
+		UVs.SetNumUninitialized(NumSamples);
+		FRandomStream Random(NumSamples);
+		for (FVector2f& UV : UVs)
+		{
+			UV = FVector2f(Random.FRand(), Random.FRand());
+		}
+
+		auto MeasureSampling = [&](auto& Field, TArray<float>& OutSamples)
+		{
+			OutSamples.SetNumUninitialized(NumSamples);
+			const double SampleStartTime = Now();
+			ParallelFor(NumSamples, [&](int32 i)
+			{
+				OutSamples[i] = Field.BilinearSampleClamped(UVs[i]);
+			});
+			return Now() - SampleStartTime;
+		};
+		TArray<float> FloatSamples, CompactSamples;
+		const double FloatSampleTime = MeasureSampling(DisplaceField, FloatSamples);
+		const double CompactSampleTime = MeasureSampling(DisplacePyramid, CompactSamples);
+		float MaxDifference = 0;
+		for (int32 i = 0; i < NumSamples; ++i)
+		{
+			MaxDifference = FMath::Max(MaxDifference, FMath::Abs(FloatSamples[i] - CompactSamples[i]));
+		}
+
+		Log(TEXT("Displacement field %dx%d, float image + grids: build %f ms, %lld MB peak, %lld MB kept"),
+			Size, Size, FloatBuildTime, FloatPeakBytes >> 20, (2 * NumPixels * (int64)sizeof(float)) >> 20);
+		Log(TEXT("Displacement field %dx%d, 8 bit pyramids: build %f ms, %lld MB kept (%.1fx less than the float peak)"),
+			Size, Size, CompactBuildTime, CompactBytes >> 20, (double)FloatPeakBytes / FMath::Max(CompactBytes, (int64)1));
+		Log(TEXT("%d bilinear samples: float grid %f ms, pyramid %f ms, max difference %g"),
+			NumSamples, FloatSampleTime, CompactSampleTime, MaxDifference);
+	}
+
+	static FAutoConsoleCommand BenchmarkDisplacementFieldCommand(
+		TEXT("DpNanite.BenchmarkDisplacementField"),
+		TEXT("Compare memory, build and sampling time of the float displacement grids and the compact pyramids"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkDisplacementField));
+
+	/**
+	 * Baking a float RGBA image back to a UTexture2D: the per texel clamp and ToFColor() / FFloat16Color conversion
+	 * FTexture2DBuilder::Copy() used to do, against the row parallel kernels writing into the locked mip, for 8 bit
+	 * linear, 8 bit sRGB and half float textures. Also times CopyImageToSourceData() in the Editor.
+	 * Usage: DpNanite.BenchmarkTextureBuilderCopy [Size=8192]
+	 */
+	static void BenchmarkTextureBuilderCopy(const TArray<FString>& Args)
+	{
+		const int32 Size = FArguments(Args).Get(TEXT("Size="), 8192);
+		const FImageDimensions Dimensions(Size, Size);
+		const int64 NumPixels = Dimensions.Num();
+
+		// slightly outside [0,1] so that the clamp is exercised
+		TImageBuilder<FVector4f> Image;
+		Image.SetDimensions(Dimensions);
+		ParallelFor(Size, [&](int32 y)
+		{
+			FRandomStream Random(y);
+			for (int32 x = 0; x < Size; ++x)
+			{
+				Image.SetPixel((int64)y * Size + x, FVector4f(Random.FRandRange(-0.1f, 1.1f), Random.FRandRange(-0.1f, 1.1f), Random.FRandRange(-0.1f, 1.1f), Random.FRandRange(-0.1f, 1.1f)));
+			}
+		});
+
+		struct FCase
+		{
+			const TCHAR* Name;
+			FTexture2DBuilder::ETextureType TextureType;
+			bool bSRGB;
+		};
+		const FCase Cases[] = {
+			{ TEXT("BGRA8 linear"), FTexture2DBuilder::ETextureType::ColorLinear, false },
+			{ TEXT("BGRA8 sRGB"), FTexture2DBuilder::ETextureType::Color, true },
+			{ TEXT("RGBA16F"), FTexture2DBuilder::ETextureType::EmissiveHDR, false },
+		};
+
+		for (const FCase& Case : Cases)
+		{
+			const bool bHalfFloat = Case.TextureType == FTexture2DBuilder::ETextureType::EmissiveHDR;
+			TArray64<FColor> ByteTexels;
+			TArray64<FFloat16Color> HalfTexels;
+			double StartTime = Now();
+			if (bHalfFloat)
+			{
+				HalfTexels.SetNumUninitialized(NumPixels);
+				for (int64 i = 0; i < NumPixels; ++i)
+				{
+					HalfTexels[i] = FFloat16Color(ToLinearColor(Image.GetPixel(i)));
+				}
+			}
+			else
+			{
+				ByteTexels.SetNumUninitialized(NumPixels);
+				for (int64 i = 0; i < NumPixels; ++i)
+				{
+					FVector4f Pixel = Image.GetPixel(i);
+					Pixel.X = FMathf::Clamp(Pixel.X, 0.0, 1.0);
+					Pixel.Y = FMathf::Clamp(Pixel.Y, 0.0, 1.0);
+					Pixel.Z = FMathf::Clamp(Pixel.Z, 0.0, 1.0);
+					Pixel.W = FMathf::Clamp(Pixel.W, 0.0, 1.0);
+					ByteTexels[i] = ToLinearColor(Pixel).ToFColor(Case.bSRGB);
+				}
+			}
+			const double PerTexelTime = Now() - StartTime;
+
+			FTexture2DBuilder Builder;
+			if (Builder.Initialize(Case.TextureType, Dimensions) == false)
+			{
+				Log(TEXT("%s: could not create a %dx%d texture"), Case.Name, Size, Size);
+				continue;
+			}
+			StartTime = Now();
+			Builder.Copy(Image, Case.bSRGB);
+			const double CopyTime = Now() - StartTime;
+
+			int32 MaxDifference = 0;
+			for (int64 i = 0; i < NumPixels; i += 97)
+			{
+				if (bHalfFloat)
+				{
+					const FFloat16Color& Texel = Builder.GetTexelFloat16(i);
+					MaxDifference = FMath::Max(MaxDifference, (int32)(Texel.R.Encoded != HalfTexels[i].R.Encoded) + (int32)(Texel.G.Encoded != HalfTexels[i].G.Encoded)
+						+ (int32)(Texel.B.Encoded != HalfTexels[i].B.Encoded) + (int32)(Texel.A.Encoded != HalfTexels[i].A.Encoded));
+				}
+				else
+				{
+					const FColor& Texel = Builder.GetTexel(i);
+					MaxDifference = FMath::Max(MaxDifference, FMath::Max(FMath::Max(FMath::Abs(Texel.R - ByteTexels[i].R), FMath::Abs(Texel.G - ByteTexels[i].G)),
+						FMath::Max(FMath::Abs(Texel.B - ByteTexels[i].B), FMath::Abs(Texel.A - ByteTexels[i].A))));
+				}
+			}
+			Builder.Cancel();
+
+			double SourceDataTime = 0;
+#if WITH_EDITOR
+			StartTime = Now();
+			Builder.CopyImageToSourceData(Image, bHalfFloat ? TSF_RGBA16F : TSF_BGRA8, Case.bSRGB);
+			SourceDataTime = Now() - StartTime;
+#endif
+
+			Log(TEXT("%dx%d %s: per texel %f ms, builder copy %f ms (%.1fx), source data %f ms, max difference %d"),
+				Size, Size, Case.Name, PerTexelTime, CopyTime, Speedup(PerTexelTime, CopyTime), SourceDataTime, MaxDifference);
+		}
+	}
+
+	static FAutoConsoleCommand BenchmarkTextureBuilderCopyCommand(
+		TEXT("DpNanite.BenchmarkTextureBuilderCopy"),
+		TEXT("Compare the per texel FTexture2DBuilder copy with the row parallel kernels"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkTextureBuilderCopy));
+
+	/**
+	 * The preview re-displacement of FDpMeshOptional::UpdateDisplacement against displacing again: the full path
+	 * computes the vertex normals and samples the displacement map per vertex (tessellating is not counted), the 
+	 * update re-samples the FDisplacementCache and pushes the positions to a UDynamicMeshComponent with 
+	 * FastNotifyPositionsUpdated. Also checks that re-displacing with the original parameters gives back the 
+	 * displaced positions.
+	 * Usage: DpNanite.BenchmarkUpdateDisplacement [Triangles=2000000] [FieldSize=2048] [Updates=10]
+	 */
+	static void BenchmarkUpdateDisplacement(const TArray<FString>& Args)
+	{
+		const FArguments Arguments(Args);
+		const int32 NumTriangles = Arguments.Get(TEXT("Triangles="), 2000000);
+		const int32 FieldSize = Arguments.Get(TEXT("FieldSize="), 2048);
+		const int32 NumUpdates = FMath::Max(1, Arguments.Get(TEXT("Updates="), 10));
+
+		FRectangleMeshGenerator Generator;
+		Generator.Width = 1000.0;
+		Generator.Height = 1000.0;
+		Generator.WidthVertexCount = Generator.HeightVertexCount = FMath::Max(2, (int32)FMath::Sqrt(NumTriangles / 2.0) + 1);
+		Generator.Generate();
+		FDynamicMesh3 Mesh(&Generator);
+		const int32 NumVertices = Mesh.VertexCount();
+
+		// nothing is culled, so the UV transform could change too
+		TImageBuilder<FVector4f> DisplaceImage;
+		DisplaceImage.SetDimensions(FImageDimensions(FieldSize, FieldSize));
+		ParallelFor(FieldSize, [&](int32 y)
+		{
+			for (int32 x = 0; x < FieldSize; ++x)
+			{
+				const float Value = 0.5f + 0.5f * FMath::Sin(x * 0.05f) * FMath::Cos(y * 0.05f);
+				DisplaceImage.SetPixel((int64)y * FieldSize + x, FVector4f(Value, Value, Value, 1.0f));
+			}
+		});
+		FDpScalarFieldPyramid DisplacePyramid, CullPyramid;
+		DisplacePyramid.Build(DisplaceImage, 0, FDpScalarFieldPyramid::EPrecision::Unorm16);
+		CullPyramid.Build(DisplaceImage, 3, FDpScalarFieldPyramid::EPrecision::Unorm8);
+		DisplaceImage = TImageBuilder<FVector4f>();
+
+		// full path, capturing the cache the way a conversion with SetKeepPreview(true) does
+		FDisplacementCache Cache;
+		Cache.Intensity = 5.0f;
+		auto WeightFunc = [](int32, const FVector3d&, const FVector3d&) { return 1.0f; };
+		auto IntensityFunc = [&Cache](int32, const FVector3d&, const FVector3d&) { return Cache.Intensity; };
+		const double StartTime = Now();
+		FMeshNormals Normals(&Mesh);
+		Normals.ComputeVertexNormals();
+		Cache.Capture(Mesh, Normals, WeightFunc);
+		TArray<int> CullIDs;
+		TArray<int32> VertexElements;
+		ComputeDisplacement::ParallelMapInPlace(Mesh, Normals, IntensityFunc, DisplacePyramid, CullPyramid, CullIDs,
+			Cache.BaseValue, Cache.UVScale, Cache.UVOffset, nullptr, &VertexElements);
+		const double FullTime = Now() - StartTime;
+		Cache.CaptureUVs(Mesh, VertexElements, CullPyramid);
+		Cache.DisplaceField = MoveTemp(DisplacePyramid);
+
+		TArray<FVector3d> DisplacedPositions;
+		DisplacedPositions.SetNumUninitialized(Mesh.MaxVertexID());
+		for (int32 vid : Mesh.VertexIndicesItr())
+		{
+			DisplacedPositions[vid] = Mesh.GetVertex(vid);
+		}
+		Cache.Displace(Mesh);
+		double MaxError = 0;
+		for (int32 vid : Mesh.VertexIndicesItr())
+		{
+			MaxError = FMath::Max(MaxError, Distance(DisplacedPositions[vid], Mesh.GetVertex(vid)));
+		}
+
+		// without a world the component has no render proxy, only the re-displacement is timed then
+		UWorld* World = GWorld;
+		UDynamicMeshComponent* Preview = NewObject<UDynamicMeshComponent>(GetTransientPackage());
+		if (World)
+		{
+			Preview->RegisterComponentWithWorld(World);
+		}
+		Preview->SetMesh(MoveTemp(Mesh));
+		double UpdateTime = 0;
+		for (int32 Update = 0; Update < NumUpdates; ++Update)
+		{
+			Cache.Intensity = 5.0f + Update;
+			const double UpdateStartTime = Now();
+			RedisplacePreview(Cache, *Preview);
+			UpdateTime += Now() - UpdateStartTime;
+		}
+		UpdateTime /= NumUpdates;
+		Preview->DestroyComponent();
+
+		Log(TEXT("Update displacement %d vertices: full displacement %f ms, preview update %f ms (x%.2f)%s, max error %g"),
+			NumVertices, FullTime, UpdateTime, Speedup(FullTime, UpdateTime), World ? TEXT("") : TEXT(" without a render proxy"), MaxError);
+	}
+
+	static FAutoConsoleCommand BenchmarkUpdateDisplacementCommand(
+		TEXT("DpNanite.BenchmarkUpdateDisplacement"),
+		TEXT("Compare the cached preview re-displacement with displacing again, and check it reproduces the displacement"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkUpdateDisplacement));
+
+} // namespace DpBenchmarks
@@ -0,0 +1,260 @@
+#include "DpBulkMeshBuilder.h"
+#include "Async/ParallelFor.h"
+#include "Runtime/Launch/Resources/Version.h"
+#include <atomic>
+
+using namespace UE::Geometry;
+
+namespace DpBulkMeshBuilderLocals
+{
+	/** References to the internal storage of an FDynamicMesh3 */
+	struct FMeshStorage
+	{
+		TDynamicVector<FVector3d>& Vertices;
+		FRefCountVector& VertexRefCounts;
+		FSmallListSet& VertexEdgeLists;
+		TDynamicVector<FIndex3i>& Triangles;
+		FRefCountVector& TriangleRefCounts;
+		TDynamicVector<FIndex3i>& TriangleEdges;
+		TOptional<TDynamicVector<int>>& TriangleGroups;
+		int& GroupIDCounter;
+		TDynamicVector<FDynamicMesh3::FEdge>& Edges;
+		FRefCountVector& EdgeRefCounts;
+	};
+
+	/**
+	 * The only access to FDynamicMesh3 internals. The protected members are named through a derived class, where
+	 * they are accessible, and applied to Mesh as pointers to FDynamicMesh3 members: no FDynamicMesh3 is ever cast
+	 * to the derived type. Writing them relies on the storage layout and invariants of the engine version below,
+	 * check Build() against FDynamicMesh3::AppendVertex/AppendTriangle before changing it.
+	 */
+	struct FDynamicMesh3StorageAccess : public FDynamicMesh3
+	{
+		static_assert(ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION == 1, "FDpBulkMeshBuilder writes FDynamicMesh3 internals, check them against this engine version");
+
+		static FMeshStorage Get(FDynamicMesh3& Mesh)
+		{
+			return FMeshStorage{
+				Mesh.*(&FDynamicMesh3StorageAccess::Vertices),
+				Mesh.*(&FDynamicMesh3StorageAccess::VertexRefCounts),
+				Mesh.*(&FDynamicMesh3StorageAccess::VertexEdgeLists),
+				Mesh.*(&FDynamicMesh3StorageAccess::Triangles),
+				Mesh.*(&FDynamicMesh3StorageAccess::TriangleRefCounts),
+				Mesh.*(&FDynamicMesh3StorageAccess::TriangleEdges),
+				Mesh.*(&FDynamicMesh3StorageAccess::TriangleGroups),
+				Mesh.*(&FDynamicMesh3StorageAccess::GroupIDCounter),
+				Mesh.*(&FDynamicMesh3StorageAccess::Edges),
+				Mesh.*(&FDynamicMesh3StorageAccess::EdgeRefCounts) };
+		}
+	};
+}
+
+bool FDpBulkMeshBuilder::Build(FDynamicMesh3& OutMesh,
+							   const int32 NumVertices, 
+							   TFunctionRef<FVector3d(int32)> VertexPosition, 
+							   TArrayView<const FIndex3i> InTriangles, 
+							   const TFunction<int32(int32)>& TriangleGroup,
+							   const bool bUseParallel)
+{
+	using namespace DpBulkMeshBuilderLocals;
+
+	OutMesh.Clear();
+	FMeshStorage Storage = FDynamicMesh3StorageAccess::Get(OutMesh);
+	TDynamicVector<FVector3d>& Vertices = Storage.Vertices;
+	FRefCountVector& VertexRefCounts = Storage.VertexRefCounts;
+	FSmallListSet& VertexEdgeLists = Storage.VertexEdgeLists;
+	TDynamicVector<FIndex3i>& Triangles = Storage.Triangles;
+	FRefCountVector& TriangleRefCounts = Storage.TriangleRefCounts;
+	TDynamicVector<FIndex3i>& TriangleEdges = Storage.TriangleEdges;
+	TOptional<TDynamicVector<int>>& TriangleGroups = Storage.TriangleGroups;
+	int& GroupIDCounter = Storage.GroupIDCounter;
+	TDynamicVector<FDynamicMesh3::FEdge>& Edges = Storage.Edges;
+	FRefCountVector& EdgeRefCounts = Storage.EdgeRefCounts;
+
+	const EParallelForFlags ParallelFlags = bUseParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+	const int32 NumTriangles = InTriangles.Num();
+	const int32 NumHalfEdges = 3 * NumTriangles;
+
+	Vertices.Resize(NumVertices);
+	ParallelFor(NumVertices, [&](int32 VertexID) 
+	{
+		Vertices[VertexID] = VertexPosition(VertexID);
+	}, ParallelFlags);
+
+	Triangles.Resize(NumTriangles);
+	TriangleEdges.Resize(NumTriangles);
+	ParallelFor(NumTriangles, [&](int32 TriangleID) 
+	{
+		Triangles[TriangleID] = InTriangles[TriangleID];
+	}, ParallelFlags);
+
+	if (TriangleGroup)
+	{
+		TriangleGroups = TDynamicVector<int>();
+		TriangleGroups->Resize(NumTriangles);
+		ParallelFor(NumTriangles, [&](int32 TriangleID) 
+		{
+			(*TriangleGroups)[TriangleID] = TriangleGroup(TriangleID);
+		}, ParallelFlags);
+		GroupIDCounter = 0;
+		for (int32 TriangleID = 0; TriangleID < NumTriangles; ++TriangleID)
+		{
+			GroupIDCounter = FMath::Max(GroupIDCounter, (*TriangleGroups)[TriangleID] + 1);
+		}
+	}
+
+	// Bucket the half-edges (TriangleID*3 + corner) by their smaller vertex. A counting sort keeps this 
+	// linear, the buckets are only as large as the vertex valence.
+	TArray<int32> BucketStart;
+	BucketStart.SetNumZeroed(NumVertices + 1);
+	TArray<int32> VertexTriangleCounts;
+	VertexTriangleCounts.SetNumZeroed(NumVertices);
+	std::atomic<bool> bIsValid(true);
+	ParallelFor(NumTriangles, [&](int32 TriangleID) 
+	{
+		const FIndex3i& Tri = InTriangles[TriangleID];
+		for (int32 Corner = 0; Corner < 3; ++Corner)
+		{
+			const int32 A = Tri[Corner];
+			const int32 B = Tri[(Corner + 1) % 3];
+			if (A == B || A < 0 || A >= NumVertices || B < 0 || B >= NumVertices)
+			{
+				bIsValid = false;
+				return;
+			}
+			FPlatformAtomics::InterlockedIncrement(&BucketStart[FMath::Min(A, B)]);
+			FPlatformAtomics::InterlockedIncrement(&VertexTriangleCounts[A]);
+		}
+	}, ParallelFlags);
+	if (bIsValid == false)
+	{
+		OutMesh.Clear();
+		return false;
+	}
+
+	int32 Sum = 0;
+	for (int32 VertexID = 0; VertexID <= NumVertices; ++VertexID)
+	{
+		const int32 Count = BucketStart[VertexID];
+		BucketStart[VertexID] = Sum;
+		Sum += Count;
+	}
+
+	TArray<int32> BucketFill;
+	BucketFill.SetNumZeroed(NumVertices);
+	TArray<int32> SortedHalfEdges;
+	SortedHalfEdges.SetNumUninitialized(NumHalfEdges);
+	ParallelFor(NumTriangles, [&](int32 TriangleID) 
+	{
+		const FIndex3i& Tri = InTriangles[TriangleID];
+		for (int32 Corner = 0; Corner < 3; ++Corner)
+		{
+			const int32 MinVertex = FMath::Min(Tri[Corner], Tri[(Corner + 1) % 3]);
+			const int32 Slot = FPlatformAtomics::InterlockedIncrement(&BucketFill[MinVertex]) - 1;
+			SortedHalfEdges[BucketStart[MinVertex] + Slot] = 3 * TriangleID + Corner;
+		}
+	}, ParallelFlags);
+	BucketFill.Empty();
+
+	auto OtherVertex = [&InTriangles](int32 HalfEdge) 
+	{
+		const FIndex3i& Tri = InTriangles[HalfEdge / 3];
+		return FMath::Max(Tri[HalfEdge % 3], Tri[(HalfEdge % 3 + 1) % 3]);
+	};
+
+	// Sort each bucket by (other vertex, half-edge), so the half-edges of an edge are adjacent and in the
+	// order their triangles were added, then count the edges of each bucket
+	TArray<int32> BucketEdgeStart;
+	BucketEdgeStart.SetNumZeroed(NumVertices + 1);
+	ParallelFor(NumVertices, [&](int32 VertexID) 
+	{
+		int32* Begin = SortedHalfEdges.GetData() + BucketStart[VertexID];
+		const int32 Num = BucketStart[VertexID + 1] - BucketStart[VertexID];
+		TArrayView<int32>(Begin, Num).Sort([&OtherVertex](int32 A, int32 B) 
+		{
+			const int32 OtherA = OtherVertex(A);
+			const int32 OtherB = OtherVertex(B);
+			return OtherA != OtherB ? OtherA < OtherB : A < B;
+		});
+
+		int32 NumEdges = 0;
+		for (int32 Idx = 0; Idx < Num; ) 
+		{
+			int32 End = Idx + 1;
+			while (End < Num && OtherVertex(Begin[End]) == OtherVertex(Begin[Idx])) 
+			{
+				++End;
+			}
+			if (End - Idx > 2) 
+			{
+				bIsValid = false;
+			}
+			++NumEdges;
+			Idx = End;
+		}
+		BucketEdgeStart[VertexID] = NumEdges;
+	}, ParallelFlags);
+	if (bIsValid == false)
+	{
+		OutMesh.Clear();
+		return false;
+	}
+
+	int32 NumEdges = 0;
+	for (int32 VertexID = 0; VertexID <= NumVertices; ++VertexID)
+	{
+		const int32 Count = BucketEdgeStart[VertexID];
+		BucketEdgeStart[VertexID] = NumEdges;
+		NumEdges += Count;
+	}
+
+	Edges.Resize(NumEdges);
+	ParallelFor(NumVertices, [&](int32 VertexID) 
+	{
+		const int32* Begin = SortedHalfEdges.GetData() + BucketStart[VertexID];
+		const int32 Num = BucketStart[VertexID + 1] - BucketStart[VertexID];
+		int32 EdgeID = BucketEdgeStart[VertexID];
+		for (int32 Idx = 0; Idx < Num; ++EdgeID) 
+		{
+			const int32 Other = OtherVertex(Begin[Idx]);
+			const bool bHasSecond = Idx + 1 < Num && OtherVertex(Begin[Idx + 1]) == Other;
+			const int32 TriA = Begin[Idx] / 3;
+			const int32 TriB = bHasSecond ? Begin[Idx + 1] / 3 : FDynamicMesh3::InvalidID;
+			Edges[EdgeID] = FDynamicMesh3::FEdge{ FIndex2i(VertexID, Other), FIndex2i(TriA, TriB) };
+
+			// each triangle owns its corners' slots in TriangleEdges, no two writers share one
+			TriangleEdges[TriA][Begin[Idx] % 3] = EdgeID;
+			if (bHasSecond) 
+			{
+				TriangleEdges[TriB][Begin[Idx + 1] % 3] = EdgeID;
+			}
+			Idx += bHasSecond ? 2 : 1;
+		}
+	}, ParallelFlags);
+	SortedHalfEdges.Empty();
+	BucketStart.Empty();
+	BucketEdgeStart.Empty();
+
+	// Reference counts and edge lists can only be grown one element at a time
+	for (int32 VertexID = 0; VertexID < NumVertices; ++VertexID)
+	{
+		VertexRefCounts.Allocate();
+		VertexEdgeLists.AllocateAt(VertexID);
+		if (VertexTriangleCounts[VertexID] > 0) 
+		{
+			VertexRefCounts.Increment(VertexID, (unsigned short)VertexTriangleCounts[VertexID]);
+		}
+	}
+	for (int32 TriangleID = 0; TriangleID < NumTriangles; ++TriangleID)
+	{
+		TriangleRefCounts.Allocate();
+	}
+	for (int32 EdgeID = 0; EdgeID < NumEdges; ++EdgeID)
+	{
+		EdgeRefCounts.Allocate();
+		VertexEdgeLists.Insert(Edges[EdgeID].Vert.A, EdgeID);
+		VertexEdgeLists.Insert(Edges[EdgeID].Vert.B, EdgeID);
+	}
+
+	return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DynamicMesh/DynamicMesh3.h"
+
+namespace UE
+{
+namespace Geometry
+{
+
+/**
+ * Builds the topology of an FDynamicMesh3 from a vertex and triangle list in bulk. AppendTriangle() looks up and 
+ * inserts the three edges of every triangle one at a time, which makes it the serial bottleneck of the 
+ * tessellation. Here the vertex and triangle storage is presized and written in parallel, and the edges are found
+ * with a parallel bucket sort of the triangle half-edges by vertex pair. Only the reference counts and the vertex 
+ * edge lists, which have no bulk interface, are filled serially.
+ * 
+ * The result is the mesh AppendVertex()/AppendTriangle() would build in the same order, except that the edges
+ * are numbered by their smaller vertex ID instead of by first use.
+ * 
+ * FDynamicMesh3 has no public bulk interface, so this writes its internal storage. All of that access goes 
+ * through one function in DpBulkMeshBuilder.cpp, which is checked against the engine version it was written for.
+ */
+class FDpBulkMeshBuilder
+{
+public:
+	/**
+	 * @param OutMesh cleared and rebuilt with the vertices and triangles, without attributes
+	 * @param VertexPosition position of each of the NumVertices vertices
+	 * @param InTriangles the triangles, can point straight into a mapped file
+	 * @param TriangleGroup group of each triangle, unset if the mesh has no triangle groups
+	 * @return false if the triangles are degenerate or not manifold (an edge with more than two triangles), 
+	 * OutMesh is left empty then
+	 */
+	static bool Build(FDynamicMesh3& OutMesh,
+					  const int32 NumVertices, 
+					  TFunctionRef<FVector3d(int32)> VertexPosition, 
+					  TArrayView<const FIndex3i> InTriangles, 
+					  const TFunction<int32(int32)>& TriangleGroup,
+					  const bool bUseParallel);
+};
+
+} // end namespace UE::Geometry
+} // end namespace UE
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "DpMeshOptional.h"
+#include "DpScalarFieldPyramid.h"
+#include "DynamicMesh/MeshNormals.h"
+
+/**
+ * Internal to the plugin: the displacement, subdivision and re-displacement helpers of DpMeshOptional.cpp that
+ * DpBenchmarks.cpp measures. Not meant to be included by anything else.
+ */
+namespace DisplaceMeshToolLocals
+{
+	enum class EDisplaceMeshToolSubdivisionType : uint8
+	{
+		/** Subdivide the mesh using loop-style subdivision. */
+		Flat,
+
+		/** Subdivide the mesh using PN triangles which replace each original flat triangle by a curved shape that is
+			retriangulated into a number of small subtriangles. The geometry of a PN triangle is defined as one cubic Bezier
+			patch using control points. The patch matches the point and normal information at the vertices of the original
+			flat triangle.*/
+		PNTriangles,
+	};
+
+	namespace ComputeDisplacement
+	{
+		/** Error used to drive adaptive tessellation, in texture value units, see DpMeshOptional.cpp */
+		double EdgeDisplacementError(const FDynamicMesh3& Mesh,
+			int32 EdgeID,
+			const FDpScalarFieldPyramid& DisplaceField,
+			const FDpScalarFieldPyramid& CullField,
+			double Tolerance,
+			FVector2f UVScale = FVector2f(1, 1),
+			FVector2f UVOffset = FVector2f(0, 0));
+
+		/**
+		 * Displace Positions along Normals by the field sampled at the UVs, serially and once per triangle corner.
+		 * Instantiated for FSampledScalarField2f.
+		 */
+		template<typename FieldType>
+		void Map(const FDynamicMesh3& Mesh,
+			const TArray<FVector3d>& Positions,
+			const FMeshNormals& Normals,
+			TFunctionRef<float(int32, const FVector3d&, const FVector3d&)> IntensityFunc,
+			const FieldType& DisplaceField,
+			const FieldType& CullField,
+			TArray<FVector3d>& DisplacedPositions,
+			TArray<int>& TriCullIDs,
+			float DisplaceFieldBaseValue = 128.0/255, // value that corresponds to zero displacement
+			FVector2f UVScale = FVector2f(1, 1),
+			FVector2f UVOffset = FVector2f(0,0),
+			FRichCurve* AdjustmentCurve = nullptr);
+
+		/** Same result as Map(), sampled once per vertex in UV tile order. Instantiated for FSampledScalarField2f. */
+		template<typename FieldType>
+		void ParallelMap(const FDynamicMesh3& Mesh,
+			const TArray<FVector3d>& Positions,
+			const FMeshNormals& Normals,
+			TFunctionRef<float(int32, const FVector3d&, const FVector3d&)> IntensityFunc,
+			const FieldType& DisplaceField,
+			const FieldType& CullField,
+			TArray<FVector3d>& DisplacedPositions,
+			TArray<int>& TriCullIDs,
+			float DisplaceFieldBaseValue = 128.0/255, // value that corresponds to zero displacement
+			FVector2f UVScale = FVector2f(1, 1),
+			FVector2f UVOffset = FVector2f(0,0),
+			FRichCurve* AdjustmentCurve = nullptr);
+
+		/**
+		 * Same as ParallelMap(), writing the positions of Mesh directly. If OutVertexElements is set, it receives the
+		 * UV element each vertex was sampled at. Instantiated for FDpScalarFieldPyramid.
+		 */
+		template<typename FieldType>
+		void ParallelMapInPlace(FDynamicMesh3& Mesh,
+			const FMeshNormals& Normals,
+			TFunctionRef<float(int32, const FVector3d&, const FVector3d&)> IntensityFunc,
+			const FieldType& DisplaceField,
+			const FieldType& CullField,
+			TArray<int>& TriCullIDs,
+			float DisplaceFieldBaseValue = 128.0/255, // value that corresponds to zero displacement
+			FVector2f UVScale = FVector2f(1, 1),
+			FVector2f UVOffset = FVector2f(0,0),
+			FRichCurve* AdjustmentCurve = nullptr,
+			TArray<int32>* OutVertexElements = nullptr,
+			FProgressCancel* Progress = nullptr);
+	}
+
+	/**
+	 * Tessellate SourceMesh into OutMesh without any intermediate copy of the tessellated mesh. A result with more 
+	 * than TriangleBudget triangles fails, use SubdivideChunks for it, unless bClampToBudget lowers SubdivisionsCount
+	 * until it fits.
+	 * @param ControlPointCache PN control points of SourceMesh from an earlier run, may be null
+	 */
+	bool SubdivideInto(const FDynamicMesh3& SourceMesh,
+		EDisplaceMeshToolSubdivisionType SubdivisionType,
+		int SubdivisionsCount,
+		int32 TriangleBudget,
+		bool bClampToBudget,
+		const TSharedPtr<FDpPNControlPointCache, ESPMode::ThreadSafe>& ControlPointCache,
+		FProgressCancel* Progress,
+		FDynamicMesh3& OutMesh);
+
+	/**
+	 * Tessellate SourceMesh as a series of meshes of at most ChunkTriangleBudget triangles each, for results that do
+	 * not fit in one, see FDpUniformTessellate::ComputeChunks. Each chunk is handed to ChunkCallback, which can move
+	 * it away, only one is held at a time.
+	 */
+	bool SubdivideChunks(const FDynamicMesh3& SourceMesh,
+		EDisplaceMeshToolSubdivisionType SubdivisionType,
+		int SubdivisionsCount,
+		int64 ChunkTriangleBudget,
+		FProgressCancel* Progress,
+		TFunctionRef<bool(FDynamicMesh3& Chunk, int32 ChunkIndex)> ChunkCallback);
+
+	/** Tessellate SourceMesh into OutMesh, refining edges while EdgeError is above ErrorThreshold, within TriangleBudget. */
+	bool SubdivideAdaptiveInto(const FDynamicMesh3& SourceMesh,
+		EDisplaceMeshToolSubdivisionType SubdivisionType,
+		const TFunction<double(const FDynamicMesh3&, int32)>& EdgeError,
+		double ErrorThreshold,
+		int32 TriangleBudget,
+		const TSharedPtr<FDpPNControlPointCache, ESPMode::ThreadSafe>& ControlPointCache,
+		FProgressCancel* Progress,
+		FDynamicMesh3& OutMesh);
+
+	/**
+	 * Per vertex inputs of the texture map displacement of a computed result. With them, a change of the intensity,
+	 * base value, adjustment curve or UV transform only re-evaluates one field sample per vertex, instead of
+	 * tessellating, computing normals and displacing again. Kept by FDpMeshOptional while its result is previewed.
+	 */
+	struct FDisplacementCache
+	{
+		/** The displacement field, taken over from the conversion once it no longer samples it */
+		FDpScalarFieldPyramid DisplaceField;
+		/** Parameters the result is currently displaced with */
+		float Intensity = 0.0f;
+		float BaseValue = 128.0f/255;
+		FVector2f UVScale = FVector2f(1, 1);
+		FVector2f UVOffset = FVector2f(0, 0);
+		TSharedPtr<FRichCurve, ESPMode::ThreadSafe> AdjustmentCurve;
+		/** Undisplaced positions and the normals they are displaced along */
+		TArray<FVector3d> BasePositions;
+		TArray<FVector3d> Normals;
+		/** UV the displacement is sampled at, before the UV transform */
+		TArray<FVector2f> UVs;
+		/** Directional filter and weight map factor, zero for vertices without UVs, which are not displaced */
+		TArray<float> Weights;
+		/** Which triangles are culled, or where the tessellation is refined, depends on the UV transform */
+		bool bTopologyFollowsUVs = false;
+		/** The conversion recomputed the normals after displacing */
+		bool bRecalculateNormals = false;
+
+		/** Record positions, normals and weights of Mesh before it is displaced */
+		void Capture(const FDynamicMesh3& Mesh, const FMeshNormals& MeshNormals, TFunctionRef<float(int32, const FVector3d&, const FVector3d&)> WeightFunc);
+
+		/**
+		 * Record the UVs the displacement sampled, VertexElements as returned by ComputeDisplacement::ParallelMapInPlace.
+		 * Sets bTopologyFollowsUVs if CullField culls anywhere.
+		 */
+		void CaptureUVs(const FDynamicMesh3& Mesh, const TArray<int32>& VertexElements, const FDpScalarFieldPyramid& CullField);
+
+		/** Follow the vertex compaction of CullAndCompact */
+		void Compact(const TArray<int32>& VertexRemap, int32 NumVertices);
+
+		/** Displace the vertices of the (compacted) mesh the cache was captured from, with the current parameters */
+		void Displace(FDynamicMesh3& Mesh) const;
+	};
+
+	/**
+	 * Re-displace the mesh of Preview, the result Cache was captured from, and push only the new positions to its
+	 * render proxy with FastNotifyPositionsUpdated. Topology, attributes and normals are left as they are.
+	 */
+	void RedisplacePreview(const FDisplacementCache& Cache, UDynamicMeshComponent& Preview);
+}
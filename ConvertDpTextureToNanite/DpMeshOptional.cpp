@@ -2,18 +2,30 @@
 
 #include "DpPNTriangles.h"
 #include "DpUniformTessellate.h"
+#include "DpAdaptiveTessellate.h"
+#include "DpScalarFieldPyramid.h"
+#include "DpTessellationCache.h"
+#include "DpParallelNormals.h"
+#include "DpBulkMeshBuilder.h"
+#include "DpDisplacementLocals.h"
 #include "DynamicMeshToMeshDescription.h"
 #include "StaticMeshAttributes.h"
 #include "Components/StaticMeshComponent.h"
 #include "DynamicMesh/MeshNormals.h"
+#include "DynamicMesh/DynamicVertexSkinWeightsAttribute.h"
 #include "Engine/StaticMesh.h"
+#include "StaticMeshResources.h"
 #include "Image/ImageBuilder.h"
 #include "Math/Vector.h"
 #include "InteractiveToolsFramework/Public/TargetInterfaces/MeshTargetInterfaceTypes.h"
 #include "MeshConversion/Public/MeshDescriptionToDynamicMesh.h"
 #include "AssetUtils/Texture2DUtil.h"
+#include "AssetUtils/MeshDescriptionUtil.h"
 #include "GeometryCore/Public/BoxTypes.h"
 #include "Misc/AutomationTest.h"
+#include "Async/Async.h"
+#include "Misc/SecureHash.h"
+#include "Misc/ScopeLock.h"
 
 struct FPerlinLayerProperties;
 
@@ -229,18 +241,156 @@ namespace DisplaceMeshToolLocals{
 			});
 		}
 
+		/// Adjust UV value and tile it. 
+		/// Note that we're effectively stretching the texture to be square before tiling, since this
+		/// seems to be what non square textures do by default in UE. If we decide to tile without 
+		/// stretching by default someday, we'd do UV - FVector2f(FMath::Floor(UV.X), FMath:Floor(UV.Y/VHeight)*VHeight)
+		/// without multiplying by VHeight afterward.
+		FVector2f TileDisplacementUV(FVector2f UV, const FVector2f& UVScale, const FVector2f& UVOffset, float VHeight)
+		{
+			UV = UV * UVScale + UVOffset;
+			UV = UV - FVector2f(FMath::Floor(UV.X), FMath::Floor(UV.Y));
+			UV.Y *= VHeight;
+			return UV;
+		}
+
+		/// Error used to drive adaptive tessellation: the largest deviation of the displacement and cull fields from
+		/// their linear interpolation along the edge, and along the medians from its midpoint to the opposite corners,
+		/// which are the edges splitting it would insert. Measured in texture value units on both sides of UV seams.
+		/// Deviations are only searched at texel resolution, so edges shorter than a texel have no error.
+		/// The min/max quadtree answers most edges without sampling: the value range around the edge bounds the
+		/// deviation, so regions flatter than Tolerance are not sampled, and fully culled regions never need refining.
+		double EdgeDisplacementError(const FDynamicMesh3& Mesh,
+			int32 EdgeID,
+			const FDpScalarFieldPyramid& DisplaceField,
+			const FDpScalarFieldPyramid& CullField,
+			double Tolerance,
+			FVector2f UVScale,
+			FVector2f UVOffset)
+		{
+			constexpr int32 MaxSamplesPerSegment = 8;
+
+			const FDynamicMeshUVOverlay* UVOverlay = Mesh.HasAttributes() ? Mesh.Attributes()->GetUVLayer(0) : nullptr;
+			if (UVOverlay == nullptr)
+			{
+				return 0.0;
+			}
+			const float VHeight = DisplaceField.Height() * DisplaceField.CellDimensions.Y;
+			const FVector2f TexelsPerUV = UVScale * FVector2f((float)DisplaceField.Width(), (float)DisplaceField.Height());
+
+			auto SegmentError = [&](const FVector2f& UV0, const FVector2f& UV1, bool bSampleCull)
+			{
+				const float TexelLength = ((UV1 - UV0) * TexelsPerUV).Size();
+				if (TexelLength < 1.0f)
+				{
+					return 0.0;
+				}
+				const int32 NumSamples = FMath::Clamp(FMath::CeilToInt32(TexelLength), 2, MaxSamplesPerSegment);
+				// long segments are sampled sparsely, read the prefiltered mip matching the sample spacing
+				const int32 Level = DisplaceField.LevelForFootprint(TexelLength / (float)NumSamples);
+
+				const FVector2f TiledUV0 = TileDisplacementUV(UV0, UVScale, UVOffset, VHeight);
+				const FVector2f TiledUV1 = TileDisplacementUV(UV1, UVScale, UVOffset, VHeight);
+				const double Displace0 = DisplaceField.BilinearSampleClamped(TiledUV0, Level);
+				const double Displace1 = DisplaceField.BilinearSampleClamped(TiledUV1, Level);
+				const double Cull0 = bSampleCull ? CullField.BilinearSampleClamped(TiledUV0, Level) : 0.0;
+				const double Cull1 = bSampleCull ? CullField.BilinearSampleClamped(TiledUV1, Level) : 0.0;
+
+				double MaxError = 0.0;
+				for (int32 Sample = 1; Sample < NumSamples; ++Sample)
+				{
+					const float T = (float)Sample / (float)NumSamples;
+					const FVector2f UV = TileDisplacementUV(FMath::Lerp(UV0, UV1, T), UVScale, UVOffset, VHeight);
+					MaxError = FMath::Max(MaxError, FMath::Abs(DisplaceField.BilinearSampleClamped(UV, Level) - FMath::Lerp(Displace0, Displace1, (double)T)));
+					if (bSampleCull)
+					{
+						MaxError = FMath::Max(MaxError, FMath::Abs(CullField.BilinearSampleClamped(UV, Level) - FMath::Lerp(Cull0, Cull1, (double)T)));
+					}
+				}
+				return MaxError;
+			};
+
+			const FIndex2i EdgeV = Mesh.GetEdgeV(EdgeID);
+			const FIndex2i EdgeT = Mesh.GetEdgeT(EdgeID);
+			double Error = 0.0;
+			for (int32 TIdx = 0; TIdx < 2; ++TIdx)
+			{
+				const int32 tid = EdgeT[TIdx];
+				if (tid == IndexConstants::InvalidID || UVOverlay->IsSetTriangle(tid) == false)
+				{
+					continue;
+				}
+				const FIndex3i Tri = Mesh.GetTriangle(tid);
+				const FIndex3i UVTri = UVOverlay->GetTriangle(tid);
+				FVector2f UVA, UVB, UVC;
+				for (int j = 0; j < 3; ++j)
+				{
+					const FVector2f UV = UVOverlay->GetElement(UVTri[j]);
+					if (Tri[j] == EdgeV.A)
+					{
+						UVA = UV;
+					}
+					else if (Tri[j] == EdgeV.B)
+					{
+						UVB = UV;
+					}
+					else
+					{
+						UVC = UV;
+					}
+				}
+
+				// The range query needs one untiled box, triangles wrapping around a tile are just sampled
+				const FVector2f TiledA = UVA * UVScale + UVOffset;
+				const FVector2f TiledB = UVB * UVScale + UVOffset;
+				const FVector2f TiledC = UVC * UVScale + UVOffset;
+				const FVector2f BoxMin = FVector2f::Min(TiledA, FVector2f::Min(TiledB, TiledC));
+				const FVector2f BoxMax = FVector2f::Max(TiledA, FVector2f::Max(TiledB, TiledC));
+				const FVector2f Tile(FMath::Floor(BoxMin.X), FMath::Floor(BoxMin.Y));
+				bool bSampleCull = true;
+				if (BoxMax.X - Tile.X <= 1.0f && BoxMax.Y - Tile.Y <= 1.0f)
+				{
+					const FVector2f FieldMin((BoxMin.X - Tile.X), (BoxMin.Y - Tile.Y) * VHeight);
+					const FVector2f FieldMax((BoxMax.X - Tile.X), (BoxMax.Y - Tile.Y) * VHeight);
+					float CullMin, CullMax;
+					CullField.RangeClamped(FieldMin, FieldMax, CullMin, CullMax);
+					if (CullMax < 1.0f)
+					{
+						// the whole triangle is going to be culled
+						continue;
+					}
+					// the cull decision only changes where the mask crosses 1
+					bSampleCull = CullMin < 1.0f;
+
+					float DisplaceMin, DisplaceMax;
+					DisplaceField.RangeClamped(FieldMin, FieldMax, DisplaceMin, DisplaceMax);
+					if (bSampleCull == false && DisplaceMax - DisplaceMin <= Tolerance)
+					{
+						Error = FMath::Max(Error, (double)(DisplaceMax - DisplaceMin));
+						continue;
+					}
+				}
+
+				Error = FMath::Max(Error, SegmentError(UVA, UVB, bSampleCull));
+				Error = FMath::Max(Error, SegmentError((UVA + UVB) * 0.5f, UVC, bSampleCull));
+			}
+			return Error;
+		}
+
+		/// FieldType is FSampledScalarField2f or FDpScalarFieldPyramid.
+		template<typename FieldType>
 		void Map(const FDynamicMesh3& Mesh,
 			const TArray<FVector3d>& Positions, 
 			const FMeshNormals& Normals,
 			TFunctionRef<float(int32, const FVector3d&, const FVector3d&)> IntensityFunc,
-			const FSampledScalarField2f& DisplaceField,
-			const FSampledScalarField2f& CullField,
+			const FieldType& DisplaceField,
+			const FieldType& CullField,
 			TArray<FVector3d>& DisplacedPositions,
 			TArray<int>& TriCullIDs,
-			float DisplaceFieldBaseValue = 128.0/255, // value that corresponds to zero displacement
-			FVector2f UVScale = FVector2f(1, 1),
-			FVector2f UVOffset = FVector2f(0,0),
-			FRichCurve* AdjustmentCurve = nullptr)
+			float DisplaceFieldBaseValue, // value that corresponds to zero displacement
+			FVector2f UVScale,
+			FVector2f UVOffset,
+			FRichCurve* AdjustmentCurve)
 		{
 			const FDynamicMeshUVOverlay* UVOverlay = Mesh.Attributes()->GetUVLayer(0);
 
@@ -259,14 +409,7 @@ namespace DisplaceMeshToolLocals{
 					int vid = Tri[j];
 					FVector2f UV = UVOverlay->GetElement(UVTri[j]);
 
-					// Adjust UV value and tile it. 
-					// Note that we're effectively stretching the texture to be square before tiling, since this
-					// seems to be what non square textures do by default in UE. If we decide to tile without 
-					// stretching by default someday, we'd do UV - FVector2f(FMath::Floor(UV.X), FMath:Floor(UV.Y/VHeight)*VHeight)
-					// without multiplying by VHeight afterward.
-					UV = UV * UVScale + UVOffset;
-					UV = UV - FVector2f(FMath::Floor(UV.X), FMath::Floor(UV.Y));
-					UV.Y *= VHeight;
+					UV = TileDisplacementUV(UV, UVScale, UVOffset, VHeight);
 
 					double Offset = DisplaceField.BilinearSampleClamped(UV);
 					float  Mask = CullField.BilinearSampleClamped(UV);
@@ -290,7 +433,566 @@ namespace DisplaceMeshToolLocals{
 				}
 			}
 		}
+
+		/// Parallel variant of Map(). Produces the same displaced positions and TriCullIDs, but
+		///  - every vertex is sampled and displaced exactly once instead of once per incident triangle,
+		///  - vertices are processed bucketed by UV tile so that neighbouring samples hit the same texels,
+		///  - the cull mask is sampled once per UV element and gathered into per-block lists without locking.
+		/// A vertex takes its UV from the highest incident triangle ID, which is the corner Map() writes last.
+		/// Since each vertex is visited once, SetPosition may write straight back into Mesh.
+		/// FieldType is FSampledScalarField2f or FDpScalarFieldPyramid, which samples its level 0 the same way.
+		/// If OutVertexElements is set, it receives the UV element each vertex was sampled at, InvalidID if none.
+		/// If Progress is cancelled, the remaining tiles are skipped and the positions and TriCullIDs are incomplete.
+		template<typename FieldType, typename GetPositionFunc, typename SetPositionFunc>
+		void TileParallelMap(const FDynamicMesh3& Mesh,
+			const FMeshNormals& Normals,
+			TFunctionRef<float(int32, const FVector3d&, const FVector3d&)> IntensityFunc,
+			const FieldType& DisplaceField,
+			const FieldType& CullField,
+			GetPositionFunc GetPosition,
+			SetPositionFunc SetPosition,
+			TArray<int>& TriCullIDs,
+			float DisplaceFieldBaseValue,
+			FVector2f UVScale,
+			FVector2f UVOffset,
+			FRichCurve* AdjustmentCurve,
+			TArray<int32>* OutVertexElements = nullptr,
+			FProgressCancel* Progress = nullptr)
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(ComputeDisplacement_ParallelMap);
+
+			constexpr int32 TileSizeInTexels = 64;
+			constexpr int32 BlockSize = 16384;
+
+			const FDynamicMeshUVOverlay* UVOverlay = Mesh.Attributes()->GetUVLayer(0);
+			const float VHeight = DisplaceField.Height() * DisplaceField.CellDimensions.Y;
+
+			// Transform each UV element once, and sample the cull mask there. The cull decision is made per triangle 
+			// corner in Map(), and corners are UV elements, so this is exact.
+			const int32 MaxElementID = UVOverlay->MaxElementID();
+			TArray<FVector2f> ElementUVs;
+			ElementUVs.SetNumUninitialized(MaxElementID);
+			TArray<uint8> ElementCulled;
+			ElementCulled.SetNumZeroed(MaxElementID);
+			ParallelFor(MaxElementID, [&](int32 eid)
+			{
+				if (UVOverlay->IsElement(eid))
+				{
+					const FVector2f UV = TileDisplacementUV(UVOverlay->GetElement(eid), UVScale, UVOffset, VHeight);
+					ElementUVs[eid] = UV;
+					ElementCulled[eid] = CullField.BilinearSampleClamped(UV) < 1.0f ? 1 : 0;
+				}
+			});
+
+			// Pick one UV element per vertex
+			const int32 MaxVertexID = Mesh.MaxVertexID();
+			TArray<int32> VertexElements;
+			VertexElements.Init(IndexConstants::InvalidID, MaxVertexID);
+			ParallelFor(MaxVertexID, [&](int32 vid)
+			{
+				if (!Mesh.IsVertex(vid))
+				{
+					return;
+				}
+				int32 LastTriangleID = IndexConstants::InvalidID;
+				Mesh.EnumerateVertexTriangles(vid, [&](int32 tid)
+				{
+					if (tid > LastTriangleID && UVOverlay->IsSetTriangle(tid))
+					{
+						LastTriangleID = tid;
+					}
+				});
+				if (LastTriangleID != IndexConstants::InvalidID)
+				{
+					VertexElements[vid] = UVOverlay->GetElementIDAtVertex(LastTriangleID, vid);
+				}
+				else
+				{
+					SetPosition(vid, GetPosition(vid));
+				}
+			});
+
+			// Bucket vertices by UV tile with a counting sort. Each block builds its own histogram, so there is
+			// no contention, and a prefix sum over (tile, block) gives every block its own output range.
+			const int32 TilesX = FMath::Max(1, FMath::DivideAndRoundUp((int32)DisplaceField.Width(), TileSizeInTexels));
+			const int32 TilesY = FMath::Max(1, FMath::DivideAndRoundUp((int32)DisplaceField.Height(), TileSizeInTexels));
+			const int32 NumTiles = TilesX * TilesY;
+			const FVector2f TexelsPerUV(1.0f / DisplaceField.CellDimensions.X, 1.0f / DisplaceField.CellDimensions.Y);
+			auto TileOf = [&](const FVector2f& UV)
+			{
+				const int32 TileX = FMath::Clamp((int32)(UV.X * TexelsPerUV.X) / TileSizeInTexels, 0, TilesX - 1);
+				const int32 TileY = FMath::Clamp((int32)(UV.Y * TexelsPerUV.Y) / TileSizeInTexels, 0, TilesY - 1);
+				return TileY * TilesX + TileX;
+			};
+
+			const int32 NumVertexBlocks = FMath::DivideAndRoundUp(MaxVertexID, BlockSize);
+			TArray<int32> BlockTileCounts;
+			BlockTileCounts.SetNumZeroed(NumVertexBlocks * NumTiles);
+			ParallelFor(NumVertexBlocks, [&](int32 Block)
+			{
+				int32* Counts = &BlockTileCounts[Block * NumTiles];
+				const int32 End = FMath::Min(MaxVertexID, (Block + 1) * BlockSize);
+				for (int32 vid = Block * BlockSize; vid < End; ++vid)
+				{
+					if (VertexElements[vid] != IndexConstants::InvalidID)
+					{
+						Counts[TileOf(ElementUVs[VertexElements[vid]])]++;
+					}
+				}
+			});
+
+			TArray<int32> TileStart;
+			TileStart.SetNumUninitialized(NumTiles + 1);
+			TArray<int32> BlockTileOffsets;
+			BlockTileOffsets.SetNumUninitialized(NumVertexBlocks * NumTiles);
+			int32 Total = 0;
+			for (int32 Tile = 0; Tile < NumTiles; ++Tile)
+			{
+				TileStart[Tile] = Total;
+				for (int32 Block = 0; Block < NumVertexBlocks; ++Block)
+				{
+					BlockTileOffsets[Block * NumTiles + Tile] = Total;
+					Total += BlockTileCounts[Block * NumTiles + Tile];
+				}
+			}
+			TileStart[NumTiles] = Total;
+
+			TArray<int32> SortedVertices;
+			SortedVertices.SetNumUninitialized(Total);
+			ParallelFor(NumVertexBlocks, [&](int32 Block)
+			{
+				int32* Offsets = &BlockTileOffsets[Block * NumTiles];
+				const int32 End = FMath::Min(MaxVertexID, (Block + 1) * BlockSize);
+				for (int32 vid = Block * BlockSize; vid < End; ++vid)
+				{
+					if (VertexElements[vid] != IndexConstants::InvalidID)
+					{
+						SortedVertices[Offsets[TileOf(ElementUVs[VertexElements[vid]])]++] = vid;
+					}
+				}
+			});
+
+			// Displace tile by tile
+			ParallelFor(NumTiles, [&](int32 Tile)
+			{
+				if (Progress && Progress->Cancelled())
+				{
+					return;
+				}
+				for (int32 Idx = TileStart[Tile]; Idx < TileStart[Tile + 1]; ++Idx)
+				{
+					const int32 vid = SortedVertices[Idx];
+					double Offset = DisplaceField.BilinearSampleClamped(ElementUVs[VertexElements[vid]]);
+					if (AdjustmentCurve)
+					{
+						Offset = AdjustmentCurve->Eval(Offset);
+					}
+					Offset -= DisplaceFieldBaseValue;
+
+					const FVector3d Position = GetPosition(vid);
+					double Intensity = IntensityFunc(vid, Position, Normals[vid]);
+					SetPosition(vid, Position + (Offset * Intensity * Normals[vid]));
+				}
+			});
+
+			if (Progress && Progress->Cancelled())
+			{
+				return;
+			}
+
+			// Build the cull list in per-block arrays, then append them in block order so TriCullIDs stays sorted
+			const int32 MaxTriangleID = Mesh.MaxTriangleID();
+			const int32 NumTriangleBlocks = FMath::DivideAndRoundUp(MaxTriangleID, BlockSize);
+			TArray<TArray<int>> BlockCullIDs;
+			BlockCullIDs.SetNum(NumTriangleBlocks);
+			ParallelFor(NumTriangleBlocks, [&](int32 Block)
+			{
+				const int32 End = FMath::Min(MaxTriangleID, (Block + 1) * BlockSize);
+				for (int32 tid = Block * BlockSize; tid < End; ++tid)
+				{
+					if (!Mesh.IsTriangle(tid) || !UVOverlay->IsSetTriangle(tid))
+					{
+						continue;
+					}
+					const FIndex3i UVTri = UVOverlay->GetTriangle(tid);
+					const float CullWeight = (float)(ElementCulled[UVTri.A] + ElementCulled[UVTri.B] + ElementCulled[UVTri.C]);
+					if (CullWeight/3.0f > 0.33333f)
+					{
+						BlockCullIDs[Block].Add(tid);
+					}
+				}
+			});
+
+			int32 NumCulled = TriCullIDs.Num();
+			for (const TArray<int>& CullIDs : BlockCullIDs)
+			{
+				NumCulled += CullIDs.Num();
+			}
+			TriCullIDs.Reserve(NumCulled);
+			for (const TArray<int>& CullIDs : BlockCullIDs)
+			{
+				TriCullIDs.Append(CullIDs);
+			}
+
+			if (OutVertexElements)
+			{
+				*OutVertexElements = MoveTemp(VertexElements);
+			}
+		}
+
+		template<typename FieldType>
+		void ParallelMap(const FDynamicMesh3& Mesh,
+			const TArray<FVector3d>& Positions, 
+			const FMeshNormals& Normals,
+			TFunctionRef<float(int32, const FVector3d&, const FVector3d&)> IntensityFunc,
+			const FieldType& DisplaceField,
+			const FieldType& CullField,
+			TArray<FVector3d>& DisplacedPositions,
+			TArray<int>& TriCullIDs,
+			float DisplaceFieldBaseValue, // value that corresponds to zero displacement
+			FVector2f UVScale,
+			FVector2f UVOffset,
+			FRichCurve* AdjustmentCurve)
+		{
+			TileParallelMap(Mesh, Normals, IntensityFunc, DisplaceField, CullField,
+				[&](int32 vid) { return Positions[vid]; },
+				[&](int32 vid, const FVector3d& Position) { DisplacedPositions[vid] = Position; },
+				TriCullIDs, DisplaceFieldBaseValue, UVScale, UVOffset, AdjustmentCurve);
+		}
+
+		/// Same as ParallelMap(), but reads and writes the vertex positions of Mesh directly so that no
+		/// position buffers need to be allocated.
+		template<typename FieldType>
+		void ParallelMapInPlace(FDynamicMesh3& Mesh,
+			const FMeshNormals& Normals,
+			TFunctionRef<float(int32, const FVector3d&, const FVector3d&)> IntensityFunc,
+			const FieldType& DisplaceField,
+			const FieldType& CullField,
+			TArray<int>& TriCullIDs,
+			float DisplaceFieldBaseValue, // value that corresponds to zero displacement
+			FVector2f UVScale,
+			FVector2f UVOffset,
+			FRichCurve* AdjustmentCurve,
+			TArray<int32>* OutVertexElements,
+			FProgressCancel* Progress)
+		{
+			TileParallelMap(Mesh, Normals, IntensityFunc, DisplaceField, CullField,
+				[&Mesh](int32 vid) { return Mesh.GetVertex(vid); },
+				[&Mesh](int32 vid, const FVector3d& Position) { Mesh.SetVertex(vid, Position); },
+				TriCullIDs, DisplaceFieldBaseValue, UVScale, UVOffset, AdjustmentCurve, OutVertexElements, Progress);
+		}
+
+		// Used by DpBenchmarks.cpp, see DpDisplacementLocals.h
+		template void Map<FSampledScalarField2f>(const FDynamicMesh3&, const TArray<FVector3d>&, const FMeshNormals&,
+			TFunctionRef<float(int32, const FVector3d&, const FVector3d&)>, const FSampledScalarField2f&, const FSampledScalarField2f&,
+			TArray<FVector3d>&, TArray<int>&, float, FVector2f, FVector2f, FRichCurve*);
+		template void ParallelMap<FSampledScalarField2f>(const FDynamicMesh3&, const TArray<FVector3d>&, const FMeshNormals&,
+			TFunctionRef<float(int32, const FVector3d&, const FVector3d&)>, const FSampledScalarField2f&, const FSampledScalarField2f&,
+			TArray<FVector3d>&, TArray<int>&, float, FVector2f, FVector2f, FRichCurve*);
+		template void ParallelMapInPlace<FDpScalarFieldPyramid>(FDynamicMesh3&, const FMeshNormals&,
+			TFunctionRef<float(int32, const FVector3d&, const FVector3d&)>, const FDpScalarFieldPyramid&, const FDpScalarFieldPyramid&,
+			TArray<int>&, float, FVector2f, FVector2f, FRichCurve*, TArray<int32>*, FProgressCancel*);
 		
+		/// Compact remap of the IDs [0, Num) for which Keep is true: OutRemap receives the new ID of every kept ID, in
+		/// order, and InvalidID for the others. Parallel prefix sum, blocks are counted and filled concurrently.
+		/// @return the number of kept IDs
+		int32 ParallelCompactRemap(const int32 Num, TFunctionRef<bool(int32)> Keep, TArray<int32>& OutRemap)
+		{
+			constexpr int32 BlockSize = 16384;
+			const int32 NumBlocks = FMath::DivideAndRoundUp(Num, BlockSize);
+			OutRemap.SetNumUninitialized(Num);
+			TArray<int32> BlockStart;
+			BlockStart.SetNumZeroed(NumBlocks + 1);
+			ParallelFor(NumBlocks, [&](int32 Block)
+			{
+				int32 NumKept = 0;
+				for (int32 Index = Block * BlockSize, End = FMath::Min(Num, Index + BlockSize); Index < End; ++Index)
+				{
+					const bool bKeep = Keep(Index);
+					OutRemap[Index] = bKeep ? 1 : 0;
+					NumKept += bKeep ? 1 : 0;
+				}
+				BlockStart[Block + 1] = NumKept;
+			});
+			for (int32 Block = 0; Block < NumBlocks; ++Block)
+			{
+				BlockStart[Block + 1] += BlockStart[Block];
+			}
+			ParallelFor(NumBlocks, [&](int32 Block)
+			{
+				int32 NewID = BlockStart[Block];
+				for (int32 Index = Block * BlockSize, End = FMath::Min(Num, Index + BlockSize); Index < End; ++Index)
+				{
+					OutRemap[Index] = OutRemap[Index] ? NewID++ : IndexConstants::InvalidID;
+				}
+			});
+			return BlockStart[NumBlocks];
+		}
+
+		/// Inverse of a ParallelCompactRemap() remap: the old ID of every new ID
+		TArray<int32> InvertCompactRemap(const TArray<int32>& Remap, const int32 NumKept)
+		{
+			TArray<int32> OldIDs;
+			OldIDs.SetNumUninitialized(NumKept);
+			ParallelFor(Remap.Num(), [&](int32 Index)
+			{
+				if (Remap[Index] != IndexConstants::InvalidID)
+				{
+					OldIDs[Remap[Index]] = Index;
+				}
+			});
+			return OldIDs;
+		}
+
+		/// Copy the elements of From referenced by the kept triangles into To, in element ID order, and set the 
+		/// remapped element triangles. KeptTriangles maps the triangle IDs of the compact mesh to those of the source.
+		template<typename OverlayType>
+		void CompactCopyOverlay(const OverlayType& From, const TArray<int32>& KeptTriangles, OverlayType& To)
+		{
+			TArray<uint8> ElementUsed;
+			ElementUsed.SetNumZeroed(From.MaxElementID());
+			ParallelFor(KeptTriangles.Num(), [&](int32 NewTriangleID)
+			{
+				const int32 tid = KeptTriangles[NewTriangleID];
+				if (From.IsSetTriangle(tid))
+				{
+					// several triangles may flag the same element, they all write the same value
+					const FIndex3i ElementTri = From.GetTriangle(tid);
+					ElementUsed[ElementTri.A] = 1;
+					ElementUsed[ElementTri.B] = 1;
+					ElementUsed[ElementTri.C] = 1;
+				}
+			});
+			TArray<int32> ElementRemap;
+			const int32 NumKeptElements = ParallelCompactRemap(From.MaxElementID(), [&](int32 eid) { return ElementUsed[eid] != 0 && From.IsElement(eid); }, ElementRemap);
+			ElementUsed.Empty();
+
+			// overlays reference count their elements and have no bulk interface, so elements and triangles are set
+			// on one thread, in the order of the remap
+			for (const int32 eid : InvertCompactRemap(ElementRemap, NumKeptElements))
+			{
+				To.AppendElement(From.GetElement(eid));
+			}
+			for (int32 NewTriangleID = 0; NewTriangleID < KeptTriangles.Num(); ++NewTriangleID)
+			{
+				const int32 tid = KeptTriangles[NewTriangleID];
+				if (From.IsSetTriangle(tid))
+				{
+					const FIndex3i ElementTri = From.GetTriangle(tid);
+					To.SetTriangle(NewTriangleID, FIndex3i(ElementRemap[ElementTri.A], ElementRemap[ElementTri.B], ElementRemap[ElementTri.C]));
+				}
+			}
+		}
+
+		/// Remove the triangles in TriCullIDs and the vertices only they used, leaving Mesh compact.
+		/// Instead of removing triangles one by one, which updates the edge and vertex topology for every removal
+		/// and leaves holes in the ID spaces, the keep masks and ID remaps are computed with parallel prefix sums and
+		/// the surviving triangles are built into a new compact mesh with FDpBulkMeshBuilder, so the cost scales with
+		/// what is kept and little of it is serial.
+		/// Vertex normals/colors/UVs, triangle groups, UV/normal/color overlays, material IDs, polygroup and weight
+		/// layers are carried over, other generic attributes are not.
+		/// Vertex IDs change: the kept vertices are renumbered, and every vertex no kept triangle uses is removed,
+		/// including vertices that were isolated before the cull. Callers keeping per-vertex data or external vertex
+		/// ID maps must follow OutVertexRemap, which receives the new ID of every old vertex ID, InvalidID for removed
+		/// vertices. Without culled triangles the mesh, isolated vertices included, is left as it is.
+		/// @return false if the kept triangles could not be rebuilt (e.g. a corrupt, non-manifold input), Mesh is
+		/// left unchanged then
+		bool CullAndCompact(FDynamicMesh3& Mesh, const TArray<int>& TriCullIDs, TArray<int32>* OutVertexRemap = nullptr)
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(ComputeDisplacement_CullAndCompact);
+
+			if (TriCullIDs.Num() == 0)
+			{
+				if (OutVertexRemap)
+				{
+					OutVertexRemap->SetNumUninitialized(Mesh.MaxVertexID());
+					ParallelFor(Mesh.MaxVertexID(), [&](int32 vid)
+					{
+						(*OutVertexRemap)[vid] = Mesh.IsVertex(vid) ? vid : IndexConstants::InvalidID;
+					});
+				}
+				return true;
+			}
+
+			const int32 MaxTriangleID = Mesh.MaxTriangleID();
+			const int32 MaxVertexID = Mesh.MaxVertexID();
+
+			// Triangle keep mask
+			TArray<uint8> KeepTriangle;
+			KeepTriangle.SetNumUninitialized(MaxTriangleID);
+			ParallelFor(MaxTriangleID, [&](int32 tid)
+			{
+				KeepTriangle[tid] = Mesh.IsTriangle(tid) ? 1 : 0;
+			});
+			ParallelFor(TriCullIDs.Num(), [&](int32 Idx)
+			{
+				KeepTriangle[TriCullIDs[Idx]] = 0;
+			});
+
+			// Compact IDs, surviving elements keep their relative order. A vertex survives if any of its triangles does.
+			TArray<int32> VertexRemap;
+			const int32 NumKeptVertices = ParallelCompactRemap(MaxVertexID, [&](int32 vid)
+			{
+				bool bKeep = false;
+				if (Mesh.IsVertex(vid))
+				{
+					Mesh.EnumerateVertexTriangles(vid, [&](int32 tid) { bKeep = bKeep || KeepTriangle[tid] != 0; });
+				}
+				return bKeep;
+			}, VertexRemap);
+			TArray<int32> TriangleRemap;
+			const int32 NumKeptTriangles = ParallelCompactRemap(MaxTriangleID, [&](int32 tid) { return KeepTriangle[tid] != 0; }, TriangleRemap);
+			KeepTriangle.Empty();
+			TriangleRemap = InvertCompactRemap(TriangleRemap, NumKeptTriangles);
+			const TArray<int32>& KeptTriangles = TriangleRemap;
+			const TArray<int32> KeptVertices = InvertCompactRemap(VertexRemap, NumKeptVertices);
+
+			TArray<FIndex3i> CompactTriangles;
+			CompactTriangles.SetNumUninitialized(NumKeptTriangles);
+			ParallelFor(NumKeptTriangles, [&](int32 NewTriangleID)
+			{
+				const FIndex3i Tri = Mesh.GetTriangle(KeptTriangles[NewTriangleID]);
+				CompactTriangles[NewTriangleID] = FIndex3i(VertexRemap[Tri.A], VertexRemap[Tri.B], VertexRemap[Tri.C]);
+			});
+			TFunction<int32(int32)> TriangleGroup;
+			if (Mesh.HasTriangleGroups())
+			{
+				TriangleGroup = [&Mesh, &KeptTriangles](int32 NewTriangleID) { return Mesh.GetTriangleGroup(KeptTriangles[NewTriangleID]); };
+			}
+
+			FDynamicMesh3 Compact;
+			const bool bBuilt = FDpBulkMeshBuilder::Build(Compact, NumKeptVertices, 
+				[&Mesh, &KeptVertices](int32 NewVertexID) { return Mesh.GetVertex(KeptVertices[NewVertexID]); }, 
+				CompactTriangles, TriangleGroup, true);
+			if (bBuilt == false)
+			{
+				// the kept triangles of a valid mesh always rebuild, Mesh was not valid
+				UE_LOG(LogTemp, Warning, TEXT("2K_DpRA CullAndCompact: the %d kept triangles do not form a valid mesh, nothing is culled"), NumKeptTriangles);
+				return false;
+			}
+			CompactTriangles.Empty();
+
+			if (Mesh.HasVertexNormals())
+			{
+				Compact.EnableVertexNormals(FVector3f::UnitZ());
+			}
+			if (Mesh.HasVertexColors())
+			{
+				Compact.EnableVertexColors(FVector3f::Zero());
+			}
+			if (Mesh.HasVertexUVs())
+			{
+				Compact.EnableVertexUVs(FVector2f::Zero());
+			}
+			if (Mesh.HasVertexNormals() || Mesh.HasVertexColors() || Mesh.HasVertexUVs())
+			{
+				ParallelFor(NumKeptVertices, [&](int32 NewVertexID)
+				{
+					const int32 vid = KeptVertices[NewVertexID];
+					if (Mesh.HasVertexNormals())
+					{
+						Compact.SetVertexNormal(NewVertexID, Mesh.GetVertexNormal(vid));
+					}
+					if (Mesh.HasVertexColors())
+					{
+						Compact.SetVertexColor(NewVertexID, Mesh.GetVertexColor(vid));
+					}
+					if (Mesh.HasVertexUVs())
+					{
+						Compact.SetVertexUV(NewVertexID, Mesh.GetVertexUV(vid));
+					}
+				});
+			}
+
+			if (Mesh.HasAttributes())
+			{
+				Compact.EnableAttributes();
+				Compact.Attributes()->EnableMatchingAttributes(*Mesh.Attributes());
+				const FDynamicMeshAttributeSet* From = Mesh.Attributes();
+				FDynamicMeshAttributeSet* To = Compact.Attributes();
+
+				// every overlay is copied by its own task
+				TArray<TFunction<void()>> OverlayCopies;
+				for (int32 Layer = 0; Layer < From->NumUVLayers(); ++Layer)
+				{
+					OverlayCopies.Add([From, To, Layer, &KeptTriangles]() { CompactCopyOverlay(*From->GetUVLayer(Layer), KeptTriangles, *To->GetUVLayer(Layer)); });
+				}
+				for (int32 Layer = 0; Layer < From->NumNormalLayers(); ++Layer)
+				{
+					OverlayCopies.Add([From, To, Layer, &KeptTriangles]() { CompactCopyOverlay(*From->GetNormalLayer(Layer), KeptTriangles, *To->GetNormalLayer(Layer)); });
+				}
+				if (From->HasPrimaryColors())
+				{
+					OverlayCopies.Add([From, To, &KeptTriangles]() { CompactCopyOverlay(*From->PrimaryColors(), KeptTriangles, *To->PrimaryColors()); });
+				}
+				ParallelFor(OverlayCopies.Num(), [&](int32 Index)
+				{
+					OverlayCopies[Index]();
+				});
+
+				ParallelFor(NumKeptTriangles, [&](int32 NewTriangleID)
+				{
+					const int32 tid = KeptTriangles[NewTriangleID];
+					if (From->HasMaterialID())
+					{
+						To->GetMaterialID()->SetValue(NewTriangleID, From->GetMaterialID()->GetValue(tid));
+					}
+					for (int32 Layer = 0; Layer < From->NumPolygroupLayers(); ++Layer)
+					{
+						To->GetPolygroupLayer(Layer)->SetValue(NewTriangleID, From->GetPolygroupLayer(Layer)->GetValue(tid));
+					}
+				});
+
+				if (From->NumWeightLayers() > 0)
+				{
+					ParallelFor(NumKeptVertices, [&](int32 NewVertexID)
+					{
+						const int32 vid = KeptVertices[NewVertexID];
+						for (int32 Layer = 0; Layer < From->NumWeightLayers(); ++Layer)
+						{
+							float Weight;
+							From->GetWeightLayer(Layer)->GetValue(vid, &Weight);
+							To->GetWeightLayer(Layer)->SetValue(NewVertexID, &Weight);
+						}
+					});
+				}
+			}
+
+			Mesh = MoveTemp(Compact);
+			if (OutVertexRemap)
+			{
+				*OutVertexRemap = MoveTemp(VertexRemap);
+			}
+			return true;
+		}
+
+		/// Recompute the primary normal overlay, or the vertex normals if the mesh has no attributes
+		void RecalculateNormals(FDynamicMesh3& Mesh)
+		{
+			FDpParallelNormals::RecomputeNormals(Mesh);
+		}
+
+		/// Area and angle weighted vertex normals of Mesh, computed in parallel
+		FMeshNormals ComputeVertexNormals(const FDynamicMesh3& Mesh)
+		{
+			FMeshNormals Normals(&Mesh);
+			FDpParallelNormals(&Mesh).ComputeVertexNormals(Normals);
+			return Normals;
+		}
+
+		/// Vertex normals to displace a tessellated mesh along. The PN tessellation evaluated the smooth PN normals 
+		/// into the primary normal overlay, they are read back instead of recomputed from the tessellated triangles.
+		FMeshNormals TessellatedVertexNormals(const FDynamicMesh3& Mesh, bool bHasPNNormals)
+		{
+			if (bHasPNNormals && Mesh.HasAttributes() && Mesh.Attributes()->PrimaryNormals() != nullptr)
+			{
+				FMeshNormals Normals(&Mesh);
+				FDpParallelNormals(&Mesh).GatherOverlayVertexNormals(Mesh.Attributes()->PrimaryNormals(), Normals);
+				return Normals;
+			}
+			return ComputeVertexNormals(Mesh);
+		}
+
 		void Sine(const FDynamicMesh3& Mesh,
 			const TArray<FVector3d>& Positions,
 			const FMeshNormals& Normals,
@@ -316,18 +1018,6 @@ namespace DisplaceMeshToolLocals{
 
 	}
 
-	enum class EDisplaceMeshToolSubdivisionType : uint8  
-	{
-		/** Subdivide the mesh using loop-style subdivision. */
-		Flat,
-	
-		/** Subdivide the mesh using PN triangles which replace each original flat triangle by a curved shape that is 
-			retriangulated into a number of small subtriangles. The geometry of a PN triangle is defined as one cubic Bezier 
-			patch using control points. The patch matches the point and normal information at the vertices of the original 
-			flat triangle.*/
-		PNTriangles,
-	};
-	
 	class FSubdivideMeshOp : public FDynamicMeshOperator
 	{
 	public:
@@ -467,8 +1157,10 @@ namespace DisplaceMeshToolLocals{
 		bool bEnableFilter = false;
 		FVector FilterDirection = { 0.0f, 0.0f, 0.0f };
 		float FilterWidth = 0.0f;
-		FSampledScalarField2f DisplaceField;
-		FSampledScalarField2f CullField;
+		// The displacement channel and the cull mask (blue channel) of DisplacementMap, 8 or 16 bits per value with 
+		// mips and min/max, see ReadDisplacementMap()
+		FDpScalarFieldPyramid DisplacePyramid;
+		FDpScalarFieldPyramid CullPyramid;
 		TArray<FPerlinLayerProperties> PerlinLayerProperties;
 		bool bRecalculateNormals = true;
 
@@ -483,96 +1175,210 @@ namespace DisplaceMeshToolLocals{
 
 		TSharedPtr<FIndexedWeightMap, ESPMode::ThreadSafe> WeightMap;
 		TFunction<float(const FVector3d&, const FIndexedWeightMap)> WeightMapQueryFunc;
-	};
 
-	class FDisplaceMeshThread : public FRunnable
-	{
-	public:
-		FDisplaceMeshThread(TSharedPtr<FDpMeshOptional> MeshOpIn,FDynamicMesh3* SourceMeshIn,
-						TSharedPtr<DisplaceMeshParameters> DisplaceParametersIn,
-						EDisplaceMeshToolDisplaceType DisplacementTypeIn,
-						EDisplaceMeshToolSubdivisionType SubdivisionTypeIn,
-						int SubdivisionsCountIn,
-						TSharedPtr<FIndexedWeightMap, ESPMode::ThreadSafe> WeightMapIn);
-		virtual  ~FDisplaceMeshThread()
+		// Used in adaptive tessellation, which replaces the uniform subdivision count
+		bool bAdaptiveTessellation = false;
+		// Deviation of the displacement map from the tessellation, in texture value units, that is not refined further
+		float AdaptiveTolerance = 1.0f/255;
+		int32 TriangleBudget = 3000000;
+		// Lower the subdivision count to fit TriangleBudget instead of converting in clusters, see FDpMeshOptional::bClampToBudget
+		bool bClampToBudget = false;
+		// Save/load the tessellated mesh, see FDpMeshOptional::bUseTessellationCheckpoint
+		bool bUseTessellationCheckpoint = false;
+		// Keep an FDisplacementCache of the texture map displacement, see FDpMeshOptional::bKeepPreview
+		bool bKeepDisplacementCache = false;
+
+		/**
+		 * Build DisplacePyramid and CullPyramid from DisplacementMap. The two channels are decoded row by row from the
+		 * texture data into the pyramids, the texture is never expanded to a float image.
+		 * @return false if there is no map or it cannot be read, the pyramids are empty then
+		 */
+		bool ReadDisplacementMap()
 		{
-			UE_LOG(LogTemp,Warning,TEXT("~FDisplaceMeshThread"));
-		}
-		void CalculateResult(FProgressCancel* Progress);
+			DisplacePyramid.Reset();
+			CullPyramid.Reset();
+			if (DisplacementMap == nullptr ||
+				DisplacementMap->GetPlatformData() == nullptr ||
+				DisplacementMap->GetPlatformData()->Mips.Num() < 1)
+			{
+				return false;
+			}
 
-		TUniquePtr<FDynamicMesh3> CalculateSubdivisionResult(FProgressCancel* Progress);
+			const double ReadStartTime = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
+			UE::AssetUtils::FTextureChannelReader Reader;
+			// need bPreferPlatformData to be true to respond to non-destructive changes to the texture in the editor
+			if (Reader.Initialize(DisplacementMap, true) == false)
+			{
+				return false;
+			}
 
-		virtual bool Init() override
-		{
+			// Unorm8 stores 8 bit unorm values exactly, so use it when the data the reader decodes (the platform mip
+			// with bPreferPlatformData, not necessarily the source) has them. Anything else keeps 16 bits.
+			const FDpScalarFieldPyramid::EPrecision Precision = Reader.HasUnorm8Values() 
+				? FDpScalarFieldPyramid::EPrecision::Unorm8 : FDpScalarFieldPyramid::EPrecision::Unorm16;
+			const FImageDimensions Dimensions = Reader.GetDimensions();
+			DisplacePyramid.Build(Dimensions, [&Reader, this](int32 FirstY, int32 NumRows, float* OutValues) { Reader.ReadRows(DisplacementMapChannel, FirstY, NumRows, OutValues); }, Precision);
+			CullPyramid.Build(Dimensions, [&Reader](int32 FirstY, int32 NumRows, float* OutValues) { Reader.ReadRows(2, FirstY, NumRows, OutValues); }, Precision);
+
+			// what the float RGBA image and the two float grids used to take
+			const int64 FloatPathBytes = Dimensions.Num() * (int64)(sizeof(FVector4f) + 2 * sizeof(float));
+			const int64 PyramidBytes = DisplacePyramid.GetAllocatedSize() + CullPyramid.GetAllocatedSize();
+			UE_LOG(LogTemp,Warning,TEXT("2K_DpRA Read displacement map %dx%d (%s) in %f ms: texture data %lld KB, pyramids %lld KB, float image and grids would take %lld KB"),
+				Dimensions.GetWidth(), Dimensions.GetHeight(), GetPixelFormatString(DisplacementMap->GetPlatformData()->PixelFormat),
+				FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64()) - ReadStartTime, (int64)Reader.GetAllocatedSize() / 1024, PyramidBytes / 1024, FloatPathBytes / 1024);
 			return true;
 		}
-		virtual uint32 Run() override
-		{
-			double StartTime = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
-			CalculateResult(nullptr);
-			double EndTime = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
-			UE_LOG(LogTemp,Warning,TEXT("2K_DpRA Subdivision And Dispalcement consuming：%f"),EndTime-StartTime);
-			
-			return 0;
-		}
-		virtual void Exit() override
+	};
+
+	void FDisplacementCache::Capture(const FDynamicMesh3& Mesh, const FMeshNormals& MeshNormals, TFunctionRef<float(int32, const FVector3d&, const FVector3d&)> WeightFunc)
+	{
+		const int32 MaxVertexID = Mesh.MaxVertexID();
+		BasePositions.SetNumUninitialized(MaxVertexID);
+		Normals.SetNumUninitialized(MaxVertexID);
+		Weights.SetNumZeroed(MaxVertexID);
+		ParallelFor(MaxVertexID, [&](int32 vid)
 		{
-			AsyncTask(ENamedThreads::GameThread,[this]()
+			if (Mesh.IsVertex(vid))
 			{
-				MeshOp->SaveMeshToStaticMesh();
-			});
-			
-			UE_LOG(LogTemp,Warning,TEXT("FDisplaceMeshThread::Exit()"));
-		}
+				BasePositions[vid] = Mesh.GetVertex(vid);
+				Normals[vid] = MeshNormals[vid];
+				Weights[vid] = WeightFunc(vid, BasePositions[vid], Normals[vid]);
+			}
+		});
+	}
 
-		void UpdateDisplaceMap()
+	void FDisplacementCache::CaptureUVs(const FDynamicMesh3& Mesh, const TArray<int32>& VertexElements, const FDpScalarFieldPyramid& CullField)
+	{
+		const FDynamicMeshUVOverlay* UVOverlay = Mesh.Attributes()->GetUVLayer(0);
+		UVs.SetNumZeroed(VertexElements.Num());
+		ParallelFor(VertexElements.Num(), [&](int32 vid)
 		{
-			Parameters->DisplacementMapChannel=0;
-			if (Parameters->DisplacementMap == nullptr ||
-				Parameters->DisplacementMap->GetPlatformData() == nullptr ||
-				Parameters->DisplacementMap->GetPlatformData()->Mips.Num() < 1)
+			if (VertexElements[vid] != IndexConstants::InvalidID)
 			{
-				Parameters->DisplaceField = FSampledScalarField2f();
-				Parameters->DisplaceField.GridValues.AssignAll(0);
-
-				Parameters->CullField = FSampledScalarField2f();
-				Parameters->CullField.GridValues.AssignAll(0);
-				return;
+				UVs[vid] = UVOverlay->GetElement(VertexElements[vid]);
+			}
+			else
+			{
+				Weights[vid] = 0.0f;
 			}
+		});
+
+		const FVector2f FieldSize(CullField.Width() * CullField.CellDimensions.X, CullField.Height() * CullField.CellDimensions.Y);
+		float CullMin, CullMax;
+		CullField.RangeClamped(FVector2f::Zero(), FieldSize, CullMin, CullMax);
+		bTopologyFollowsUVs = bTopologyFollowsUVs || CullMin < 1.0f;
+	}
 
-			TImageBuilder<FVector4f> DisplacementMapValues;
-			if (!UE::AssetUtils::ReadTexture(Parameters->DisplacementMap, DisplacementMapValues,
-			                                 // need bPreferPlatformData to be true to respond to non-destructive changes to the texture in the editor
-			                                 true))
+	template<typename ValueType>
+	static void CompactValues(TArray<ValueType>& Values, const TArray<int32>& VertexRemap, int32 NumVertices)
+	{
+		TArray<ValueType> Compacted;
+		Compacted.SetNumUninitialized(NumVertices);
+		ParallelFor(VertexRemap.Num(), [&](int32 vid)
+		{
+			if (VertexRemap[vid] != IndexConstants::InvalidID)
 			{
-				Parameters->DisplaceField = FSampledScalarField2f();
-				Parameters->DisplaceField.GridValues.AssignAll(0);
+				Compacted[VertexRemap[vid]] = Values[vid];
+			}
+		});
+		Values = MoveTemp(Compacted);
+	}
 
-				Parameters->CullField = FSampledScalarField2f();
-				Parameters->CullField.GridValues.AssignAll(0);
+	void FDisplacementCache::Compact(const TArray<int32>& VertexRemap, int32 NumVertices)
+	{
+		CompactValues(BasePositions, VertexRemap, NumVertices);
+		CompactValues(Normals, VertexRemap, NumVertices);
+		CompactValues(UVs, VertexRemap, NumVertices);
+		CompactValues(Weights, VertexRemap, NumVertices);
+	}
+
+	void FDisplacementCache::Displace(FDynamicMesh3& Mesh) const
+	{
+		check(Mesh.MaxVertexID() == BasePositions.Num());
+		const float VHeight = DisplaceField.Height() * DisplaceField.CellDimensions.Y;
+		const FRichCurve* Curve = AdjustmentCurve.Get();
+		ParallelFor(BasePositions.Num(), [&](int32 vid)
+		{
+			if (Mesh.IsVertex(vid) == false)
+			{
+				// without culled triangles the mesh is not compacted and may have free IDs
+				return;
 			}
-			else
+			double Offset = DisplaceField.BilinearSampleClamped(ComputeDisplacement::TileDisplacementUV(UVs[vid], UVScale, UVOffset, VHeight));
+			if (Curve)
 			{
-				const FImageDimensions DisplacementMapDimensions = DisplacementMapValues.GetDimensions();
-				int64 TextureWidth = DisplacementMapDimensions.GetWidth();
-				int64 TextureHeight = DisplacementMapDimensions.GetHeight();
-				Parameters->DisplaceField.Resize(TextureWidth, TextureHeight, 0.0f);
-				Parameters->CullField.Resize(TextureWidth, TextureHeight, 0.0f);
+				Offset = Curve->Eval(Offset);
+			}
+			Offset -= BaseValue;
+			Mesh.SetVertex(vid, BasePositions[vid] + (Offset * Intensity * Weights[vid] * Normals[vid]));
+		});
+	}
 
-				// Note that the height of the texture will not be 1.0 if it was not square. This should be kept in mind when sampling it later.
-				Parameters->DisplaceField.SetCellSize(1.0f / (float)TextureWidth);
-				Parameters->CullField.SetCellSize(1.0f / (float)TextureWidth);
-				for (int64 y = 0; y < TextureHeight; ++y)
-				{
-					for (int64 x = 0; x < TextureWidth; ++x)
-					{
-						Parameters->DisplaceField.GridValues[y * TextureWidth + x] =
-							DisplacementMapValues.GetPixel(y * TextureWidth + x)[Parameters->DisplacementMapChannel];
+	void RedisplacePreview(const FDisplacementCache& Cache, UDynamicMeshComponent& Preview)
+	{
+		Cache.Displace(*Preview.GetMesh());
+		Preview.FastNotifyPositionsUpdated();
+	}
 
-						Parameters->CullField.GridValues[y * TextureWidth + x] =
-							DisplacementMapValues.GetPixel(y * TextureWidth + x)[2];
-					}
-				}
+	class FDisplaceMeshThread
+	{
+	public:
+		FDisplaceMeshThread(TSharedPtr<FDpMeshOptional> MeshOpIn,FDynamicMesh3* SourceMeshIn,
+						TSharedPtr<DisplaceMeshParameters> DisplaceParametersIn,
+						EDisplaceMeshToolDisplaceType DisplacementTypeIn,
+						EDisplaceMeshToolSubdivisionType SubdivisionTypeIn,
+						int SubdivisionsCountIn,
+						TSharedPtr<FIndexedWeightMap, ESPMode::ThreadSafe> WeightMapIn,
+						TSharedPtr<FDpPNControlPointCache, ESPMode::ThreadSafe> PNControlPointCacheIn);
+		virtual  ~FDisplaceMeshThread()
+		{
+			UE_LOG(LogTemp,Warning,TEXT("~FDisplaceMeshThread"));
+		}
+		void CalculateResult(FProgressCancel* Progress);
+
+		/** Tessellate SourceMesh straight into OutMesh. @return false if the tessellation failed or was cancelled */
+		bool CalculateSubdivisionResult(FProgressCancel* Progress, FDynamicMesh3& OutMesh);
+
+		/**
+		 * Tessellate SourceMesh as clusters of at most TriangleBudget triangles, and displace, cull and renormalize each
+		 * one into the optional's ReMeshClusters as soon as it is tessellated.
+		 * @return false if the conversion failed or was cancelled
+		 */
+		bool CalculateChunkedResult(FProgressCancel* Progress);
+
+		/**
+		 * Displace, cull and renormalize the tessellated OutMesh in place.
+		 * @param bChunk OutMesh is one cluster of a chunked result, which keeps no displacement cache
+		 * @param DisplacementCache receives the cache of the displacement if the parameters ask for one
+		 * @return false if it failed or was cancelled
+		 */
+		bool DisplaceAndCull(FProgressCancel* Progress, FDynamicMesh3& OutMesh, bool bChunk, TSharedPtr<FDisplacementCache>& DisplacementCache);
+
+		/** 
+		 * FDpTessellationCache key of the tessellation of SourceMesh with the current settings: a hash of the source 
+		 * mesh content, the subdivision type and level. The displacement is not part of it.
+		 */
+		FString TessellationCacheKey() const;
+
+		void UpdateDisplaceMap()
+		{
+			Parameters->DisplacementMapChannel=0;
+			Parameters->ReadDisplacementMap();
+		}
+
+		/**
+		 * Read the displacement map right away if it can only be read on the game thread (a texture rebuild), so 
+		 * that CalculateResult never waits for the game thread. Call it on the game thread before CalculateResult.
+		 */
+		void ReadDisplaceMapIfGameThreadOnly()
+		{
+			check(IsInGameThread());
+			if (UE::AssetUtils::FTextureChannelReader::CanReadOnAnyThread(Parameters->DisplacementMap, true) == false)
+			{
+				PreReadStartTime = FPlatformTime::Seconds();
+				UpdateDisplaceMap();
+				PreReadEndTime = FPlatformTime::Seconds();
+				bDisplaceMapRead = true;
 			}
 		}
 
@@ -592,8 +1398,12 @@ namespace DisplaceMeshToolLocals{
 		EDisplaceMeshToolSubdivisionType SubdivisionType;
 		int SubdivisionsCount;
 		TSharedPtr<FIndexedWeightMap, ESPMode::ThreadSafe> WeightMap;
+		/** PN control points of SourceMesh, owned by the optional so that they outlive this task */
+		TSharedPtr<FDpPNControlPointCache, ESPMode::ThreadSafe> PNControlPointCache;
 		TUniquePtr<FDynamicMesh3> ResultMesh;
 		bool bDone=false;
+		bool bDisplaceMapRead = false;
+		double PreReadStartTime = 0, PreReadEndTime = 0;
 		TSharedPtr<FDpMeshOptional> MeshOp;
 	};
 
@@ -602,7 +1412,8 @@ namespace DisplaceMeshToolLocals{
 									 EDisplaceMeshToolDisplaceType DisplacementTypeIn,
 									EDisplaceMeshToolSubdivisionType SubdivisionTypeIn,
 									int SubdivisionsCountIn,
-						TSharedPtr<FIndexedWeightMap, ESPMode::ThreadSafe> WeightMapIn)
+						TSharedPtr<FIndexedWeightMap, ESPMode::ThreadSafe> WeightMapIn,
+						TSharedPtr<FDpPNControlPointCache, ESPMode::ThreadSafe> PNControlPointCacheIn)
 		:MeshOp(MeshOpIn)
 		,SourceMesh(SourceMeshIn)
 		,Parameters(DisplaceParametersIn)
@@ -610,6 +1421,7 @@ namespace DisplaceMeshToolLocals{
 		,SubdivisionType(SubdivisionTypeIn)
 		,SubdivisionsCount(SubdivisionsCountIn)
 	    ,WeightMap(WeightMapIn)
+		,PNControlPointCache(PNControlPointCacheIn)
 	{
 		bDone=false;
 		//MeshOp=nullptr;
@@ -617,49 +1429,75 @@ namespace DisplaceMeshToolLocals{
 	}
 	
 
-	TUniquePtr<FDynamicMesh3> FDisplaceMeshThread::CalculateSubdivisionResult(FProgressCancel* Progress)
+	/**
+	 * Copy of the source mesh with VertexUV.X initialized to the weightmap value, ready to be tessellated.
+	 * This only ever holds the (small) source mesh, the tessellated result is written straight into its destination.
+	 */
+	static void PrepareSubdivisionSource(const FDynamicMesh3& SourceMesh, 
+		const TSharedPtr<FIndexedWeightMap, ESPMode::ThreadSafe>& WeightMap,
+		FDynamicMesh3& OutMesh)
 	{
-		TUniquePtr<FDynamicMesh3> SubdivisionedMesh=MakeUnique<FDynamicMesh3>();
-		SubdivisionedMesh->Copy(*SourceMesh);
+		OutMesh.Copy(SourceMesh);
 		// If we have a WeightMap, initialize VertexUV.X with weightmap value. Note that we are going to process .Y anyway,
 		// we could (for exmaple) speculatively compute another weightmap, or store previous weightmap values there, to support
 		// fast switching between two...
-		SubdivisionedMesh->EnableVertexUVs(FVector2f::Zero());
+		OutMesh.EnableVertexUVs(FVector2f::Zero());
 		if (WeightMap != nullptr)
 		{
-			for (int32 vid : SubdivisionedMesh->VertexIndicesItr())
+			for (int32 vid : OutMesh.VertexIndicesItr())
 			{
-				SubdivisionedMesh->SetVertexUV(vid, FVector2f(WeightMap->GetValue(vid), 0));
+				OutMesh.SetVertexUV(vid, FVector2f(WeightMap->GetValue(vid), 0));
 			}
 		}
 		else
 		{
-			for (int32 vid : SubdivisionedMesh->VertexIndicesItr())
+			for (int32 vid : OutMesh.VertexIndicesItr())
 			{
-				SubdivisionedMesh->SetVertexUV(vid, FVector2f::One());
+				OutMesh.SetVertexUV(vid, FVector2f::One());
 			}
 		}
-		
+	}
+
+	bool SubdivideInto(const FDynamicMesh3& SourceMesh,
+		EDisplaceMeshToolSubdivisionType SubdivisionType,
+		int SubdivisionsCount,
+		int32 TriangleBudget,
+		bool bClampToBudget,
+		const TSharedPtr<FDpPNControlPointCache, ESPMode::ThreadSafe>& ControlPointCache,
+		FProgressCancel* Progress,
+		FDynamicMesh3& OutMesh)
+	{
+		if (SubdivisionsCount == 0)
+		{
+			OutMesh.Copy(SourceMesh);
+			return true;
+		}
+
 		if (SubdivisionType == EDisplaceMeshToolSubdivisionType::Flat) 
 		{
-			FDpUniformTessellate Tessellator(SubdivisionedMesh.Get());
+			FDpUniformTessellate Tessellator(&SourceMesh, &OutMesh);
 			Tessellator.Progress = Progress;
 			Tessellator.TessellationNum = SubdivisionsCount;
+			Tessellator.TriangleBudget = TriangleBudget;
+			Tessellator.bClampToBudget = bClampToBudget;
 						
 			if (Tessellator.Validate() == EOperationValidationResult::Ok) 
 			{
-				Tessellator.Compute();
+				return Tessellator.Compute();
 			}
 		}
 		else if (SubdivisionType == EDisplaceMeshToolSubdivisionType::PNTriangles) 
 		{
-			DpFPNTriangles PNTriangles(SubdivisionedMesh.Get());
+			DpFPNTriangles PNTriangles(&SourceMesh, &OutMesh);
 			PNTriangles.Progress = Progress;
 			PNTriangles.TessellationLevel = SubdivisionsCount;
+			PNTriangles.TriangleBudget = TriangleBudget;
+			PNTriangles.bClampToBudget = bClampToBudget;
+			PNTriangles.ControlPointCache = ControlPointCache;
 
 			if (PNTriangles.Validate() == EOperationValidationResult::Ok)
 			{
-				PNTriangles.Compute(); 
+				return PNTriangles.Compute(); 
 			}
 		}
 		else 
@@ -668,51 +1506,438 @@ namespace DisplaceMeshToolLocals{
 			checkNoEntry();
 		}
 
-		
-		return SubdivisionedMesh;
+		return false;
 	}
 
-	void FDisplaceMeshThread::CalculateResult(FProgressCancel* Progress)
-	{	
-		TUniquePtr<FDynamicMesh3> SubdivisionMesh= CalculateSubdivisionResult(Progress);
-		ResultMesh->Copy(*SubdivisionMesh);
-		bool bMapOk=false;
-		AsyncTask(ENamedThreads::GameThread,[this,&bMapOk]()
+	bool SubdivideChunks(const FDynamicMesh3& SourceMesh,
+		EDisplaceMeshToolSubdivisionType SubdivisionType,
+		int SubdivisionsCount,
+		int64 ChunkTriangleBudget,
+		FProgressCancel* Progress,
+		TFunctionRef<bool(FDynamicMesh3& Chunk, int32 ChunkIndex)> ChunkCallback)
+	{
+		if (SubdivisionType == EDisplaceMeshToolSubdivisionType::Flat) 
+		{
+			FDpUniformTessellate Tessellator(&SourceMesh, nullptr);
+			Tessellator.Progress = Progress;
+			Tessellator.TessellationNum = SubdivisionsCount;
+			return Tessellator.ComputeChunks(ChunkTriangleBudget, ChunkCallback);
+		}
+		else if (SubdivisionType == EDisplaceMeshToolSubdivisionType::PNTriangles) 
 		{
-			UpdateDisplaceMap();
-			bMapOk=true;
+			DpFPNTriangles PNTriangles(&SourceMesh, nullptr);
+			PNTriangles.Progress = Progress;
+			PNTriangles.TessellationLevel = SubdivisionsCount;
+			return PNTriangles.ComputeChunks(ChunkTriangleBudget, ChunkCallback);
+		}
+		else 
+		{
+			// Unsupported subdivision type
+			checkNoEntry();
+		}
+
+		return false;
+	}
+
+	bool SubdivideAdaptiveInto(const FDynamicMesh3& SourceMesh,
+		EDisplaceMeshToolSubdivisionType SubdivisionType,
+		const TFunction<double(const FDynamicMesh3&, int32)>& EdgeError,
+		double ErrorThreshold,
+		int32 TriangleBudget,
+		const TSharedPtr<FDpPNControlPointCache, ESPMode::ThreadSafe>& ControlPointCache,
+		FProgressCancel* Progress,
+		FDynamicMesh3& OutMesh)
+	{
+		if (SubdivisionType == EDisplaceMeshToolSubdivisionType::Flat) 
+		{
+			FDpAdaptiveTessellate Tessellator(&SourceMesh, &OutMesh);
+			Tessellator.Progress = Progress;
+			Tessellator.EdgeError = EdgeError;
+			Tessellator.ErrorThreshold = ErrorThreshold;
+			Tessellator.TriangleBudget = TriangleBudget;
+
+			if (Tessellator.Validate() == EOperationValidationResult::Ok) 
+			{
+				return Tessellator.Compute();
+			}
+		}
+		else if (SubdivisionType == EDisplaceMeshToolSubdivisionType::PNTriangles) 
+		{
+			DpFPNTriangles PNTriangles(&SourceMesh, &OutMesh);
+			PNTriangles.Progress = Progress;
+			PNTriangles.AdaptiveEdgeError = EdgeError;
+			PNTriangles.AdaptiveErrorThreshold = ErrorThreshold;
+			PNTriangles.TriangleBudget = TriangleBudget;
+			PNTriangles.ControlPointCache = ControlPointCache;
+
+			if (PNTriangles.Validate() == EOperationValidationResult::Ok)
+			{
+				return PNTriangles.Compute(); 
+			}
+		}
+		else 
+		{
+			// Unsupported subdivision type
+			checkNoEntry();
+		}
+
+		return false;
+	}
+
+	bool FDisplaceMeshThread::CalculateSubdivisionResult(FProgressCancel* Progress, FDynamicMesh3& OutMesh)
+	{
+		FDynamicMesh3 PreparedSource;
+		PrepareSubdivisionSource(*SourceMesh, WeightMap, PreparedSource);
+		if (Parameters->bAdaptiveTessellation)
+		{
+			// the fields are only read here, they must have been decoded before subdividing
+			const DisplaceMeshParameters& Params = *Parameters;
+			auto EdgeError = [&Params](const FDynamicMesh3& Mesh, int32 EdgeID)
+			{
+				return ComputeDisplacement::EdgeDisplacementError(Mesh, EdgeID, Params.DisplacePyramid, Params.CullPyramid, Params.AdaptiveTolerance, Params.UVScale, Params.UVOffset);
+			};
+			return SubdivideAdaptiveInto(PreparedSource, SubdivisionType, EdgeError, Parameters->AdaptiveTolerance, Parameters->TriangleBudget, PNControlPointCache, Progress, OutMesh);
+		}
+		return SubdivideInto(PreparedSource, SubdivisionType, SubdivisionsCount, Parameters->TriangleBudget, Parameters->bClampToBudget, PNControlPointCache, Progress, OutMesh);
+	}
+
+	bool FDisplaceMeshThread::CalculateChunkedResult(FProgressCancel* Progress)
+	{
+		// the clusters end up in one mesh description, whose element IDs are int32
+		if (FDpUniformTessellate::ExpectedNumTriangles(*SourceMesh, SubdivisionsCount) > FDpUniformTessellate::MaxResultTriangles)
+		{
+			return false;
+		}
+
+		FDynamicMesh3 PreparedSource;
+		PrepareSubdivisionSource(*SourceMesh, WeightMap, PreparedSource);
+		return SubdivideChunks(PreparedSource, SubdivisionType, SubdivisionsCount, Parameters->TriangleBudget, Progress, 
+			[this, Progress](FDynamicMesh3& Chunk, int32 ChunkIndex)
+		{
+			TSharedPtr<FDisplacementCache> NoCache;
+			if (DisplaceAndCull(Progress, Chunk, true, NoCache) == false)
+			{
+				return false;
+			}
+			MeshOp->ReMeshClusters.Add(MoveTemp(Chunk));
+			MeshOp->ConversionProgress.EnterStage(EDpConversionStage::Tessellate);
+			return true;
 		});
+	}
+
+	// Bump when the checkpoint content, the key or the tessellators change
+	static constexpr int32 TessellationCheckpointVersion = 3;
+
+	FString FDisplaceMeshThread::TessellationCacheKey() const
+	{
+		FSHA1 Sha;
+		// Scalars are hashed as raw bytes, structs field by field so that their padding never reaches the hash
+		auto HashValue = [&Sha](const auto Value)
+		{
+			using ValueType = decltype(Value);
+			static_assert(TIsArithmetic<ValueType>::Value || TIsEnum<ValueType>::Value, "Hash the fields of structs");
+			Sha.Update(reinterpret_cast<const uint8*>(&Value), sizeof(Value));
+		};
+		auto HashVector = [&HashValue](const auto& Vector, const int32 NumComponents)
+		{
+			for (int32 Index = 0; Index < NumComponents; ++Index)
+			{
+				HashValue(Vector[Index]);
+			}
+		};
+		auto HashString = [&Sha](const FString& String)
+		{
+			Sha.UpdateWithString(*String, String.Len());
+		};
 
-		while (!bMapOk)
+		HashValue(TessellationCheckpointVersion);
+		HashValue(SubdivisionType);
+		HashValue(Parameters->bAdaptiveTessellation);
+		HashValue(Parameters->TriangleBudget);
+		if (Parameters->bAdaptiveTessellation)
 		{
-			FPlatformProcess::Sleep(0.01);
+			// the adaptive refinement follows the displacement map
+			HashValue(Parameters->AdaptiveTolerance);
+			HashVector(Parameters->UVScale, 2);
+			HashVector(Parameters->UVOffset, 2);
+			HashString(Parameters->DisplacementMap ? Parameters->DisplacementMap->GetPathName() : FString());
+			if (Parameters->DisplacementMap)
+			{
+				const FGuid Guid = Parameters->DisplacementMap->GetLightingGuid();
+				HashValue(Guid.A);
+				HashValue(Guid.B);
+				HashValue(Guid.C);
+				HashValue(Guid.D);
+			}
+		}
+		else
+		{
+			HashValue(SubdivisionsCount);
 		}
-		
-		if (Progress && Progress->Cancelled()) return;
 
-		
+		// Everything the checkpoint restores has to be in the key, whichever payload FDpTessellationCache writes
+		HashValue(SourceMesh->HasVertexNormals());
+		HashValue(SourceMesh->HasVertexColors());
+		HashValue(SourceMesh->HasVertexUVs());
+		for (int32 vid : SourceMesh->VertexIndicesItr())
+		{
+			HashValue(vid);
+			HashVector(SourceMesh->GetVertex(vid), 3);
+			HashValue(WeightMap.IsValid() ? WeightMap->GetValue(vid) : 1.0f);
+			if (SourceMesh->HasVertexNormals())
+			{
+				HashVector(SourceMesh->GetVertexNormal(vid), 3);
+			}
+			if (SourceMesh->HasVertexColors())
+			{
+				HashVector(SourceMesh->GetVertexColor(vid), 4);
+			}
+			if (SourceMesh->HasVertexUVs())
+			{
+				HashVector(SourceMesh->GetVertexUV(vid), 2);
+			}
+		}
+
+		HashValue(SourceMesh->HasTriangleGroups());
+		for (int32 tid : SourceMesh->TriangleIndicesItr())
+		{
+			HashValue(tid);
+			HashVector(SourceMesh->GetTriangle(tid), 3);
+			if (SourceMesh->HasTriangleGroups())
+			{
+				HashValue(SourceMesh->GetTriangleGroup(tid));
+			}
+		}
+
+		HashValue(SourceMesh->HasAttributes());
+		if (SourceMesh->HasAttributes())
+		{
+			const FDynamicMeshAttributeSet* Attributes = SourceMesh->Attributes();
+			if (Attributes->NumAttachedAttributes() > 0)
+			{
+				return FString(); // their content can not be hashed generically, skip the checkpoint
+			}
+
+			auto HashOverlay = [&](const auto* Overlay, const int32 ElementSize)
+			{
+				float Element[4];
+				for (int32 eid : Overlay->ElementIndicesItr())
+				{
+					HashValue(eid);
+					Overlay->GetElement(eid, Element);
+					HashVector(Element, ElementSize);
+				}
+				for (int32 tid : SourceMesh->TriangleIndicesItr())
+				{
+					HashVector(Overlay->IsSetTriangle(tid) ? Overlay->GetTriangle(tid) : FIndex3i::Invalid(), 3);
+				}
+			};
+			HashValue(Attributes->NumUVLayers());
+			for (int32 UVLayerIndex = 0; UVLayerIndex < Attributes->NumUVLayers(); ++UVLayerIndex)
+			{
+				HashOverlay(Attributes->GetUVLayer(UVLayerIndex), 2);
+			}
+			HashValue(Attributes->NumNormalLayers());
+			for (int32 NormalLayerIndex = 0; NormalLayerIndex < Attributes->NumNormalLayers(); ++NormalLayerIndex)
+			{
+				HashOverlay(Attributes->GetNormalLayer(NormalLayerIndex), 3);
+			}
+			HashValue(Attributes->HasPrimaryColors());
+			if (Attributes->HasPrimaryColors())
+			{
+				HashOverlay(Attributes->PrimaryColors(), 4);
+			}
+
+			HashValue(Attributes->HasMaterialID());
+			if (Attributes->HasMaterialID())
+			{
+				const FDynamicMeshMaterialAttribute* MaterialIDs = Attributes->GetMaterialID();
+				for (int32 tid : SourceMesh->TriangleIndicesItr())
+				{
+					int32 MaterialID = 0;
+					MaterialIDs->GetValue(tid, &MaterialID);
+					HashValue(MaterialID);
+				}
+			}
+			HashValue(Attributes->NumPolygroupLayers());
+			for (int32 LayerIndex = 0; LayerIndex < Attributes->NumPolygroupLayers(); ++LayerIndex)
+			{
+				const FDynamicMeshPolygroupAttribute* Polygroups = Attributes->GetPolygroupLayer(LayerIndex);
+				for (int32 tid : SourceMesh->TriangleIndicesItr())
+				{
+					HashValue(Polygroups->GetValue(tid));
+				}
+			}
+			HashValue(Attributes->NumWeightLayers());
+			for (int32 LayerIndex = 0; LayerIndex < Attributes->NumWeightLayers(); ++LayerIndex)
+			{
+				const FDynamicMeshWeightAttribute* Weights = Attributes->GetWeightLayer(LayerIndex);
+				for (int32 vid : SourceMesh->VertexIndicesItr())
+				{
+					float Weight = 0;
+					Weights->GetValue(vid, &Weight);
+					HashValue(Weight);
+				}
+			}
+			HashValue(Attributes->GetSkinWeightsAttributes().Num());
+			for (const TTuple<FName, TUniquePtr<FDynamicMeshVertexSkinWeightsAttribute>>& SkinWeights : Attributes->GetSkinWeightsAttributes())
+			{
+				HashString(SkinWeights.Key.ToString());
+				for (int32 vid : SourceMesh->VertexIndicesItr())
+				{
+					UE::AnimationCore::FBoneWeights BoneWeights;
+					SkinWeights.Value->GetValue(vid, BoneWeights);
+					HashValue(BoneWeights.Num());
+					for (int32 Index = 0; Index < BoneWeights.Num(); ++Index)
+					{
+						HashValue(BoneWeights[Index].GetBoneIndex());
+						HashValue(BoneWeights[Index].GetRawWeight());
+					}
+				}
+			}
+		}
+		Sha.Final();
+
+		FSHAHash Hash;
+		Sha.GetHash(Hash.Hash);
+		return Hash.ToString();
+	}
+
+	void FDisplaceMeshThread::CalculateResult(FProgressCancel* Progress)
+	{	
+		// The tessellated mesh is generated, displaced, culled and renormalized in place in the output mesh,
+		// so peak memory is one output mesh plus its vertex normals.
+		FDynamicMesh3& OutMesh = MeshOp->ReMesh;
+		FDpConversionReport& Report = MeshOp->Report;
+		FDpConversionProgress& ConversionProgress = MeshOp->ConversionProgress;
+		auto Abort = [&](EDpConversionStage Stage)
+		{
+			OutMesh.Clear();
+			MeshOp->ReMeshClusters.Empty();
+			ConversionProgress.EnterStage(Stage);
+		};
+
 		if (DisplacementType == EDisplaceMeshToolDisplaceType::DisplacementMap && !Parameters->DisplacementMap)
 		{
+			Abort(EDpConversionStage::Failed);
 			return;
 		}
 
-		
-		SourceNormals = FMeshNormals(SubdivisionMesh.Get());
-		SourceNormals.ComputeVertexNormals();
+		// A uniform level whose result does not fit in TriangleBudget is converted as clusters of at most TriangleBudget
+		// triangles instead, see FDpMeshOptional::bClampToBudget
+		const bool bChunked = !Parameters->bAdaptiveTessellation && !Parameters->bClampToBudget &&
+			FDpUniformTessellate::ExpectedNumTriangles(*SourceMesh, SubdivisionsCount) > Parameters->TriangleBudget;
+		Report.DisplaceTime = 0;
+		Report.CullTime = 0;
+
+		// Nothing needs the fields until the displacement stage, so decode them on another worker while we 
+		// subdivide. A texture that needs the game thread was already read by ReadDisplaceMapIfGameThreadOnly(),
+		// this thread never waits for the game thread.
+		ConversionProgress.EnterStage(EDpConversionStage::Decode);
+		double DecodeStartTime = PreReadStartTime, DecodeEndTime = PreReadEndTime;
+		TFuture<void> DecodeFuture;
+		if (bDisplaceMapRead == false)
+		{
+			DecodeFuture = Async(EAsyncExecution::TaskGraph, [this, &DecodeStartTime, &DecodeEndTime]()
+			{
+				DecodeStartTime = FPlatformTime::Seconds();
+				UpdateDisplaceMap();
+				DecodeEndTime = FPlatformTime::Seconds();
+			});
+		}
 
-		if (Progress && Progress->Cancelled()) return;
-		// cache initial positions
-		SourcePositions.SetNum(SubdivisionMesh->MaxVertexID());
-		for (int vid : ResultMesh->VertexIndicesItr())
+		// a checkpoint holds one tessellated mesh, the clusters are displaced as they are tessellated
+		const FString CheckpointKey = (Parameters->bUseTessellationCheckpoint && !bChunked) ? TessellationCacheKey() : FString();
+		const double CheckpointStartTime = FPlatformTime::Seconds();
+		Report.bCheckpointHit = !CheckpointKey.IsEmpty() && FDpTessellationCache::Get().Load(CheckpointKey, OutMesh);
+		double CheckpointTime = Report.bCheckpointHit ? FPlatformTime::Seconds() - CheckpointStartTime : 0.0;
+
+		if ((Parameters->bAdaptiveTessellation || bChunked) && !Report.bCheckpointHit)
 		{
-			SourcePositions[vid] = SubdivisionMesh->GetVertex(vid);
+			// Adaptive tessellation measures its error on the fields and each cluster is displaced once it is 
+			// tessellated, so there is nothing to overlap with
+			if (DecodeFuture.IsValid())
+			{
+				DecodeFuture.Wait();
+			}
 		}
 
-		if (Progress && Progress->Cancelled()) return;
-		DisplacedPositions.SetNum(SubdivisionMesh->MaxVertexID());
-		CullMask.SetNum(SubdivisionMesh->MaxVertexID());
+		ConversionProgress.EnterStage(EDpConversionStage::Tessellate);
+		const double SubdivisionStartTime = FPlatformTime::Seconds();
+		const bool bSubdivided = Report.bCheckpointHit || (bChunked ? CalculateChunkedResult(Progress) : CalculateSubdivisionResult(Progress, OutMesh));
+		const double SubdivisionEndTime = FPlatformTime::Seconds();
+
+		if (bSubdivided && !Report.bCheckpointHit && !CheckpointKey.IsEmpty() && !(Progress && Progress->Cancelled()))
+		{
+			// a later conversion of the same mesh, e.g. with another intensity, starts from here
+			FDpTessellationCache::Get().Save(CheckpointKey, OutMesh, (SubdivisionEndTime - SubdivisionStartTime) * 1000.0);
+			CheckpointTime = FPlatformTime::Seconds() - SubdivisionEndTime;
+		}
+
+		// Always wait for the decode before leaving, the task writes to locals and Parameters
+		const double WaitStartTime = FPlatformTime::Seconds();
+		if (DecodeFuture.IsValid())
+		{
+			DecodeFuture.Wait();
+		}
+		const double WaitEndTime = FPlatformTime::Seconds();
+
+		Report.SubdivisionTime = Report.bCheckpointHit ? 0.0 : (SubdivisionEndTime - SubdivisionStartTime) * 1000.0;
+		if (bChunked)
+		{
+			// the clusters were displaced and culled in between
+			Report.SubdivisionTime = FMath::Max(0.0, Report.SubdivisionTime - Report.DisplaceTime - Report.CullTime);
+		}
+		Report.CheckpointTime = CheckpointTime * 1000.0;
+		Report.DecodeTime = (DecodeEndTime - DecodeStartTime) * 1000.0;
+		Report.DecodeOverlapTime = FMath::Max(0.0, FMath::Min(DecodeEndTime, SubdivisionEndTime) - FMath::Max(DecodeStartTime, SubdivisionStartTime)) * 1000.0;
+		Report.DecodeWaitTime = (WaitEndTime - WaitStartTime) * 1000.0;
+
+		if (Progress && Progress->Cancelled())
+		{
+			Abort(EDpConversionStage::Cancelled);
+			return;
+		}
+		if (!bSubdivided)
+		{
+			Abort(EDpConversionStage::Failed);
+			return;
+		}
+
+		if (bChunked)
+		{
+			bDone=true;
+			ConversionProgress.EnterStage(EDpConversionStage::Commit);
+			return;
+		}
+
+		TSharedPtr<FDisplacementCache> DisplacementCache;
+		if (DisplaceAndCull(Progress, OutMesh, false, DisplacementCache) == false)
+		{
+			Abort((Progress && Progress->Cancelled()) ? EDpConversionStage::Cancelled : EDpConversionStage::Failed);
+			return;
+		}
+
+		// read by the game thread once the task is done
+		MeshOp->DisplacementCache = DisplacementCache;
+		bDone=true;
+		ConversionProgress.EnterStage(EDpConversionStage::Commit);
+	}
+
+	bool FDisplaceMeshThread::DisplaceAndCull(FProgressCancel* Progress, FDynamicMesh3& OutMesh, bool bChunk, TSharedPtr<FDisplacementCache>& DisplacementCache)
+	{
+		FDpConversionReport& Report = MeshOp->Report;
+		FDpConversionProgress& ConversionProgress = MeshOp->ConversionProgress;
+		ConversionProgress.EnterStage(EDpConversionStage::Displace);
+		const double DisplaceStartTime = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
+		SourceNormals = ComputeDisplacement::TessellatedVertexNormals(OutMesh, SubdivisionType == EDisplaceMeshToolSubdivisionType::PNTriangles);
+
+		if (Progress && Progress->Cancelled())
+		{
+			SourceNormals = FMeshNormals();
+			return false;
+		}
 		TArray<int> TriCullIDs;
-		if (Progress && Progress->Cancelled()) return;
 
 		ComputeDisplacement::FDirectionalFilter DirectionalFilter{ Parameters->bEnableFilter,
 			FVector3d(Parameters->FilterDirection),
@@ -722,7 +1947,8 @@ namespace DisplaceMeshToolLocals{
 		TUniqueFunction<float(int32 vid, const FVector3d&)> WeightMapQueryFunc = [&](int32, const FVector3d&) { return 1.0f; };
 		if (Parameters->WeightMap.IsValid())
 		{
-			if (SubdivisionMesh->IsCompactV() && SubdivisionMesh->VertexCount() == Parameters->WeightMap->Num())
+			// a chunk holds a part of the source, its vertex IDs are never those of the weight map
+			if (bChunk == false && OutMesh.IsCompactV() && OutMesh.VertexCount() == Parameters->WeightMap->Num())
 			{
 				WeightMapQueryFunc = [&](int32 vid, const FVector3d& Pos) { return Parameters->WeightMap->GetValue(vid); };
 			}
@@ -730,105 +1956,172 @@ namespace DisplaceMeshToolLocals{
 			{
 				// disable input query function as it uses expensive AABBTree lookup
 				//WeightMapQueryFunc = [&](int32 vid, const FVector3d& Pos) { return Parameters->WeightMapQueryFunc(Pos, *Parameters->WeightMap); };
-				WeightMapQueryFunc = [&](int32 vid, const FVector3d& Pos) { return SubdivisionMesh->GetVertexUV(vid).X; };
+				WeightMapQueryFunc = [&](int32 vid, const FVector3d& Pos) { return OutMesh.GetVertexUV(vid).X; };
 			}
 		}
+		auto WeightFunc = [&](int32 vid, const FVector3d& Position, const FVector3d& Normal)
+		{
+			return DirectionalFilter.FilterValue(Normal) * WeightMapQueryFunc(vid, Position);
+		};
 		auto IntensityFunc = [&](int32 vid, const FVector3d& Position, const FVector3d& Normal) 
 		{
-			return Intensity * DirectionalFilter.FilterValue(Normal) * WeightMapQueryFunc(vid, Position);
+			return Intensity * WeightFunc(vid, Position, Normal);
 		};
 
-
-
-		FDynamicMesh3 CopyMesh;
-		CopyMesh.Copy(*SubdivisionMesh);
-		// compute Displaced positions in PositionBuffer
-		switch (DisplacementType)
+		if (DisplacementType == EDisplaceMeshToolDisplaceType::DisplacementMap)
 		{
-		default:
-		case EDisplaceMeshToolDisplaceType::Constant:
-			ComputeDisplacement::Constant(*SubdivisionMesh, 
-				SourcePositions, 
-				SourceNormals,
-				IntensityFunc,
-				DisplacedPositions);
-			break;
-
-		case EDisplaceMeshToolDisplaceType::RandomNoise:
-			ComputeDisplacement::RandomNoise(*SubdivisionMesh, 
-				SourcePositions, 
-				SourceNormals,
-				IntensityFunc,
-				Parameters->RandomSeed,
-				DisplacedPositions);
-			break;
-			
-		case EDisplaceMeshToolDisplaceType::PerlinNoise:
-			ComputeDisplacement::PerlinNoise(*SubdivisionMesh,
-				SourcePositions,
-				SourceNormals,
-				IntensityFunc,
-				Parameters->PerlinLayerProperties,	
-				Parameters->RandomSeed,
-				DisplacedPositions);
-			break;
+			TArray<int32> VertexElements;
+			if (Parameters->bKeepDisplacementCache && bChunk == false)
+			{
+				DisplacementCache = MakeShared<FDisplacementCache>();
+				DisplacementCache->Intensity = Parameters->DisplaceIntensity;
+				DisplacementCache->BaseValue = Parameters->DisplacementMapBaseValue;
+				DisplacementCache->UVScale = Parameters->UVScale;
+				DisplacementCache->UVOffset = Parameters->UVOffset;
+				DisplacementCache->AdjustmentCurve = Parameters->AdjustmentCurve;
+				DisplacementCache->bTopologyFollowsUVs = Parameters->bAdaptiveTessellation;
+				DisplacementCache->bRecalculateNormals = Parameters->bRecalculateNormals;
+				DisplacementCache->Capture(OutMesh, SourceNormals, WeightFunc);
+			}
 
-		case EDisplaceMeshToolDisplaceType::DisplacementMap:
-			ComputeDisplacement::Map(CopyMesh, 
-				SourcePositions, 
+			// Each vertex is displaced exactly once, so positions can be updated in place
+			ComputeDisplacement::ParallelMapInPlace(OutMesh,
 				SourceNormals,
 				IntensityFunc,
-				Parameters->DisplaceField,
-				Parameters->CullField,
-				DisplacedPositions,
+				Parameters->DisplacePyramid,
+				Parameters->CullPyramid,
 				TriCullIDs,
 				Parameters->DisplacementMapBaseValue,
 				Parameters->UVScale,
 				Parameters->UVOffset,
-				Parameters->AdjustmentCurve.Get());
-			break;
+				Parameters->AdjustmentCurve.Get(),
+				DisplacementCache ? &VertexElements : nullptr,
+				Progress);
 
-		case EDisplaceMeshToolDisplaceType::SineWave:
-			ComputeDisplacement::Sine(*SubdivisionMesh, 
-				SourcePositions, 
-				SourceNormals,
-				IntensityFunc,
-				Parameters->SineWaveFrequency,
-				Parameters->SineWavePhaseShift,
-				(FVector3d)Parameters->SineWaveDirection,
-				DisplacedPositions);
-			break;
+			if (DisplacementCache)
+			{
+				DisplacementCache->CaptureUVs(OutMesh, VertexElements, Parameters->CullPyramid);
+				// nothing samples the field after this, the parameters belong to this conversion only
+				DisplacementCache->DisplaceField = MoveTemp(Parameters->DisplacePyramid);
+			}
+		}
+		else
+		{
+			// cache initial positions
+			SourcePositions.SetNum(OutMesh.MaxVertexID());
+			for (int vid : OutMesh.VertexIndicesItr())
+			{
+				SourcePositions[vid] = OutMesh.GetVertex(vid);
+			}
+			DisplacedPositions.SetNum(OutMesh.MaxVertexID());
+
+			// compute Displaced positions in PositionBuffer
+			switch (DisplacementType)
+			{
+			default:
+			case EDisplaceMeshToolDisplaceType::Constant:
+				ComputeDisplacement::Constant(OutMesh, 
+					SourcePositions, 
+					SourceNormals,
+					IntensityFunc,
+					DisplacedPositions);
+				break;
+
+			case EDisplaceMeshToolDisplaceType::RandomNoise:
+				ComputeDisplacement::RandomNoise(OutMesh, 
+					SourcePositions, 
+					SourceNormals,
+					IntensityFunc,
+					Parameters->RandomSeed,
+					DisplacedPositions);
+				break;
+				
+			case EDisplaceMeshToolDisplaceType::PerlinNoise:
+				ComputeDisplacement::PerlinNoise(OutMesh,
+					SourcePositions,
+					SourceNormals,
+					IntensityFunc,
+					Parameters->PerlinLayerProperties,	
+					Parameters->RandomSeed,
+					DisplacedPositions);
+				break;
+
+			case EDisplaceMeshToolDisplaceType::SineWave:
+				ComputeDisplacement::Sine(OutMesh, 
+					SourcePositions, 
+					SourceNormals,
+					IntensityFunc,
+					Parameters->SineWaveFrequency,
+					Parameters->SineWavePhaseShift,
+					(FVector3d)Parameters->SineWaveDirection,
+					DisplacedPositions);
+				break;
+			}
+			// update preview vertex positions
+			for (int vid : OutMesh.VertexIndicesItr())
+			{
+				OutMesh.SetVertex(vid, DisplacedPositions[vid]);
+			}
+			SourcePositions.Empty();
+			DisplacedPositions.Empty();
 		}
-		// update preview vertex positions
-		for (int vid : CopyMesh.VertexIndicesItr())
+		SourceNormals = FMeshNormals();
+		const double CullStartTime = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
+		Report.DisplaceTime += CullStartTime - DisplaceStartTime;
+
+		if (Progress && Progress->Cancelled())
 		{
-			CopyMesh.SetVertex(vid, DisplacedPositions[vid]);
+			return false;
 		}
 
 		// Cull Mesh
-		for(int cid:TriCullIDs)
+		ConversionProgress.EnterStage(EDpConversionStage::Cull);
+		TArray<int32> VertexRemap;
+		if (ComputeDisplacement::CullAndCompact(OutMesh, TriCullIDs, DisplacementCache ? &VertexRemap : nullptr) == false)
+		{
+			return false;
+		}
+		if (DisplacementCache)
+		{
+			DisplacementCache->Compact(VertexRemap, OutMesh.MaxVertexID());
+		}
+		Report.CullTime += FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64()) - CullStartTime;
+
+		if (Progress && Progress->Cancelled())
 		{
-			CopyMesh.RemoveTriangle(cid);
+			return false;
 		}
+
 		// recalculate normals
 		if (Parameters->bRecalculateNormals)
 		{
-			if (CopyMesh.HasAttributes())
-			{
-				FMeshNormals Normals(&CopyMesh);
-				FDynamicMeshNormalOverlay* NormalOverlay = CopyMesh.Attributes()->PrimaryNormals();
-				Normals.RecomputeOverlayNormals(NormalOverlay);
-				Normals.CopyToOverlay(NormalOverlay);
-			}
-			else
+			ComputeDisplacement::RecalculateNormals(OutMesh);
+			if (Progress && Progress->Cancelled())
 			{
-				FMeshNormals::QuickComputeVertexNormals(CopyMesh);
+				return false;
 			}
 		}
 
-		MeshOp->ReMesh.Copy(CopyMesh);
-		bDone=true;
+		return true;
 	}
+
+	/** Runs a prepared FDisplaceMeshThread as the operator of an abortable TModelingOpTask, and owns it. */
+	class FDisplaceMeshTaskOp : public FDynamicMeshOperator
+	{
+	public:
+		explicit FDisplaceMeshTaskOp(FDisplaceMeshThread* DisplaceIn)
+			: Displace(DisplaceIn)
+		{
+		}
+
+		virtual void CalculateResult(FProgressCancel* Progress) override
+		{
+			Displace->CalculateResult(Progress);
+		}
+
+	private:
+		TUniquePtr<FDisplaceMeshThread> Displace;
+	};
 	
 	class FSubdivideDisplaceMeshOp : public FDynamicMeshOperator
 	{
@@ -843,7 +2136,7 @@ namespace DisplaceMeshToolLocals{
 
 		void SaveSubdivisionResult();
 
-		TUniquePtr<FDynamicMesh3> CalculateSubdivisionResult(FProgressCancel* Progress);
+		bool CalculateSubdivisionResult(FProgressCancel* Progress, FDynamicMesh3& OutMesh);
 
 	private:
 		FDynamicMesh3* SourceMesh;
@@ -879,59 +2172,11 @@ namespace DisplaceMeshToolLocals{
 
 	}
 
-	TUniquePtr<FDynamicMesh3> FSubdivideDisplaceMeshOp::CalculateSubdivisionResult(FProgressCancel* Progress)
+	bool FSubdivideDisplaceMeshOp::CalculateSubdivisionResult(FProgressCancel* Progress, FDynamicMesh3& OutMesh)
 	{
-		TUniquePtr<FDynamicMesh3> SubdivisionedMesh=MakeUnique<FDynamicMesh3>();
-		SubdivisionedMesh->Copy(*SourceMesh);
-		// If we have a WeightMap, initialize VertexUV.X with weightmap value. Note that we are going to process .Y anyway,
-		// we could (for exmaple) speculatively compute another weightmap, or store previous weightmap values there, to support
-		// fast switching between two...
-		SubdivisionedMesh->EnableVertexUVs(FVector2f::Zero());
-		if (WeightMap != nullptr)
-		{
-			for (int32 vid : SubdivisionedMesh->VertexIndicesItr())
-			{
-				SubdivisionedMesh->SetVertexUV(vid, FVector2f(WeightMap->GetValue(vid), 0));
-			}
-		}
-		else
-		{
-			for (int32 vid : SubdivisionedMesh->VertexIndicesItr())
-			{
-				SubdivisionedMesh->SetVertexUV(vid, FVector2f::One());
-			}
-		}
-		
-		if (SubdivisionType == EDisplaceMeshToolSubdivisionType::Flat) 
-		{
-			FDpUniformTessellate Tessellator(SubdivisionedMesh.Get());
-			Tessellator.Progress = Progress;
-			Tessellator.TessellationNum = SubdivisionsCount;
-						
-			if (Tessellator.Validate() == EOperationValidationResult::Ok) 
-			{
-				Tessellator.Compute();
-			}
-		}
-		else if (SubdivisionType == EDisplaceMeshToolSubdivisionType::PNTriangles) 
-		{
-			DpFPNTriangles PNTriangles(SubdivisionedMesh.Get());
-			PNTriangles.Progress = Progress;
-			PNTriangles.TessellationLevel = SubdivisionsCount;
-
-			if (PNTriangles.Validate() == EOperationValidationResult::Ok)
-			{
-				PNTriangles.Compute(); 
-			}
-		}
-		else 
-		{
-			// Unsupported subdivision type
-			checkNoEntry();
-		}
-
-		
-		return SubdivisionedMesh;
+		FDynamicMesh3 PreparedSource;
+		PrepareSubdivisionSource(*SourceMesh, WeightMap, PreparedSource);
+		return SubdivideInto(PreparedSource, SubdivisionType, SubdivisionsCount, (int32)FDpUniformTessellate::MaxResultTriangles, true, nullptr, Progress, OutMesh);
 	}
 
 	void FSubdivideDisplaceMeshOp::CalculateResult(FProgressCancel* Progress)
@@ -939,8 +2184,8 @@ namespace DisplaceMeshToolLocals{
 		FString Msg=TEXT("Converting DpTexture To Nanite...");
 		FScopedSlowTask SlowComputation(100, FText::FromString(Msg));
 		SlowComputation.EnterProgressFrame(10);		
-		TUniquePtr<FDynamicMesh3> SubdivisionMesh= CalculateSubdivisionResult(Progress);
-		ResultMesh->Copy(*SubdivisionMesh);
+		// Tessellate straight into the operator result, positions are cached below before being displaced
+		if (!CalculateSubdivisionResult(Progress, *ResultMesh)) return;
 		if (Progress && Progress->Cancelled()) return;
 		SlowComputation.EnterProgressFrame(10);	
 		SaveSubdivisionResult();
@@ -952,20 +2197,19 @@ namespace DisplaceMeshToolLocals{
 		}
 
 		
-		SourceNormals = FMeshNormals(SubdivisionMesh.Get());
-		SourceNormals.ComputeVertexNormals();
+		SourceNormals = ComputeDisplacement::TessellatedVertexNormals(*ResultMesh, SubdivisionType == EDisplaceMeshToolSubdivisionType::PNTriangles);
 
 		if (Progress && Progress->Cancelled()) return;
 		// cache initial positions
-		SourcePositions.SetNum(SubdivisionMesh->MaxVertexID());
+		SourcePositions.SetNum(ResultMesh->MaxVertexID());
 		for (int vid : ResultMesh->VertexIndicesItr())
 		{
-			SourcePositions[vid] = SubdivisionMesh->GetVertex(vid);
+			SourcePositions[vid] = ResultMesh->GetVertex(vid);
 		}
 
 		if (Progress && Progress->Cancelled()) return;
-		DisplacedPositions.SetNum(SubdivisionMesh->MaxVertexID());
-		CullMask.SetNum(SubdivisionMesh->MaxVertexID());
+		DisplacedPositions.SetNum(ResultMesh->MaxVertexID());
+		CullMask.SetNum(ResultMesh->MaxVertexID());
 		TArray<int> TriCullIDs;
 		SlowComputation.EnterProgressFrame(10);
 		if (Progress && Progress->Cancelled()) return;
@@ -978,7 +2222,7 @@ namespace DisplaceMeshToolLocals{
 		TUniqueFunction<float(int32 vid, const FVector3d&)> WeightMapQueryFunc = [&](int32, const FVector3d&) { return 1.0f; };
 		if (Parameters.WeightMap.IsValid())
 		{
-			if (SubdivisionMesh->IsCompactV() && SubdivisionMesh->VertexCount() == Parameters.WeightMap->Num())
+			if (ResultMesh->IsCompactV() && ResultMesh->VertexCount() == Parameters.WeightMap->Num())
 			{
 				WeightMapQueryFunc = [&](int32 vid, const FVector3d& Pos) { return Parameters.WeightMap->GetValue(vid); };
 			}
@@ -1001,7 +2245,7 @@ namespace DisplaceMeshToolLocals{
 		{
 		default:
 		case EDisplaceMeshToolDisplaceType::Constant:
-			ComputeDisplacement::Constant(*SubdivisionMesh, 
+			ComputeDisplacement::Constant(*ResultMesh, 
 				SourcePositions, 
 				SourceNormals,
 				IntensityFunc,
@@ -1009,7 +2253,7 @@ namespace DisplaceMeshToolLocals{
 			break;
 
 		case EDisplaceMeshToolDisplaceType::RandomNoise:
-			ComputeDisplacement::RandomNoise(*SubdivisionMesh, 
+			ComputeDisplacement::RandomNoise(*ResultMesh, 
 				SourcePositions, 
 				SourceNormals,
 				IntensityFunc,
@@ -1018,7 +2262,7 @@ namespace DisplaceMeshToolLocals{
 			break;
 			
 		case EDisplaceMeshToolDisplaceType::PerlinNoise:
-			ComputeDisplacement::PerlinNoise(*SubdivisionMesh,
+			ComputeDisplacement::PerlinNoise(*ResultMesh,
 				SourcePositions,
 				SourceNormals,
 				IntensityFunc,
@@ -1028,12 +2272,12 @@ namespace DisplaceMeshToolLocals{
 			break;
 
 		case EDisplaceMeshToolDisplaceType::DisplacementMap:
-			ComputeDisplacement::Map(*SubdivisionMesh, 
+			ComputeDisplacement::ParallelMap(*ResultMesh, 
 				SourcePositions, 
 				SourceNormals,
 				IntensityFunc,
-				Parameters.DisplaceField,
-				Parameters.CullField,
+				Parameters.DisplacePyramid,
+				Parameters.CullPyramid,
 				DisplacedPositions,
 				TriCullIDs,
 				Parameters.DisplacementMapBaseValue,
@@ -1043,7 +2287,7 @@ namespace DisplaceMeshToolLocals{
 			break;
 
 		case EDisplaceMeshToolDisplaceType::SineWave:
-			ComputeDisplacement::Sine(*SubdivisionMesh, 
+			ComputeDisplacement::Sine(*ResultMesh, 
 				SourcePositions, 
 				SourceNormals,
 				IntensityFunc,
@@ -1061,25 +2305,15 @@ namespace DisplaceMeshToolLocals{
 		}
 
 		// Cull Mesh
-		for(int cid:TriCullIDs)
+		if (ComputeDisplacement::CullAndCompact(*ResultMesh, TriCullIDs) == false)
 		{
-			ResultMesh->RemoveTriangle(cid);
+			return;
 		}
 		SlowComputation.EnterProgressFrame(10);
 		// recalculate normals
 		if (Parameters.bRecalculateNormals)
 		{
-			if (ResultMesh->HasAttributes())
-			{
-				FMeshNormals Normals(ResultMesh.Get());
-				FDynamicMeshNormalOverlay* NormalOverlay = ResultMesh->Attributes()->PrimaryNormals();
-				Normals.RecomputeOverlayNormals(NormalOverlay);
-				Normals.CopyToOverlay(NormalOverlay);
-			}
-			else
-			{
-				FMeshNormals::QuickComputeVertexNormals(*ResultMesh);
-			}
+			ComputeDisplacement::RecalculateNormals(*ResultMesh);
 		}
 	}
 
@@ -1214,52 +2448,7 @@ namespace DisplaceMeshToolLocals{
 
 	void FDisplaceMeshOpFactory::UpdateMap()
 	{
-		if (Parameters.DisplacementMap == nullptr ||
-			Parameters.DisplacementMap->GetPlatformData() == nullptr ||
-			Parameters.DisplacementMap->GetPlatformData()->Mips.Num() < 1)
-		{
-			Parameters.DisplaceField = FSampledScalarField2f();
-			Parameters.DisplaceField.GridValues.AssignAll(0);
-
-			Parameters.CullField = FSampledScalarField2f();
-			Parameters.CullField.GridValues.AssignAll(0);
-			return;
-		}
-
-		TImageBuilder<FVector4f> DisplacementMapValues;
-		if (!UE::AssetUtils::ReadTexture(Parameters.DisplacementMap, DisplacementMapValues,
-			// need bPreferPlatformData to be true to respond to non-destructive changes to the texture in the editor
-			true)) 
-		{
-			Parameters.DisplaceField = FSampledScalarField2f();
-			Parameters.DisplaceField.GridValues.AssignAll(0);
-			
-			Parameters.CullField = FSampledScalarField2f();
-			Parameters.CullField.GridValues.AssignAll(0);
-		}
-		else
-		{
-			const FImageDimensions DisplacementMapDimensions = DisplacementMapValues.GetDimensions();
-			int64 TextureWidth = DisplacementMapDimensions.GetWidth();
-			int64 TextureHeight = DisplacementMapDimensions.GetHeight();
-			Parameters.DisplaceField.Resize(TextureWidth, TextureHeight, 0.0f);
-			Parameters.CullField.Resize(TextureWidth, TextureHeight, 0.0f);
-			// Note that the height of the texture will not be 1.0 if it was not square. This should be kept in mind when sampling it later.
-			Parameters.DisplaceField.SetCellSize(1.0f / (float)TextureWidth);
-			Parameters.CullField.SetCellSize(1.0f / (float)TextureWidth);
-
-			for (int64 y = 0; y < TextureHeight; ++y)
-			{
-				for (int64 x = 0; x < TextureWidth; ++x)
-				{
-					Parameters.DisplaceField.GridValues[y * TextureWidth + x] = 
-						DisplacementMapValues.GetPixel(y * TextureWidth + x)[Parameters.DisplacementMapChannel];
-					
-					Parameters.CullField.GridValues[y * TextureWidth + x]=
-						DisplacementMapValues.GetPixel(y * TextureWidth + x)[2];
-				}
-			}
-		}
+		Parameters.ReadDisplacementMap();
 	}
 
 	void FDisplaceMeshOpFactory::SetEnableDirectionalFilter(bool EnableDirectionalFilter)
@@ -1299,6 +2488,7 @@ namespace DisplaceMeshToolLocals{
 FDpMeshOptional::FDpMeshOptional(UMeshComponent* OpTarget,UTexture2D* Texture)
 	: Target(OpTarget)
 	, DpTexture(Texture)
+	, PNControlPointCache(MakeShared<FDpPNControlPointCache, ESPMode::ThreadSafe>())
 {
 }
 
@@ -1307,26 +2497,53 @@ FDpMeshOptional::~FDpMeshOptional()
 	UE_LOG(LogTemp,Warning,TEXT("~FDpMeshOptional"));
 }
 
+TSharedRef<FDpMeshOptional> FDpMeshOptional::Launch(UMeshComponent* OpTarget, UTexture2D* Texture, bool bKeepResultInPreview)
+{
+	TSharedRef<FDpMeshOptional> Optional = MakeShared<FDpMeshOptional>(OpTarget, Texture);
+	Optional->SetKeepPreview(bKeepResultInPreview);
+	Optional->StartOptional();
+	return Optional;
+}
+
 void FDpMeshOptional::StartOptional()
 {
+	if(bNeedsDisplaced && PrepareConversion(true))
+	{
+		StartComputation();
+	}
+}
+
+bool FDpMeshOptional::PrepareConversion(bool bWithPreview)
+{
+	check(IsInGameThread());
+
+	UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(Target);
+	if (StaticMeshComponent == nullptr || DpTexture == nullptr)
+	{
+		return false;
+	}
+
 	TargetWorld = Target->GetWorld();
 	
 	UpdateActiveWeightMap();
 	
-	FActorSpawnParameters SpawnInfo;
-	PreviewMeshActor = TargetWorld->SpawnActor<AInternalToolFrameworkActor>(
-		FVector::ZeroVector, FRotator::ZeroRotator, SpawnInfo);
-	DynamicMeshComponent = NewObject<UDynamicMeshComponent>(PreviewMeshActor);
-	DynamicMeshComponent->SetTangentsType(EDynamicMeshComponentTangentsMode::AutoCalculated);
-	DynamicMeshComponent->SetupAttachment(PreviewMeshActor->GetRootComponent());
-	DynamicMeshComponent->RegisterComponent();
-	DynamicMeshComponent->SetWorldTransform(Target->GetComponentToWorld());
-	DynamicMeshComponent->bExplicitShowWireframe = false; //show wireframe
-	TArray<UMaterialInterface*> MaterialSet = Target->GetMaterials();
-	// transfer materials
-	for (int k = 0; k < MaterialSet.Num(); ++k)
-	{
-		DynamicMeshComponent->SetMaterial(k, MaterialSet[k]);
+	if (bWithPreview)
+	{
+		FActorSpawnParameters SpawnInfo;
+		PreviewMeshActor = TargetWorld->SpawnActor<AInternalToolFrameworkActor>(
+			FVector::ZeroVector, FRotator::ZeroRotator, SpawnInfo);
+		DynamicMeshComponent = NewObject<UDynamicMeshComponent>(PreviewMeshActor);
+		DynamicMeshComponent->SetTangentsType(EDynamicMeshComponentTangentsMode::AutoCalculated);
+		DynamicMeshComponent->SetupAttachment(PreviewMeshActor->GetRootComponent());
+		DynamicMeshComponent->RegisterComponent();
+		DynamicMeshComponent->SetWorldTransform(Target->GetComponentToWorld());
+		DynamicMeshComponent->bExplicitShowWireframe = false; //show wireframe
+		TArray<UMaterialInterface*> MaterialSet = Target->GetMaterials();
+		// transfer materials
+		for (int k = 0; k < MaterialSet.Num(); ++k)
+		{
+			DynamicMeshComponent->SetMaterial(k, MaterialSet[k]);
+		}
 	}
 	const FMeshDescription* FoundMeshDescription = nullptr;
 	static bool bFirst = true;
@@ -1337,19 +2554,25 @@ void FDpMeshOptional::StartOptional()
 		Attributes.Register();
 		bFirst = false;
 	}
-	if (UStaticMesh* StaticMesh = Cast<UStaticMeshComponent>(Target)->GetStaticMesh())
+	// OriginalMesh is converted anew below, so its change stamps do not tell whether the source changed since the
+	// cached PN control points were computed. The derived data key of the static mesh does, a fresh GUID never matches.
+	FString SourceID = FGuid::NewGuid().ToString();
+	if (UStaticMesh* StaticMesh = StaticMeshComponent->GetStaticMesh())
 	{
 		EMeshLODIdentifier UseLOD = EMeshLODIdentifier::LOD0;
+		if (StaticMesh->GetRenderData() != nullptr && StaticMesh->GetRenderData()->DerivedDataKey.IsEmpty() == false)
+		{
+			SourceID = StaticMesh->GetPathName() + TEXT("/") + StaticMesh->GetRenderData()->DerivedDataKey;
+		}
 
 
 		FoundMeshDescription = (UseLOD == EMeshLODIdentifier::HiResSource)
 			                       ? StaticMesh->GetHiResMeshDescription()
 			                       : StaticMesh->GetMeshDescription((int32)UseLOD);
-
-		if (FoundMeshDescription == nullptr)
-		{
-			FoundMeshDescription = &EmptyMeshDescription;
-		}
+	}
+	if (FoundMeshDescription == nullptr)
+	{
+		FoundMeshDescription = &EmptyMeshDescription;
 	}
 
 	using namespace DisplaceMeshToolLocals;
@@ -1357,21 +2580,39 @@ void FDpMeshOptional::StartOptional()
 	UE::Geometry::FDynamicMesh3 DynamicMesh;
 	FMeshDescriptionToDynamicMesh Converter;
 	Converter.Convert(FoundMeshDescription, DynamicMesh);
-	DynamicMeshComponent->SetMesh(MoveTemp(DynamicMesh));
-	OriginalMesh.Copy(*DynamicMeshComponent->GetMesh());
+	if (DynamicMeshComponent)
+	{
+		DynamicMeshComponent->SetMesh(MoveTemp(DynamicMesh));
+		OriginalMesh.Copy(*DynamicMeshComponent->GetMesh());
+	}
+	else
+	{
+		OriginalMesh = MoveTemp(DynamicMesh);
+	}
 	OriginalMeshSpatial.SetMesh(&OriginalMesh, true);
+	PNControlPointCache->SetSourceID(SourceID);
 	TSharedPtr<DisplaceMeshParameters> Parameters=MakeShared<DisplaceMeshParameters>();
-	Parameters->DisplaceIntensity=5.0f;
+	Parameters->DisplaceIntensity=DisplaceIntensity;
+	Parameters->DisplacementMapBaseValue=DisplacementMapBaseValue;
+	Parameters->UVScale=UVScale;
+	Parameters->UVOffset=UVOffset;
+	Parameters->AdjustmentCurve=AdjustmentCurve;
 	Parameters->DisplacementMap=DpTexture;
 	Parameters->DisplacementMapChannel=0;
 	Parameters->WeightMap = ActiveWeightMap;
 	Parameters->WeightMapQueryFunc = [this](const FVector3d& Position, const FIndexedWeightMap& WeightMap) { return WeightMapQuery(Position, WeightMap);	};
-	//hide target
-	Target->SetVisibility(false);
+	//hide target while the preview is shown
+	if (DynamicMeshComponent)
+	{
+		Target->SetVisibility(false);
+	}
 
-	constexpr int MaxTriangles = 3000000;
-	double NumTriangles = OriginalMesh.MaxTriangleID();
-	int MaxSubdivisions = (int)(FMath::Sqrt(MaxTriangles/NumTriangles) - 1);
+	// Without bClampToBudget a result over the budget is converted in clusters, one input triangle still has to fit
+	// in a cluster and the whole result in one mesh description
+	const int32 MaxSubdivisions = bClampToBudget
+		? FMath::Max(FDpUniformTessellate::MaxTessellationNum(OriginalMesh, TriangleBudget), 0)
+		: FMath::Max(FMath::Min(FDpUniformTessellate::MaxTessellationNum(OriginalMesh, FDpUniformTessellate::MaxResultTriangles), 
+			FDpUniformTessellate::MaxChunkTessellationNum(TriangleBudget)), 0);
 
 	//use Texel count as subdivisions;
 	int Subdivisions;
@@ -1384,6 +2625,14 @@ void FDpMeshOptional::StartOptional()
 		Subdivisions=DpTexture->GetImportedSize().Y;
 	}
 	
+	// uniform tessellation generates (Subdivisions+1)^2 triangles per triangle, keep it within the limits too
+	Subdivisions = FMath::Min(Subdivisions, MaxSubdivisions);
+	Parameters->bAdaptiveTessellation = bAdaptiveTessellation;
+	Parameters->TriangleBudget = TriangleBudget;
+	Parameters->bClampToBudget = bClampToBudget;
+	Parameters->bUseTessellationCheckpoint = bUseTessellationCheckpoint;
+	Parameters->bKeepDisplacementCache = bKeepPreview && DynamicMeshComponent != nullptr;
+	
 	TextureAspect=(float)DpTexture->GetImportedSize().X / (float)DpTexture->GetImportedSize().Y;
 
 
@@ -1393,17 +2642,30 @@ void FDpMeshOptional::StartOptional()
 		//												,EDisplaceMeshToolSubdivisionType::PNTriangles,4096,ActiveWeightMap);
 	//Subdivider = MakeUnique<FSubdivideMeshOpFactory>(OriginalMesh, EDisplaceMeshToolSubdivisionType::PNTriangles, 4096, ActiveWeightMap);
 
-	UMaterialInterface* Material = LoadObject<UMaterial>(nullptr, TEXT("/MeshModelingToolsetExp/Materials/InProgressMaterial"));
-	DynamicMeshComponent->SetOverrideRenderMaterial(Material);
-	
-	if(bNeedsDisplaced)
+	if (DynamicMeshComponent)
 	{
-		TSharedPtr<FDpMeshOptional> WarpPtr(this);
-		 DisplaceMeshTask=new FDisplaceMeshThread (WarpPtr,&OriginalMesh, Parameters,  EDisplaceMeshToolDisplaceType::DisplacementMap
-													   ,EDisplaceMeshToolSubdivisionType::PNTriangles,Subdivisions,ActiveWeightMap);
-		FRunnableThread::Create(DisplaceMeshTask,TEXT("DpDisplaceTask"));
+		UMaterialInterface* Material = LoadObject<UMaterial>(nullptr, TEXT("/MeshModelingToolsetExp/Materials/InProgressMaterial"));
+		DynamicMeshComponent->SetOverrideRenderMaterial(Material);
 	}
 	
+	DisplaceMeshTask=new FDisplaceMeshThread (AsShared(),&OriginalMesh, Parameters,  EDisplaceMeshToolDisplaceType::DisplacementMap
+												   ,EDisplaceMeshToolSubdivisionType::PNTriangles,Subdivisions,ActiveWeightMap,PNControlPointCache);
+	DisplaceMeshTask->ReadDisplaceMapIfGameThreadOnly();
+	return true;
+}
+
+void FDpMeshOptional::ComputeConversion(FProgressCancel* Progress)
+{
+	check(DisplaceMeshTask != nullptr);
+	DisplaceMeshTask->CalculateResult(Progress);
+}
+
+void FDpMeshOptional::ReleaseConversion()
+{
+	// the task may hold the last reference to this, do not touch members after deleting it
+	DisplaceMeshToolLocals::FDisplaceMeshThread* Task = DisplaceMeshTask;
+	DisplaceMeshTask = nullptr;
+	delete Task;
 }
 
 void FDpMeshOptional::UpdateActiveWeightMap()
@@ -1429,49 +2691,191 @@ void FDpMeshOptional::UpdateActiveWeightMap()
 
 void FDpMeshOptional::StartComputation()
 {
+	using namespace DisplaceMeshToolLocals;
+	check(IsInGameThread());
+	check(DisplaceMeshTask != nullptr && DisplaceTask == nullptr);
+
+	ConversionProgress.EnterStage(EDpConversionStage::Queued);
+	LastLoggedStage = EDpConversionStage::Queued;
+
+	// the task owns the displace thread from here on, so a cancelled task can be deleted without waiting for it here
+	DisplaceTask = new FAsyncTaskExecuterWithAbort<TModelingOpTask<FDynamicMeshOperator>>(MakeUnique<FDisplaceMeshTaskOp>(DisplaceMeshTask));
+	DisplaceMeshTask = nullptr;
+	DisplaceTask->StartBackgroundTask();
+	bNeedsDisplaced = false;
+
+	// the ticker does not keep the optional alive, it is removed once the optional is gone
+	TWeakPtr<FDpMeshOptional> WeakThis = AsShared();
+	ComputationTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakThis](float)
+	{
+		const TSharedPtr<FDpMeshOptional> This = WeakThis.Pin();
+		return This.IsValid() && This->AdvanceComputation();
+	}));
+}
+
+bool FDpMeshOptional::AdvanceComputation()
+{
+	check(IsInGameThread());
+	if (DisplaceTask == nullptr)
+	{
+		return false;
+	}
 
-	// if ( bNeedsSubdivided )
-	// {
-	// 	if (SubdivideTask)
-	// 	{
-	// 		SubdivideTask->CancelAndDelete();
-	// 	}
-	// 	SubdividedMesh = nullptr;
-	// 	SubdivideTask = new FAsyncTaskExecuterWithAbort<TModelingOpTask<FDynamicMeshOperator>>(Subdivider->MakeNewOperator());
-	// 	SubdivideTask->StartBackgroundTask();
-	// 	bNeedsSubdivided = false;
-	// 	DynamicMeshComponent->SetOverrideRenderMaterial(Material);
-	// }
-	// if (bNeedsDisplaced && DisplaceTask)
-	// {
-	// 	DisplaceTask->CancelAndDelete();
-	// 	DisplaceTask = nullptr;
-	// 	DynamicMeshComponent->SetOverrideRenderMaterial(Material);
-	// }
-	
-	AdvanceComputation();
+	const EDpConversionStage Stage = ConversionProgress.GetStage();
+	if (Stage != LastLoggedStage)
+	{
+		LastLoggedStage = Stage;
+		UE_LOG(LogTemp,Warning,TEXT("2K_DpRA Converting %s: %s, %d%%"), *Target->GetName(),
+			FDpConversionProgress::GetStageName(Stage), FMath::RoundToInt(ConversionProgress.GetCompletedFraction() * 100.0f));
+	}
+
+	if (DisplaceTask->IsDone() == false)
+	{
+		return true;
+	}
+
+	// the task holds the last reference to this, delete it only once the result has been dealt with
+	FAsyncTaskExecuterWithAbort<TModelingOpTask<FDynamicMeshOperator>>* Task = DisplaceTask;
+	DisplaceTask = nullptr;
+	ComputationTickerHandle.Reset();
+
+	if (ConversionProgress.GetStage() == EDpConversionStage::Commit)
+	{
+		// the preview shows one mesh, a result in clusters is committed right away
+		if (bKeepPreview && DynamicMeshComponent && ReMeshClusters.Num() == 0)
+		{
+			ShowResultInPreview();
+		}
+		else
+		{
+			SaveMeshToStaticMesh();
+		}
+	}
+	else
+	{
+		UE_LOG(LogTemp,Warning,TEXT("2K_DpRA Conversion of %s %s"), *Target->GetName(), FDpConversionProgress::GetStageName(ConversionProgress.GetStage()));
+		RestoreTarget();
+	}
+
+	delete Task;
+	// returning false removes the ticker
+	return false;
 }
 
+void FDpMeshOptional::CancelConversion()
+{
+	check(IsInGameThread());
+	if (DisplaceTask == nullptr)
+	{
+		return;
+	}
+
+	FTSTicker::GetCoreTicker().RemoveTicker(ComputationTickerHandle);
+	ComputationTickerHandle.Reset();
+	UE_LOG(LogTemp,Warning,TEXT("2K_DpRA Conversion of %s cancelled during %s"), *Target->GetName(), FDpConversionProgress::GetStageName(ConversionProgress.GetStage()));
+	RestoreTarget();
+
+	// a deleter task waits for the worker to notice the abort flag and deletes the task, which releases this
+	FAsyncTaskExecuterWithAbort<TModelingOpTask<FDynamicMeshOperator>>* Task = DisplaceTask;
+	DisplaceTask = nullptr;
+	Task->CancelAndDelete();
+}
 
+void FDpMeshOptional::ShowResultInPreview()
+{
+	check(IsInGameThread());
+	DynamicMeshComponent->ClearOverrideRenderMaterial();
+	// hand the result over instead of copying it, the displacement cache indexes its vertices
+	DynamicMeshComponent->SetMesh(MoveTemp(ReMesh));
+	bResultInPreview = true;
+	bPreviewNormalsStale = false;
+}
 
-void FDpMeshOptional::AdvanceComputation()
+bool FDpMeshOptional::UpdateDisplacement()
 {
 	using namespace DisplaceMeshToolLocals;
+	check(IsInGameThread());
+	if (!bResultInPreview || !DisplacementCache.IsValid() || DynamicMeshComponent == nullptr)
+	{
+		return false;
+	}
 
-	// if (bNeedsDisplaced)
-	// {
-	// 	// force update of contrast curve
-	// 	//FDisplaceMeshOpFactory* DisplacerDownCast = static_cast<FDisplaceMeshOpFactory*>(Displacer.Get());
-	// 	//DisplacerDownCast->SetAdjustmentCurve(TextureMapProperties->bApplyAdjustmentCurve ? TextureMapProperties->AdjustmentCurve : nullptr);
-	//
-	// 	DisplaceTask = new FAsyncTaskExecuterWithAbort<TModelingOpTask<FDynamicMeshOperator>>(
-	// 		Displacer->MakeNewOperator());
-	// 	DisplaceTask->StartBackgroundTask();
-	// 	bNeedsDisplaced = false;
-	// }
-	
-	
+	FDisplacementCache& Cache = *DisplacementCache;
+	const bool bUVTransformChanged = Cache.UVScale != UVScale || Cache.UVOffset != UVOffset;
+	if (bUVTransformChanged && Cache.bTopologyFollowsUVs)
+	{
+		// the culled triangles, or where the tessellation is refined, follow the UV transform
+		return false;
+	}
+
+	double StartTime = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
+	Cache.Intensity = DisplaceIntensity;
+	Cache.BaseValue = DisplacementMapBaseValue;
+	Cache.UVScale = UVScale;
+	Cache.UVOffset = UVOffset;
+	Cache.AdjustmentCurve = AdjustmentCurve;
+	RedisplacePreview(Cache, *DynamicMeshComponent);
+	// normals are only recomputed on commit, scrubbing would spend most of its time there
+	bPreviewNormalsStale = Cache.bRecalculateNormals;
+	double EndTime = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
+
+	UE_LOG(LogTemp,Warning,TEXT("2K_DpRA Re-displacement of %d vertices consuming：%f"), DisplacementCache->BasePositions.Num(), EndTime-StartTime);
+	return true;
+}
+
+bool FDpMeshOptional::UpdateDisplacement(float Intensity, float BaseValue, const FVector2f& InUVScale, const FVector2f& InUVOffset)
+{
+	DisplaceIntensity = Intensity;
+	DisplacementMapBaseValue = BaseValue;
+	UVScale = InUVScale;
+	UVOffset = InUVOffset;
+	return UpdateDisplacement();
+}
+
+void FDpMeshOptional::SetKeepPreview(bool bKeep)
+{
+	check(IsInGameThread());
+	bKeepPreview = bKeep;
+	if (bKeepPreview == false && bResultInPreview)
+	{
+		CommitPreview();
+	}
+}
 
+void FDpMeshOptional::CommitPreview()
+{
+	check(IsInGameThread());
+	if (!bResultInPreview)
+	{
+		return;
+	}
+
+	if (bPreviewNormalsStale)
+	{
+		DisplaceMeshToolLocals::ComputeDisplacement::RecalculateNormals(*DynamicMeshComponent->GetMesh());
+		bPreviewNormalsStale = false;
+	}
+	DisplacementCache.Reset();
+	SaveMeshToStaticMesh();
+	bResultInPreview = false;
+}
+
+void FDpMeshOptional::RestoreTarget()
+{
+	DisplacementCache.Reset();
+	bResultInPreview = false;
+	if (DynamicMeshComponent)
+	{
+		DynamicMeshComponent->UnregisterComponent();
+		DynamicMeshComponent->DestroyComponent();
+		DynamicMeshComponent = nullptr;
+	}
+	if (PreviewMeshActor != nullptr)
+	{
+		PreviewMeshActor->Destroy();
+		PreviewMeshActor = nullptr;
+	}
+	Target->SetVisibility(true);
 }
 
 void FDpMeshOptional::SaveMeshToStaticMesh()
@@ -1480,10 +2884,24 @@ void FDpMeshOptional::SaveMeshToStaticMesh()
 
 	FString Msg=TEXT("Converting Mesh To Nanite...");
 	FScopedSlowTask SlowTask(100, FText::FromString(Msg));
+	double CommitStartTime = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
 	
-	DynamicMeshComponent->ClearOverrideRenderMaterial();
-	DynamicMeshComponent->GetMesh()->Copy(ReMesh);
-	DynamicMeshComponent->NotifyMeshUpdated();
+	const FDynamicMesh3* ResultMesh = &ReMesh;
+	if (DynamicMeshComponent && ReMeshClusters.Num() == 0)
+	{
+		if (!bResultInPreview)
+		{
+			DynamicMeshComponent->ClearOverrideRenderMaterial();
+			// hand the result over instead of copying it, it is not needed here any more
+			DynamicMeshComponent->SetMesh(MoveTemp(ReMesh));
+		}
+		ResultMesh = DynamicMeshComponent->GetMesh();
+	}
+	Report.ResultTriangleCount = ResultMesh->TriangleCount();
+	for (const FDynamicMesh3& Cluster : ReMeshClusters)
+	{
+		Report.ResultTriangleCount += Cluster.TriangleCount();
+	}
 
 	Target->SetVisibility(true);
 	FTransform OriginTransform=Target->GetComponentTransform();
@@ -1493,23 +2911,48 @@ void FDpMeshOptional::SaveMeshToStaticMesh()
 	Component->Mobility=EComponentMobility::Static;
 	UStaticMesh* StaticMesh = Component->GetStaticMesh();
 	FMeshDescription* FoundMeshDescription = nullptr;
-	FConversionToMeshDescriptionOptions ConversionOptions;
-	ConversionOptions.bSetPolyGroups = true;
-	ConversionOptions.bUpdatePositions = true;
-	ConversionOptions.bUpdateNormals = true;
-	ConversionOptions.bUpdateTangents = false;
-	ConversionOptions.bUpdateUVs = false;
-	ConversionOptions.bUpdateVtxColors = false;
-	ConversionOptions.bTransformVtxColorsSRGBToLinear = false;
-	FDynamicMeshToMeshDescription Converter(ConversionOptions);
 	FoundMeshDescription = StaticMesh->GetMeshDescription(0);
 	SlowTask.EnterProgressFrame(10);
 	
 	double StartTime = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
-	Converter.Convert(DynamicMeshComponent->GetMesh(), *FoundMeshDescription);
+	if (ReMeshClusters.Num() > 0)
+	{
+		// appended one cluster at a time, each is released once written, the result never exists as one FDynamicMesh3
+		Report.InstanceTime = Report.TopologyTime = Report.AttributeTime = 0;
+		for (int32 Index = 0; Index < ReMeshClusters.Num(); ++Index)
+		{
+			UE::MeshDescription::FParallelConversionTimings Timings;
+			UE::MeshDescription::ConvertDynamicMeshParallel(ReMeshClusters[Index], *FoundMeshDescription, true, &Timings, Index > 0);
+			Report.InstanceTime += Timings.InstanceTime;
+			Report.TopologyTime += Timings.TopologyTime;
+			Report.AttributeTime += Timings.AttributeTime;
+			ReMeshClusters[Index].Clear();
+		}
+		ReMeshClusters.Empty();
+	}
+	else if (bParallelMeshDescription)
+	{
+		UE::MeshDescription::FParallelConversionTimings Timings;
+		UE::MeshDescription::ConvertDynamicMeshParallel(*ResultMesh, *FoundMeshDescription, true, &Timings);
+		Report.InstanceTime = Timings.InstanceTime;
+		Report.TopologyTime = Timings.TopologyTime;
+		Report.AttributeTime = Timings.AttributeTime;
+	}
+	else
+	{
+		FConversionToMeshDescriptionOptions ConversionOptions;
+		ConversionOptions.bSetPolyGroups = true;
+		ConversionOptions.bUpdatePositions = true;
+		ConversionOptions.bUpdateNormals = true;
+		ConversionOptions.bUpdateTangents = false;
+		ConversionOptions.bUpdateUVs = false;
+		ConversionOptions.bUpdateVtxColors = false;
+		ConversionOptions.bTransformVtxColorsSRGBToLinear = false;
+		FDynamicMeshToMeshDescription Converter(ConversionOptions);
+		Converter.Convert(ResultMesh, *FoundMeshDescription);
+	}
 	double EndTime = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
-	
-	UE_LOG(LogTemp,Warning,TEXT("2K_DpRA FDynamicMeshToMeshDescription::Convert consuming：%f"),EndTime-StartTime);
+	Report.MeshDescriptionTime = EndTime - StartTime;
 	
 	SlowTask.EnterProgressFrame(20);
 
@@ -1526,9 +2969,13 @@ void FDpMeshOptional::SaveMeshToStaticMesh()
 	FStaticMeshSourceModel& ThisSourceModel = StaticMesh->GetSourceModel(0);
 	ThisSourceModel.ReductionSettings.PercentTriangles = 1.f;
 	ThisSourceModel.ReductionSettings.PercentVertices = 1.f;
-	DynamicMeshComponent->UnregisterComponent();
-	DynamicMeshComponent->DestroyComponent();
-	DynamicMeshComponent = nullptr;
+	if (DynamicMeshComponent)
+	{
+		DynamicMeshComponent->UnregisterComponent();
+		DynamicMeshComponent->DestroyComponent();
+		DynamicMeshComponent = nullptr;
+	}
+	ReMesh.Clear();
 	StaticMesh->MarkPackageDirty();
 	//StaticMesh->OnMeshChanged.Broadcast();
 	SlowTask.EnterProgressFrame(20);
@@ -1537,21 +2984,106 @@ void FDpMeshOptional::SaveMeshToStaticMesh()
 
 	double EndTime1 = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
 
-	UE_LOG(LogTemp,Warning,TEXT("2K_DpRA StaticMesh Build to nanite consuming：%f"),EndTime1-StartTime1);
+	Report.BuildTime = EndTime1 - StartTime1;
+	Report.CommitTime = EndTime1 - CommitStartTime;
+	Report.Log(StaticMesh->GetName());
+	FDpConversionProgress::RecordStageTimes(Report);
 	
 	if (PreviewMeshActor != nullptr)
 	{
 		PreviewMeshActor->Destroy();
 		PreviewMeshActor = nullptr;
 	}
+	ConversionProgress.EnterStage(EDpConversionStage::Done);
+}
+
+namespace
+{
+	/** Running average of the stage times of the finished conversions, weights the progress of the next ones */
+	struct FDpStageTimeHistory
+	{
+		static constexpr int32 NumStages = (int32)EDpConversionStage::Done;
+
+		FCriticalSection Lock;
+		double AverageTime[NumStages] = {};
+		int32 NumConversions = 0;
+
+		static FDpStageTimeHistory& Get()
+		{
+			static FDpStageTimeHistory History;
+			return History;
+		}
+	};
+}
+
+float FDpConversionProgress::GetCompletedFraction() const
+{
+	const EDpConversionStage CurrentStage = GetStage();
+	if (CurrentStage >= EDpConversionStage::Done)
+	{
+		return 1.0f;
+	}
+
+	FDpStageTimeHistory& History = FDpStageTimeHistory::Get();
+	FScopeLock ScopeLock(&History.Lock);
+	double Completed = 0.0, Total = 0.0;
+	for (int32 StageIndex = (int32)EDpConversionStage::Decode; StageIndex < FDpStageTimeHistory::NumStages; ++StageIndex)
+	{
+		// until a conversion has finished, every stage after the decode counts the same
+		const double Weight = History.NumConversions > 0 ? History.AverageTime[StageIndex] : (StageIndex > (int32)EDpConversionStage::Decode ? 1.0 : 0.0);
+		Total += Weight;
+		Completed += StageIndex < (int32)CurrentStage ? Weight : 0.0;
+	}
+	return Total > 0.0 ? (float)(Completed / Total) : 0.0f;
+}
+
+void FDpConversionProgress::RecordStageTimes(const FDpConversionReport& Report)
+{
+	double StageTimes[FDpStageTimeHistory::NumStages] = {};
+	// the decode overlaps the subdivision, only the time waited for it delays the conversion
+	StageTimes[(int32)EDpConversionStage::Tessellate] = Report.SubdivisionTime + Report.CheckpointTime + Report.DecodeWaitTime;
+	StageTimes[(int32)EDpConversionStage::Displace] = Report.DisplaceTime;
+	StageTimes[(int32)EDpConversionStage::Cull] = Report.CullTime;
+	StageTimes[(int32)EDpConversionStage::Commit] = Report.CommitTime;
+
+	FDpStageTimeHistory& History = FDpStageTimeHistory::Get();
+	FScopeLock ScopeLock(&History.Lock);
+	// average over the last few conversions, so it follows the size of the meshes being converted
+	History.NumConversions = FMath::Min(History.NumConversions + 1, 8);
+	for (int32 StageIndex = 0; StageIndex < FDpStageTimeHistory::NumStages; ++StageIndex)
+	{
+		History.AverageTime[StageIndex] += (StageTimes[StageIndex] - History.AverageTime[StageIndex]) / History.NumConversions;
+	}
+}
 
-	if(DisplaceMeshTask)
+const TCHAR* FDpConversionProgress::GetStageName(EDpConversionStage Stage)
+{
+	switch (Stage)
 	{
-		delete DisplaceTask;
-		DisplaceTask=nullptr;
+	case EDpConversionStage::Queued: return TEXT("queued");
+	case EDpConversionStage::Decode: return TEXT("decoding");
+	case EDpConversionStage::Tessellate: return TEXT("tessellating");
+	case EDpConversionStage::Displace: return TEXT("displacing");
+	case EDpConversionStage::Cull: return TEXT("culling");
+	case EDpConversionStage::Commit: return TEXT("committing");
+	case EDpConversionStage::Done: return TEXT("done");
+	case EDpConversionStage::Cancelled: return TEXT("cancelled");
+	case EDpConversionStage::Failed: return TEXT("failed");
+	default: return TEXT("unknown");
 	}
 }
 
+void FDpConversionReport::Log(const FString& AssetName) const
+{
+	UE_LOG(LogTemp, Warning, TEXT("2K_DpRA Conversion report %s: %d triangles"), *AssetName, ResultTriangleCount);
+	UE_LOG(LogTemp, Warning, TEXT("2K_DpRA   subdivision %f ms, checkpoint %s %f ms, decode %f ms (%f ms overlapped with subdivision, %f ms waited for)"),
+		SubdivisionTime, bCheckpointHit ? TEXT("load") : TEXT("save"), CheckpointTime, DecodeTime, DecodeOverlapTime, DecodeWaitTime);
+	UE_LOG(LogTemp, Warning, TEXT("2K_DpRA   displace %f ms, cull %f ms"), DisplaceTime, CullTime);
+	UE_LOG(LogTemp, Warning, TEXT("2K_DpRA   mesh description %f ms (instances %f ms, topology %f ms, attributes %f ms), nanite build %f ms, commit total %f ms"),
+		MeshDescriptionTime, InstanceTime, TopologyTime, AttributeTime, BuildTime, CommitTime);
+	FDpTessellationCache::Get().LogStats();
+}
+
 float FDpMeshOptional::WeightMapQuery(const FVector3d& Position, const FIndexedWeightMap& WeightMap) const
 {
 	double NearDistSqr;
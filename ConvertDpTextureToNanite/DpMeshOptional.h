@@ -6,11 +6,21 @@
 #include "GeometryFramework/Public/Components/DynamicMeshComponent.h"
 #include "Spatial/SampledScalarField2.h"
 #include "Util/ProgressCancel.h"
+#include "Containers/Ticker.h"
+#include <atomic>
 
 
 using namespace  UE::Geometry;
 class FDynamicMeshOperator;
 
+namespace UE
+{
+namespace Geometry
+{
+	class FDpPNControlPointCache;
+}
+}
+
 
 class FAbortableBackgroundTask : public FNonAbandonableTask
 {
@@ -155,18 +165,145 @@ public:
 namespace  DisplaceMeshToolLocals
 {
 	class FDisplaceMeshThread;
+	struct FDisplacementCache;
 }
 
 
-class FDpMeshOptional
+/** Stages of a conversion, in the order they run */
+enum class EDpConversionStage : uint8
+{
+	Queued,
+	Decode,
+	Tessellate,
+	Displace,
+	Cull,
+	/** Computed, waiting for the game thread to commit the result to the static mesh */
+	Commit,
+	Done,
+	Cancelled,
+	Failed
+};
+
+struct FDpConversionReport;
+
+/** Current stage of a conversion. Written by whichever thread runs the stage, polled from the game thread. */
+struct FDpConversionProgress
+{
+	void EnterStage(EDpConversionStage StageIn)
+	{
+		Stage.store(StageIn, std::memory_order_release);
+	}
+
+	EDpConversionStage GetStage() const
+	{
+		return Stage.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * @return fraction of the whole conversion done before the current stage, weighted by the average stage times 
+	 * of the last conversions (see RecordStageTimes), or evenly before any has finished
+	 */
+	float GetCompletedFraction() const;
+
+	/** Add the stage times of a finished conversion to the averages GetCompletedFraction() uses */
+	static void RecordStageTimes(const FDpConversionReport& Report);
+
+	static const TCHAR* GetStageName(EDpConversionStage Stage);
+
+private:
+	std::atomic<EDpConversionStage> Stage{ EDpConversionStage::Queued };
+};
+
+/** Stage timings of one conversion, in milliseconds. Logged once the converted mesh has been committed. */
+struct FDpConversionReport
+{
+	/** Texture decode into the displacement/cull fields */
+	double DecodeTime = 0;
+	/** Part of DecodeTime that ran concurrently with subdivision, i.e. latency hidden from the conversion */
+	double DecodeOverlapTime = 0;
+	/** Time subdivision had finished but the worker still had to wait for the decode */
+	double DecodeWaitTime = 0;
+	double SubdivisionTime = 0;
+	/** Reading or writing the tessellation checkpoint */
+	double CheckpointTime = 0;
+	/** Tessellation was loaded from a checkpoint, SubdivisionTime is zero */
+	bool bCheckpointHit = false;
+	/** Sampling the displacement and moving the vertices */
+	double DisplaceTime = 0;
+	/** Removing the culled triangles and compacting the mesh */
+	double CullTime = 0;
+	/** FDynamicMesh3 to FMeshDescription conversion, and its stages when the parallel writer is used */
+	double MeshDescriptionTime = 0;
+	double InstanceTime = 0;
+	double TopologyTime = 0;
+	double AttributeTime = 0;
+	/** CommitMeshDescription and the nanite build in PostEditChange */
+	double BuildTime = 0;
+	/** Game thread time spent writing the result back to the static mesh and building it */
+	double CommitTime = 0;
+	int32 ResultTriangleCount = 0;
+
+	void Log(const FString& AssetName) const;
+};
+
+/**
+ * Converts one displacement textured mesh to nanite. Must be owned by a TSharedPtr/TSharedRef (see Launch): the
+ * displace task holds a reference to the optional until it is released.
+ */
+class FDpMeshOptional : public TSharedFromThis<FDpMeshOptional>
 {
 public:
 	FDpMeshOptional(UMeshComponent* OpTarget,UTexture2D* Texture);
 	~FDpMeshOptional();
+
+	/**
+	 * Create an optional and start its conversion with a preview, must be called on the game thread.
+	 * @param bKeepResultInPreview see SetKeepPreview, the caller then has to keep the returned optional to commit it
+	 */
+	static TSharedRef<FDpMeshOptional> Launch(UMeshComponent* OpTarget, UTexture2D* Texture, bool bKeepResultInPreview = false);
+
 	void StartOptional();
+	/**
+	 * Game thread part of a conversion: read the source mesh and create the displace task, without starting it.
+	 * The task keeps a reference to this optional until ReleaseConversion.
+	 * @param bWithPreview spawn a preview actor and hide the target while the conversion runs
+	 * @return false if the target is not a static mesh component or there is no texture
+	 */
+	bool PrepareConversion(bool bWithPreview);
+	/** Tessellate and displace on the calling thread. PrepareConversion must have succeeded. */
+	void ComputeConversion(FProgressCancel* Progress = nullptr);
+	/** Delete the displace task created by PrepareConversion, dropping its reference to this optional */
+	void ReleaseConversion();
 	void UpdateActiveWeightMap();
+	/** Run the conversion prepared by PrepareConversion as an abortable background task, committed by AdvanceComputation */
 	void StartComputation();
-	void AdvanceComputation();
+	/** Game thread poll of the background task, commits its result once done. @return true while the task is running */
+	bool AdvanceComputation();
+	/**
+	 * Abort the background task and restore the target. The task stops at its next cancellation check, it then
+	 * drops its reference to this optional, which may be the last one.
+	 */
+	void CancelConversion();
+	/** Remove the preview and show the target again */
+	void RestoreTarget();
+	/** Move the computed result into the preview component, where UpdateDisplacement can edit it */
+	void ShowResultInPreview();
+	/**
+	 * Re-displace the previewed result with the current DisplaceIntensity, DisplacementMapBaseValue, AdjustmentCurve
+	 * and UV transform, reusing its tessellation, normals and UV samples, and push the positions to the preview.
+	 * @return false if the change needs a new conversion: there is no previewed result, or the UV transform changed
+	 * and it decides which triangles are culled or where the tessellation is refined
+	 */
+	bool UpdateDisplacement();
+	/** Set the displacement parameters and UpdateDisplacement(), e.g. while a slider is dragged */
+	bool UpdateDisplacement(float Intensity, float BaseValue, const FVector2f& InUVScale, const FVector2f& InUVOffset);
+	/**
+	 * Keep the next computed result in the preview instead of committing it, for UpdateDisplacement and
+	 * CommitPreview. Takes effect from the next PrepareConversion. Turning it off commits a previewed result.
+	 */
+	void SetKeepPreview(bool bKeep);
+	/** Commit the previewed result to the static mesh */
+	void CommitPreview();
 	void SaveMeshToStaticMesh();
 	float WeightMapQuery(const FVector3d& Position, const FIndexedWeightMap& WeightMap) const;
 
@@ -186,7 +323,55 @@ public:
 	FAsyncTaskExecuterWithAbort<TModelingOpTask<FDynamicMeshOperator>>* DisplaceTask = nullptr;
 	//bool bNeedsSubdivided = true;
 	bool bNeedsDisplaced = true;
+	/** Displacement parameters, copied to the conversion by PrepareConversion and re-applied by UpdateDisplacement */
+	float DisplaceIntensity = 5.0f;
+	float DisplacementMapBaseValue = 128.0f/255;
+	FVector2f UVScale = FVector2f(1, 1);
+	FVector2f UVOffset = FVector2f(0, 0);
+	TSharedPtr<FRichCurve, ESPMode::ThreadSafe> AdjustmentCurve;
+	/** See SetKeepPreview. The caller has to keep the optional alive through its own TSharedPtr, see Launch. */
+	bool bKeepPreview = false;
+	bool bResultInPreview = false;
+	bool bPreviewNormalsStale = false;
+	TSharedPtr<DisplaceMeshToolLocals::FDisplacementCache> DisplacementCache;
+	/**
+	 * Save the tessellated mesh to the FDpTessellationCache (Saved/DpNanite/Checkpoints) before displacing it, and 
+	 * start from there when the source mesh and tessellation settings match, so that e.g. changing DisplaceIntensity
+	 * or the texture only re-runs the displacement. See DpNanite.TessellationCache for the hit rate and size cap.
+	 * Off by default, the checkpoint writes the whole tessellated mesh to disk.
+	 */
+	bool bUseTessellationCheckpoint = false;
+	/**
+	 * Refine where the displacement map has detail instead of subdividing every triangle down to texel size. Off by 
+	 * default: it changes the output, waits for the texture decode before subdividing and refines serially.
+	 */
+	bool bAdaptiveTessellation = false;
+	/** 
+	 * Upper bound on the triangle count of each step of the conversion: of the converted mesh with adaptive 
+	 * tessellation or bClampToBudget, of each of its clusters otherwise.
+	 */
+	int32 TriangleBudget = 3000000;
+	/**
+	 * Lower the subdivision level until the converted mesh fits in TriangleBudget. Off by default: a result that does
+	 * not fit is tessellated, displaced and culled as clusters of at most TriangleBudget triangles, which are written
+	 * to the static mesh one after the other. The result is still limited to FDpUniformTessellate::MaxResultTriangles.
+	 */
+	bool bClampToBudget = false;
+	/** Write the mesh description with UE::MeshDescription::ConvertDynamicMeshParallel instead of FDynamicMeshToMeshDescription */
+	bool bParallelMeshDescription = true;
+	/** 
+	 * PN control points of OriginalMesh, kept for the lifetime of this optional so that converting it again (e.g. at 
+	 * another level or adaptively) reuses them. Handed to each displace task. Keyed on the source ID of the static 
+	 * mesh set by PrepareConversion.
+	 */
+	TSharedPtr<UE::Geometry::FDpPNControlPointCache, ESPMode::ThreadSafe> PNControlPointCache;
 	DisplaceMeshToolLocals::FDisplaceMeshThread* DisplaceMeshTask=nullptr;
 	FDynamicMesh3 ReMesh;
+	/** Result of a conversion over TriangleBudget, see bClampToBudget. ReMesh is empty then. Never previewed. */
+	TArray<FDynamicMesh3> ReMeshClusters;
 	float TextureAspect=1.0f;
+	FDpConversionReport Report;
+	FDpConversionProgress ConversionProgress;
+	EDpConversionStage LastLoggedStage = EDpConversionStage::Queued;
+	FTSTicker::FDelegateHandle ComputationTickerHandle;
 };
@@ -8,6 +8,8 @@
 #include "Async/ParallelFor.h"
 #include "Util/ProgressCancel.h"
 #include "DpUniformTessellate.h"
+#include "DpAdaptiveTessellate.h"
+#include "DpParallelNormals.h"
 
 using namespace UE::Geometry;
 
@@ -34,6 +36,7 @@ namespace FPNTrianglesLocals
 	{
 		TArray<FEdgeControlPoints> OnEdges; // Map edge ID to the edge control points
 		TArray<FTriangleControlPoint> OnTriangles; // Map triangle ID to the triangle center control point
+		TArray<FVector3f> CornerNormals; // 3 normals per triangle in GetTriangle() order, only with the normal component
 	};
 
 	/**
@@ -62,6 +65,10 @@ namespace FPNTrianglesLocals
 		// 2 control points per edge and one in the middle of each triangle.
 		OutControlPoints.OnEdges.SetNum(Mesh->MaxEdgeID());
 		OutControlPoints.OnTriangles.SetNum(Mesh->MaxTriangleID());
+		if (bComputePNNormals) 
+		{
+			OutControlPoints.CornerNormals.SetNum(Mesh->MaxTriangleID() * 3);
+		}
 
 		auto ComputeControlPoint = [](const FVector3d& Vertex1, const FVector3d& Vertex2, const FVector3f& Normal)
 		{ 
@@ -134,7 +141,9 @@ namespace FPNTrianglesLocals
 
 				if (bComputePNNormals)
 				{
+					// Both triangles share the normals unless the edge is a seam, then NormalTriB is set below
 					ControlPnts.NormalTriA = FVector3d(ComputeControlNormal(Vertex1, Vertex2, Normal1, Normal2));
+					ControlPnts.NormalTriB = ControlPnts.NormalTriA;
 				}
 
 				FVector3d Point1ForTriA = ComputeControlPoint(Vertex1, Vertex2, Normal1);
@@ -206,6 +215,28 @@ namespace FPNTrianglesLocals
 											Mesh->GetVertex(TriVertID.C))/3.0;
 
 				OutControlPoints.OnTriangles[TID] = ControlMidpoint + (ControlMidpoint - VertexMidpoint)/2.0;	
+
+				if (bComputePNNormals) 
+				{
+					// The normals at the corners, as seen by this triangle, i.e. its side of any normal seam
+					const FDynamicMeshNormalOverlay* NormalOverlay = Mesh->HasAttributes() ? Mesh->Attributes()->PrimaryNormals() : nullptr;
+					for (int Corner = 0; Corner < 3; ++Corner) 
+					{
+						FVector3f& Normal = OutControlPoints.CornerNormals[3*TID + Corner];
+						if (NormalOverlay != nullptr && NormalOverlay->IsSetTriangle(TID)) 
+						{
+							NormalOverlay->GetElementAtVertex(TID, TriVertID[Corner], Normal);
+						}
+						else if (NormalOverlay != nullptr) 
+						{
+							Normal = static_cast<FVector3f>(Mesh->GetTriNormal(TID));
+						}
+						else 
+						{
+							Normal = (UseNormals != nullptr) ? (FVector3f)(*UseNormals)[TriVertID[Corner]] : Mesh->GetVertexNormal(TriVertID[Corner]);
+						}
+					}
+				}
 			}
 		});
 
@@ -224,6 +255,8 @@ namespace FPNTrianglesLocals
 	 * 
 	 * @param Mesh The mesh we are tessellating.
 	 * @param Level How many times we are recursively subdividing the Mesh.
+	 * @param TriangleBudget Upper bound on the triangle count of the result.
+	 * @param bClampToBudget Lower Level until the result fits in TriangleBudget instead of failing.
 	 * @param ProgressCancel Set this to be able to cancel running operation.
 	 * @param OutNewVertices Array of tuples of the new vertex ID and the original triangle ID the vertex belongs to.
 	 * @param OutMesh Result of the tessellation.
@@ -232,6 +265,8 @@ namespace FPNTrianglesLocals
 	 */
 	bool TessellateMesh(const FDynamicMesh3& Mesh, 
 					   const int32 Level, 
+					   const int64 TriangleBudget,
+					   const bool bClampToBudget,
 					   FProgressCancel* ProgressCancel,
 					   TArray<FIndex2i>& OutNewVertices,
 					   FDynamicMesh3& OutMesh) 
@@ -249,6 +284,8 @@ namespace FPNTrianglesLocals
 
 		FDpUniformTessellate Tessellator(&Mesh, &OutMesh);
 		Tessellator.TessellationNum = Level;
+		Tessellator.TriangleBudget = TriangleBudget;
+		Tessellator.bClampToBudget = bClampToBudget;
 		Tessellator.bComputeMappings = true;
 		if (Tessellator.Validate() != EOperationValidationResult::Ok)
 		{
@@ -260,25 +297,148 @@ namespace FPNTrianglesLocals
 			return false;
 		} 
 
-		const int32 NewVertCount = Tessellator.VertexEdgeMap.Num() + Tessellator.VertexTriangleMap.Num();
-		OutNewVertices.Reserve(NewVertCount);
+		const int32 FirstNewVertexID = Tessellator.GetFirstNewVertexID();
+		const int32 NewVertCount = Tessellator.GetEndNewVertexID() - FirstNewVertexID;
+		OutNewVertices.SetNumUninitialized(NewVertCount);
+		ParallelFor(NewVertCount, [&](int32 Index)
+		{
+			const int32 VertexID = FirstNewVertexID + Index;
+			OutNewVertices[Index] = FIndex2i(VertexID, Tessellator.GetNewVertexTriangle(VertexID));
+		});
+
+		checkSlow(OutNewVertices.Num() == NewVertCount);
 
-		for (auto It = Tessellator.VertexEdgeMap.CreateConstIterator(); It; ++It)
+		return true;
+	}
+
+	/** 
+	 * Adaptive variant of TessellateMesh, see FDpAdaptiveTessellate. 
+	 * 
+	 * @return true if the operation succeeded, false if it failed or was canceled by the user.
+	 */
+	bool TessellateMeshAdaptive(const FDynamicMesh3& Mesh, 
+								const TFunction<double(const FDynamicMesh3&, int32)>& EdgeError,
+								const double ErrorThreshold,
+								const int32 TriangleBudget,
+								FProgressCancel* ProgressCancel,
+								TArray<FIndex2i>& OutNewVertices,
+								FDynamicMesh3& OutMesh) 
+	{
+		FDpAdaptiveTessellate Tessellator(&Mesh, &OutMesh);
+		Tessellator.Progress = ProgressCancel;
+		Tessellator.EdgeError = EdgeError;
+		Tessellator.ErrorThreshold = ErrorThreshold;
+		Tessellator.TriangleBudget = TriangleBudget;
+		if (Tessellator.Validate() != EOperationValidationResult::Ok)
 		{
-			FIndex2i EdgeTri = It.Value();
-			OutNewVertices.Add(FIndex2i(It.Key(), EdgeTri.A));
+			return false;
 		}
 
-		for (auto It = Tessellator.VertexTriangleMap.CreateConstIterator(); It; ++It)
+		if (Tessellator.Compute() == false) 
 		{
-			OutNewVertices.Add(FIndex2i(It.Key(), It.Value()));
+			return false;
 		}
 
-		checkSlow(OutNewVertices.Num() == NewVertCount);
-
+		// Vertices are inserted by splitting edges at their midpoint, so they still lie in the plane of the original 
+		// triangle they are mapped to, which is what the displacement relies on
+		OutNewVertices = MoveTemp(Tessellator.NewVertices);
 		return true;
 	}
 
+	/** 
+	 * Evaluate the cubic Bezier patch of an original triangle.
+	 * 
+	 * @param OriginalMesh The original mesh (before tessellation).
+	 * @param ControlPoints PN Triangle control points of OriginalMesh.
+	 * @param TriangleID The original triangle.
+	 * @param Bary Barycentric coordinates in the original triangle, relative to its vertices in GetTriangle() order.
+	 */
+	FVector3d EvaluatePatch(const FDynamicMesh3& OriginalMesh, 
+							const FControlPoints& ControlPoints, 
+							const int32 TriangleID, 
+							const FVector3d& Bary)
+	{
+		const FIndex3i TriVertex = OriginalMesh.GetTriangle(TriangleID);
+		const FIndex3i TriEdges = OriginalMesh.GetTriEdges(TriangleID);
+		const FVector3d BarySquared = Bary*Bary;
+
+		// Displaced vertex. First compute contribution of the original control points at the original vertices
+		FVector3d NewPos = Bary[0]*BarySquared[0]*OriginalMesh.GetVertexRef(TriVertex.A) + 
+						   Bary[1]*BarySquared[1]*OriginalMesh.GetVertexRef(TriVertex.B) + 
+						   Bary[2]*BarySquared[2]*OriginalMesh.GetVertexRef(TriVertex.C);
+		
+		// Compute contribution of the control points at the edges
+		for (int EIDX = 0; EIDX < 3; ++EIDX) 
+		{   
+			int EID = TriEdges[EIDX];
+			FIndex2i EdgeV = OriginalMesh.GetEdgeRef(EID).Vert;
+			const FEdgeControlPoints& ControlPnts = ControlPoints.OnEdges[EID];
+
+			// Check that the orientation of the edge is consistent so we use the correct barycentric values
+			int EdgeVtx1 = EdgeV[0];
+			int EdgeVtx2 = EdgeV[1];
+			IndexUtil::OrientTriEdgeAndFindOtherVtx(EdgeVtx1, EdgeVtx2, TriVertex);
+			
+			int BaryIdx1 = EdgeV[0] == EdgeVtx1 ? EIDX : (EIDX + 1) % 3;
+			int BaryIdx2 = EdgeV[0] == EdgeVtx1 ? (EIDX + 1) % 3 : EIDX;
+			
+			NewPos += (3.0*BarySquared[BaryIdx1]*Bary[BaryIdx2])*ControlPnts.Point1 + 
+					  (3.0*BarySquared[BaryIdx2]*Bary[BaryIdx1])*ControlPnts.Point2;
+		}
+
+		// Finally compute contribution of the single control point inside the triangle
+		NewPos += (6.0*Bary[0]*Bary[1]*Bary[2])*ControlPoints.OnTriangles[TriangleID];
+
+		return NewPos;
+	}
+
+	/** 
+	 * Evaluate the quadratic normal patch of an original triangle. On a seam edge the triangle uses the normal 
+	 * control point of its own side, so each side of the seam gets its own normals. ControlPoints must have been 
+	 * computed with the normal component.
+	 * 
+	 * @param Bary Barycentric coordinates in the original triangle, relative to its vertices in GetTriangle() order.
+	 */
+	FVector3f EvaluatePatchNormal(const FDynamicMesh3& OriginalMesh, 
+								  const FControlPoints& ControlPoints, 
+								  const int32 TriangleID, 
+								  const FVector3d& Bary)
+	{
+		const FIndex3i TriEdges = OriginalMesh.GetTriEdges(TriangleID);
+
+		// Compute contribution of the normal control points at the original vertices
+		FVector3d NewNormal = Bary[0]*Bary[0]*FVector3d(ControlPoints.CornerNormals[3*TriangleID]) + 
+							  Bary[1]*Bary[1]*FVector3d(ControlPoints.CornerNormals[3*TriangleID + 1]) + 
+							  Bary[2]*Bary[2]*FVector3d(ControlPoints.CornerNormals[3*TriangleID + 2]);
+
+		// Compute contribution of the normal control points at the edges
+		for (int EIDX = 0; EIDX < 3; ++EIDX) 
+		{   
+			const int EID = TriEdges[EIDX];
+			const FEdgeControlPoints& ControlPnts = ControlPoints.OnEdges[EID];
+			const FVector3d& EdgeNormal = OriginalMesh.GetEdgeT(EID).A == TriangleID ? ControlPnts.NormalTriA : ControlPnts.NormalTriB;
+			NewNormal += Bary[EIDX]*Bary[(EIDX + 1) % 3]*EdgeNormal;
+		}
+
+		Normalize(NewNormal);
+		return FVector3f(NewNormal);
+	}
+
+	/** 
+	 * Distance between Normal and the lerp of the corner normals of the triangle at Bary. Used to find which side of 
+	 * a seam an overlay element of the flat tessellation was interpolated from.
+	 */
+	double CornerNormalLerpDistance(const FControlPoints& ControlPoints, 
+									const int32 TriangleID, 
+									const FVector3d& Bary, 
+									const FVector3f& Normal)
+	{
+		const FVector3f Lerped = (float)Bary[0]*ControlPoints.CornerNormals[3*TriangleID] + 
+								 (float)Bary[1]*ControlPoints.CornerNormals[3*TriangleID + 1] + 
+								 (float)Bary[2]*ControlPoints.CornerNormals[3*TriangleID + 2];
+		return DistanceSquared(Normalized(Lerped), Normalized(Normal));
+	}
+
 	/** 
 	 * Displace the vertices created from the tessellation using the cubic patch formula based on their barycentric 
 	 * coordinates.
@@ -301,7 +461,7 @@ namespace FPNTrianglesLocals
 							   			FDynamicMesh3& Mesh)
 	{
 		bool bHasVertexNormals = Mesh.HasVertexNormals();
-		bool bHasAttributes = Mesh.HasAttributes();
+		FDynamicMeshNormalOverlay* NormalOverlay = Mesh.HasAttributes() ? Mesh.Attributes()->PrimaryNormals() : nullptr;
 		
 		// Iterate over every new vertex and compute its displacement and optionally a normal
 		ParallelFor(VerticesToDisplace.Num(), [&](int32 IDX)
@@ -321,35 +481,8 @@ namespace FPNTrianglesLocals
 
 			FVector3d Bary = VectorUtil::BarycentricCoords(Mesh.GetVertexRef(VertexID), OriginalMesh.GetVertexRef(TriVertex.A),
 														   OriginalMesh.GetVertexRef(TriVertex.B), OriginalMesh.GetVertexRef(TriVertex.C));
-														   
-			FVector3d BarySquared = Bary*Bary;
 
-			// Displaced vertex. First compute contribution of the original control points at the original vertices
-			FVector3d NewPos = Bary[0]*BarySquared[0]*OriginalMesh.GetVertexRef(TriVertex.A) + 
-							   Bary[1]*BarySquared[1]*OriginalMesh.GetVertexRef(TriVertex.B) + 
-							   Bary[2]*BarySquared[2]*OriginalMesh.GetVertexRef(TriVertex.C);
-			
-			// Compute contribution of the control points at the edges
-			for (int EIDX = 0; EIDX < 3; ++EIDX) 
-			{   
-				int EID = TriEdges[EIDX];
-				FIndex2i EdgeV = OriginalMesh.GetEdgeRef(EID).Vert;
-				const FEdgeControlPoints& ControlPnts = FControlPoints.OnEdges[EID];
-
-				// Check that the orientation of the edge is consistent so we use the correct barycentric values
-				int EdgeVtx1 = EdgeV[0];
-				int EdgeVtx2 = EdgeV[1];
-				IndexUtil::OrientTriEdgeAndFindOtherVtx(EdgeVtx1, EdgeVtx2, TriVertex);
-				
-				int BaryIdx1 = EdgeV[0] == EdgeVtx1 ? EIDX : (EIDX + 1) % 3;
-				int BaryIdx2 = EdgeV[0] == EdgeVtx1 ? (EIDX + 1) % 3 : EIDX;
-				
-				NewPos += (3.0*BarySquared[BaryIdx1]*Bary[BaryIdx2])*ControlPnts.Point1 + 
-						  (3.0*BarySquared[BaryIdx2]*Bary[BaryIdx1])*ControlPnts.Point2;
-			}
-
-			// Finally compute contribution of the single control point inside the triangle
-			NewPos += (6.0*Bary[0]*Bary[1]*Bary[2])*FControlPoints.OnTriangles[OriginalTriangleID];
+			const FVector3d NewPos = EvaluatePatch(OriginalMesh, FControlPoints, OriginalTriangleID, Bary);
 			
 			Mesh.SetVertex(VertexID, NewPos); 
 
@@ -357,27 +490,47 @@ namespace FPNTrianglesLocals
 			{
 				if (bHasVertexNormals) 
 				{
-					// Compute contribution of the normal control points at the original vertices
-					FVector3d NewNormal(BarySquared[0]*OriginalMesh.GetVertexNormal(TriVertex.A) + 
-										BarySquared[1]*OriginalMesh.GetVertexNormal(TriVertex.B) +
-										BarySquared[2]*OriginalMesh.GetVertexNormal(TriVertex.C));
-					
-					// Compute contribution of the normal control points at the edges
-					for (int EIDX = 0; EIDX < 3; ++EIDX) 
-					{   
-						int EID = TriEdges[EIDX];
-						const FEdgeControlPoints& ControlPnts = FControlPoints.OnEdges[EID];
-						NewNormal += Bary[EIDX]*Bary[(EIDX + 1) % 3]*ControlPnts.NormalTriA;
-					}
-
-					Normalize(NewNormal);
-
-					Mesh.SetVertexNormal(VertexID, FVector3f(NewNormal)); 
+					Mesh.SetVertexNormal(VertexID, EvaluatePatchNormal(OriginalMesh, FControlPoints, OriginalTriangleID, Bary)); 
 				} 
 				
-				if (bHasAttributes) 
+				if (NormalOverlay != nullptr) 
 				{
-					//TODO: Compute per-element quadractic PN normals
+					// A vertex on an original edge has one element per side if the edge is a seam. Find the original 
+					// triangle across that edge and the vertex coordinates in it.
+					int32 OtherTriangleID = FDynamicMesh3::InvalidID;
+					FVector3d OtherBary = FVector3d::Zero();
+					const int MinBaryIdx = Bary[0] < Bary[1] ? (Bary[0] < Bary[2] ? 0 : 2) : (Bary[1] < Bary[2] ? 1 : 2);
+					if (FMath::Abs(Bary[MinBaryIdx]) < FMathd::ZeroTolerance) 
+					{
+						const FIndex2i EdgeTri = OriginalMesh.GetEdgeT(TriEdges[(MinBaryIdx + 1) % 3]);
+						OtherTriangleID = EdgeTri.A == OriginalTriangleID ? EdgeTri.B : EdgeTri.A;
+						if (OtherTriangleID != FDynamicMesh3::InvalidID) 
+						{
+							const FIndex3i OtherTriVertex = OriginalMesh.GetTriangle(OtherTriangleID);
+							OtherBary[OtherTriVertex.IndexOf(TriVertex[(MinBaryIdx + 1) % 3])] = Bary[(MinBaryIdx + 1) % 3];
+							OtherBary[OtherTriVertex.IndexOf(TriVertex[(MinBaryIdx + 2) % 3])] = Bary[(MinBaryIdx + 2) % 3];
+						}
+					}
+
+					TArray<int> Elements;
+					NormalOverlay->GetVertexElements(VertexID, Elements);
+
+					for (const int ElementID : Elements) 
+					{
+						// Each element was interpolated from the corner normals of its side, evaluate it on that side
+						int32 SideTriangleID = OriginalTriangleID;
+						FVector3d SideBary = Bary;
+						if (OtherTriangleID != FDynamicMesh3::InvalidID && Elements.Num() > 1) 
+						{
+							const FVector3f Normal = NormalOverlay->GetElement(ElementID);
+							if (CornerNormalLerpDistance(FControlPoints, OtherTriangleID, OtherBary, Normal) < CornerNormalLerpDistance(FControlPoints, OriginalTriangleID, Bary, Normal)) 
+							{
+								SideTriangleID = OtherTriangleID;
+								SideBary = OtherBary;
+							}
+						}
+						NormalOverlay->SetElement(ElementID, EvaluatePatchNormal(OriginalMesh, FControlPoints, SideTriangleID, SideBary));
+					}
 				}
 			}
 		});
@@ -391,6 +544,25 @@ namespace FPNTrianglesLocals
 	}
 }
 
+FDpPNControlPointCache::FKey FDpPNControlPointCache::MakeKey(const FDynamicMesh3& Mesh, bool bWithPNNormals) const
+{
+	FKey NewKey;
+	if (SourceID.IsEmpty())
+	{
+		NewKey.Mesh = &Mesh;
+		NewKey.ShapeChangeStamp = Mesh.GetShapeChangeStamp();
+		NewKey.TopologyChangeStamp = Mesh.GetTopologyChangeStamp();
+	}
+	else
+	{
+		NewKey.SourceID = SourceID;
+	}
+	NewKey.MaxVertexID = Mesh.MaxVertexID();
+	NewKey.MaxTriangleID = Mesh.MaxTriangleID();
+	NewKey.bHasPNNormals = bWithPNNormals;
+	return NewKey;
+}
+
 bool DpFPNTriangles::Compute()
 {
 	using namespace FPNTrianglesLocals;
@@ -398,72 +570,165 @@ bool DpFPNTriangles::Compute()
 	check(TessellationLevel >= 0);
 	check(Mesh != nullptr);
 
-	if (TessellationLevel < 0 || Mesh == nullptr) 
+	// Every failure leaves OutMesh empty rather than holding a stale or partial result, Mesh is never touched
+	auto Fail = [this]()
 	{
+		if (OutMesh != nullptr)
+		{
+			OutMesh->Clear();
+		}
 		return false;
+	};
+
+	if (TessellationLevel < 0 || Mesh == nullptr || (OutMesh == nullptr && MeshToReplace == nullptr)) 
+	{
+		return Fail();
 	}
 
-	if (TessellationLevel == 0) 
+	if (TessellationLevel == 0 && !AdaptiveEdgeError) 
 	{
+		if (OutMesh != nullptr)
+		{
+			OutMesh->Copy(*Mesh);
+		}
 		return true; // nothing to do
 	}
 
-	// Compute per-vertex normals if no normals exist
-	FMeshNormals Normals;
-	bool bHasNormals = Mesh->HasVertexNormals() || (Mesh->HasAttributes() && Mesh->Attributes()->PrimaryNormals() != nullptr);
-	if (bHasNormals == false)
+	// Quadratically varying normals are only needed if the mesh has normals to write them to
+	const bool bHasNormals = Mesh->HasVertexNormals() || (Mesh->HasAttributes() && Mesh->Attributes()->PrimaryNormals() != nullptr);
+	const bool bComputeNormals = bComputePNNormals && bHasNormals;
+
+	// Compute PN triangle control points for each flat triangle of the original mesh, or reuse the cached ones
+	TSharedPtr<const FControlPoints, ESPMode::ThreadSafe> ControlPoints;
+	FDpPNControlPointCache::FKey CacheKey;
+	if (ControlPointCache.IsValid()) 
 	{
-		Normals = FMeshNormals(Mesh);
-		Normals.ComputeVertexNormals();
+		FScopeLock ScopeLock(&ControlPointCache->Lock);
+		CacheKey = ControlPointCache->MakeKey(*Mesh, bComputeNormals);
+		if (ControlPointCache->ControlPoints.IsValid() && ControlPointCache->Key == CacheKey) 
+		{
+			ControlPoints = ControlPointCache->ControlPoints;
+			++ControlPointCache->NumHits;
+		}
 	}
-	FMeshNormals* UseNormals = (bHasNormals) ? nullptr : &Normals;
-	
-	// Compute PN triangle control points for each flat triangle of the original mesh
-	FControlPoints FControlPoints;
-
-	// TODO: We disable quadratically varying normal computation until we fully support seam normal overlay edges.
-	// We might remove them completely since using quadratically varying normals would imply that we should be using 
-	// the same approach when computing normals inside the shaders for lighting computations 
-	// (see Tessellation on Any Budget, GDC, 2011). 
-	const bool bComputePNNormals = false;
-	bool bOk = ComputeControlPoints(FControlPoints, Mesh, UseNormals, bComputePNNormals, Progress);
-	if (bOk == false) 
+
+	if (ControlPoints.IsValid() == false) 
 	{
-		return false;
+		// Compute per-vertex normals if no normals exist
+		FMeshNormals Normals;
+		if (bHasNormals == false)
+		{
+			Normals = FMeshNormals(Mesh);
+			FDpParallelNormals(Mesh).ComputeVertexNormals(Normals);
+		}
+		FMeshNormals* UseNormals = (bHasNormals) ? nullptr : &Normals;
+
+		TSharedPtr<FControlPoints, ESPMode::ThreadSafe> NewControlPoints = MakeShared<FControlPoints, ESPMode::ThreadSafe>();
+		if (ComputeControlPoints(*NewControlPoints, Mesh, UseNormals, bComputeNormals, Progress) == false) 
+		{
+			return Fail();
+		}
+		ControlPoints = NewControlPoints;
+
+		if (ControlPointCache.IsValid()) 
+		{
+			FScopeLock ScopeLock(&ControlPointCache->Lock);
+			ControlPointCache->ControlPoints = ControlPoints;
+			ControlPointCache->Key = CacheKey;
+		}
 	}
 	
-	// Tessellate the original mesh
-	TArray<FIndex2i> NewVertices;
-	FDynamicMesh3 ResultMesh;
-	bOk = TessellateMesh(*Mesh, TessellationLevel, Progress, NewVertices, ResultMesh);
-	if (bOk == false) 
+	// Tessellate the original mesh, straight into the output mesh if we have one. When tessellating in place, the 
+	// result is moved into Mesh at the end, the input is never copied.
+	bool bOk = false;
+	FDynamicMesh3 LocalResultMesh;
+	FDynamicMesh3& ResultMesh = (OutMesh != nullptr) ? *OutMesh : LocalResultMesh;
+	if (AdaptiveEdgeError || bFusedEvaluation == false)
 	{
-		return false;
+		TArray<FIndex2i> NewVertices;
+		if (AdaptiveEdgeError)
+		{
+			bOk = TessellateMeshAdaptive(*Mesh, AdaptiveEdgeError, AdaptiveErrorThreshold, TriangleBudget, Progress, NewVertices, ResultMesh);
+		}
+		else
+		{
+			bOk = TessellateMesh(*Mesh, TessellationLevel, TriangleBudget, bClampToBudget, Progress, NewVertices, ResultMesh);
+		}
+		
+		// Compute displacement and optionally quadratically varying normals
+		bOk = bOk && DisplaceAndSetQuadraticNormals(*Mesh, *ControlPoints, NewVertices, bComputeNormals, Progress, ResultMesh);
+	}
+	else 
+	{
+		// Place every new vertex on its patch and give it the patch normal as the lattice is generated, the positions
+		// and normals are written once
+		const FDynamicMesh3& OriginalMesh = *Mesh;
+		const FControlPoints& PatchControlPoints = *ControlPoints;
+		FDpUniformTessellate Tessellator(&OriginalMesh, &ResultMesh);
+		Tessellator.Progress = Progress;
+		Tessellator.TessellationNum = TessellationLevel;
+		Tessellator.TriangleBudget = TriangleBudget;
+		Tessellator.bClampToBudget = bClampToBudget;
+		Tessellator.PositionFunction = [&OriginalMesh, &PatchControlPoints](int32 TriangleID, const FVector3d& BaryCoords) 
+		{
+			return EvaluatePatch(OriginalMesh, PatchControlPoints, TriangleID, BaryCoords);
+		};
+		if (bComputeNormals) 
+		{
+			Tessellator.NormalFunction = [&OriginalMesh, &PatchControlPoints](int32 TriangleID, const FVector3d& BaryCoords) 
+			{
+				return EvaluatePatchNormal(OriginalMesh, PatchControlPoints, TriangleID, BaryCoords);
+			};
+		}
+		bOk = Tessellator.Validate() == EOperationValidationResult::Ok && Tessellator.Compute();
 	}
 
-	// Compute displacement and optionally quadratically varying normals
-	bOk = DisplaceAndSetQuadraticNormals(*Mesh, FControlPoints, NewVertices, bComputePNNormals, Progress, ResultMesh);
 	if (bOk == false) 
 	{
-		return false;
+		ResultMesh.Clear();
+		return Fail();
+	}
+
+	if (bRecalculateNormals && bComputeNormals == false && bHasNormals)
+	{
+		FDpParallelNormals::RecomputeNormals(ResultMesh);
 	}
 				
-	if (bRecalculateNormals && bComputePNNormals == false)
+	if (OutMesh == nullptr)
 	{
-		if (ResultMesh.HasAttributes())
-		{
-			FMeshNormals NewNormals(&ResultMesh);
-			FDynamicMeshNormalOverlay* NormalOverlay = ResultMesh.Attributes()->PrimaryNormals();
-			NewNormals.RecomputeOverlayNormals(NormalOverlay);
-			NewNormals.CopyToOverlay(NormalOverlay);
-		}
-		else if (ResultMesh.HasVertexNormals())
+		*MeshToReplace = MoveTemp(ResultMesh);
+	}
+
+	return true;
+}
+
+bool DpFPNTriangles::ComputeChunks(const int64 ChunkTriangleBudget, TFunctionRef<bool(FDynamicMesh3& Chunk, int32 ChunkIndex)> ChunkCallback)
+{
+	check(Mesh != nullptr);
+
+	if (Validate() != EOperationValidationResult::Ok || AdaptiveEdgeError) 
+	{
+		return false; // adaptive tessellation stays within TriangleBudget, it never needs chunks
+	}
+
+	int32 ChunkIndex = 0;
+	const bool bChunked = FDpUniformTessellate::ForEachChunkSubmesh(*Mesh, TessellationLevel, ChunkTriangleBudget, [&](const FDynamicMesh3& Submesh)
+	{
+		FDynamicMesh3 Chunk;
+		DpFPNTriangles ChunkTriangles(&Submesh, &Chunk);
+		ChunkTriangles.Progress = Progress;
+		ChunkTriangles.TessellationLevel = TessellationLevel;
+		ChunkTriangles.TriangleBudget = (int32)FMath::Min(ChunkTriangleBudget, FDpUniformTessellate::MaxResultTriangles);
+		ChunkTriangles.bComputePNNormals = bComputePNNormals;
+		ChunkTriangles.bRecalculateNormals = bRecalculateNormals;
+		ChunkTriangles.bFusedEvaluation = bFusedEvaluation;
+		if (ChunkTriangles.Validate() != EOperationValidationResult::Ok || ChunkTriangles.Compute() == false) 
 		{
-			FMeshNormals::QuickComputeVertexNormals(ResultMesh);
+			return false;
 		}
-	}
 
-	Mesh->Copy(ResultMesh);
+		return ChunkCallback(Chunk, ChunkIndex++);
+	});
 
-	return true;
-}
\ No newline at end of file
+	return bChunked && !(Progress && Progress->Cancelled());
+}
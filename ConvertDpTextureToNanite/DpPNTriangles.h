@@ -3,9 +3,17 @@
 #pragma once
 
 #include "GeometryTypes.h"
+#include "HAL/CriticalSection.h"
+#include "Misc/ScopeLock.h"
+#include <atomic>
 
 class FProgressCancel;
 
+namespace FPNTrianglesLocals
+{
+	struct FControlPoints;
+}
+
 namespace UE
 {
 namespace Geometry
@@ -13,6 +21,70 @@ namespace Geometry
 
 class FDynamicMesh3;
 
+/**
+ * PN control points of a mesh, kept between DpFPNTriangles runs so that tessellating the same mesh again (e.g. at 
+ * another level) does not recompute them. The points are reused while the mesh pointer and its shape and topology 
+ * change stamps match, or while the caller supplied source ID matches if one is set. Can be shared by concurrent runs.
+ */
+class FDpPNControlPointCache
+{
+public:
+	/** What the cached control points were computed for */
+	struct FKey
+	{
+		FString SourceID;
+		const FDynamicMesh3* Mesh = nullptr;
+		uint32 ShapeChangeStamp = 0;
+		uint32 TopologyChangeStamp = 0;
+		int32 MaxVertexID = -1;
+		int32 MaxTriangleID = -1;
+		bool bHasPNNormals = false;
+
+		bool operator==(const FKey& Other) const
+		{
+			return SourceID == Other.SourceID && Mesh == Other.Mesh && ShapeChangeStamp == Other.ShapeChangeStamp && 
+				TopologyChangeStamp == Other.TopologyChangeStamp && MaxVertexID == Other.MaxVertexID && 
+				MaxTriangleID == Other.MaxTriangleID && bHasPNNormals == Other.bHasPNNormals;
+		}
+	};
+
+	void Reset()
+	{
+		FScopeLock ScopeLock(&Lock);
+		ControlPoints.Reset();
+		Key = FKey();
+	}
+
+	/**
+	 * Key the control points on InSourceID instead of the mesh pointer and change stamps, for callers that tessellate a
+	 * fresh copy of the same source on every run. The ID has to change whenever the source positions, normals or 
+	 * topology do. An empty ID goes back to the change stamps.
+	 */
+	void SetSourceID(const FString& InSourceID)
+	{
+		FScopeLock ScopeLock(&Lock);
+		SourceID = InSourceID;
+	}
+
+	/** @return How many runs reused the cached control points. */
+	int32 GetNumHits() const
+	{
+		return NumHits;
+	}
+
+private:
+	friend class DpFPNTriangles;
+
+	/** @return The key of the control points of Mesh, Lock must be held */
+	FKey MakeKey(const FDynamicMesh3& Mesh, bool bWithPNNormals) const;
+
+	FCriticalSection Lock;
+	FString SourceID;
+	FKey Key;
+	TSharedPtr<const FPNTrianglesLocals::FControlPoints, ESPMode::ThreadSafe> ControlPoints;
+	std::atomic<int32> NumHits{ 0 };
+};
+
 /**
  * DpFPNTriangles implements curved PN (Point-Normal) Triangles (Curved PN Triangles, Vlachos, 2001).
  * Each PN triangle replaces one original flat triangle by a curved shape that is retriangulated into 
@@ -28,8 +100,21 @@ public:
 	// Input & Output
 	//
 
-	/** The mesh that we are modifying. If the operator fails or is canceled by the user, the mesh will not be changed. */
-	FDynamicMesh3* Mesh = nullptr;
+	/** 
+	 * The mesh that we are tessellating. Without OutMesh, it is replaced by the result. If the operator fails or is 
+	 * canceled by the user, the mesh will not be changed.
+	 */
+	const FDynamicMesh3* Mesh = nullptr;
+
+	//
+	// Output
+	//
+
+	/** 
+	 * If set, the result is written here and Mesh is left unchanged. This avoids holding a temporary tessellated 
+	 * mesh and copying it back into Mesh. If the operator fails or is canceled by the user, OutMesh is cleared.
+	 */
+	FDynamicMesh3* OutMesh = nullptr;
 
 	//
 	// Input
@@ -42,14 +127,52 @@ public:
 	int32 TessellationLevel = 1;
 
 	/**
-	 * If true and the mesh has the normal overlay then recalculate it. 
+	 * If set, TessellationLevel is ignored and the mesh is tessellated with FDpAdaptiveTessellate instead: edges are 
+	 * split largest error first while the error is above AdaptiveErrorThreshold and the result has fewer than 
+	 * TriangleBudget triangles. The error is evaluated on the flat tessellation, before the PN displacement.
+	 */
+	TFunction<double(const FDynamicMesh3& Mesh, int32 EdgeID)> AdaptiveEdgeError;
+	double AdaptiveErrorThreshold = 0.0;
+
+	/** 
+	 * Upper bound on the triangle count of the result. A uniform TessellationLevel whose result would not fit is 
+	 * refused, or lowered until it does if bClampToBudget is set. See ComputeChunks() for results that do not fit.
+	 */
+	int32 TriangleBudget = 3000000;
+
+	/** Lower a uniform TessellationLevel until the result fits in TriangleBudget instead of refusing to tessellate. */
+	bool bClampToBudget = false;
+
+	/**
+	 * If true, the new vertices get the quadratically varying PN normals (Vlachos, 2001), evaluated analytically 
+	 * along with the positions. Split normals of the primary normal overlay stay split: each side of a seam edge 
+	 * gets the normals of its own patch. If false, the normals are linearly interpolated from the original corners.
+	 */
+	bool bComputePNNormals = true;
+
+	/**
+	 * Only used if bComputePNNormals is false. If true and the mesh has the normal overlay then recalculate it. 
 	 * If true and the normal overlay doesn't exists, compute per-vertex normals (if they are enabled in the mesh).
 	 * If false, only perform the displacement.
 	 */
 	bool bRecalculateNormals = false;
 
+	/**
+	 * Evaluate the PN patches while tessellating (FDpUniformTessellate::PositionFunction) instead of tessellating 
+	 * flat and displacing the new vertices afterwards. Only used with a uniform TessellationLevel.
+	 */
+	bool bFusedEvaluation = true;
+
+	/** If set, the control points are taken from / stored in this cache. */
+	TSharedPtr<FDpPNControlPointCache, ESPMode::ThreadSafe> ControlPointCache;
+
 public:
-	DpFPNTriangles(FDynamicMesh3* Mesh) : Mesh(Mesh)
+	DpFPNTriangles(FDynamicMesh3* Mesh) : Mesh(Mesh), MeshToReplace(Mesh)
+	{
+	}
+
+	/** Tessellate Mesh and write the result into OutMesh, Mesh is not modified. */
+	DpFPNTriangles(const FDynamicMesh3* Mesh, FDynamicMesh3* OutMesh) : Mesh(Mesh), OutMesh(OutMesh)
 	{
 	}
 
@@ -75,6 +198,22 @@ public:
 	 * @return true if the algorithm succeeds, false if it failed or was canceled by the user.
 	 */
 	virtual bool Compute();
+
+	/**
+	 * Tessellate a uniform TessellationLevel too large for one mesh as a series of bounded meshes, see 
+	 * FDpUniformTessellate::ComputeChunks(). Each chunk is the PN tessellation of a submesh of Mesh, so the patches
+	 * match along the chunk seams as long as Mesh has normals and bRecalculateNormals is off. ControlPointCache is 
+	 * not used, the control points of a submesh are not those of Mesh. Mesh is never changed.
+	 * 
+	 * @param ChunkCallback receives each chunk and its index, return false to stop
+	 * @return true if every chunk was generated and accepted, false if it failed, was cancelled or stopped, or if a 
+	 * single input triangle does not fit in ChunkTriangleBudget.
+	 */
+	virtual bool ComputeChunks(const int64 ChunkTriangleBudget, TFunctionRef<bool(FDynamicMesh3& Chunk, int32 ChunkIndex)> ChunkCallback);
+
+private:
+	/** Set by the in-place constructor only, receives the result when there is no OutMesh. */
+	FDynamicMesh3* MeshToReplace = nullptr;
 };
 
 } // end namespace UE::Geometry
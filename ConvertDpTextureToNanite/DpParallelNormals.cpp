@@ -0,0 +1,212 @@
+#include "DpParallelNormals.h"
+#include "DynamicMesh/MeshNormals.h"
+#include "Async/ParallelFor.h"
+#include "Algo/Sort.h"
+
+using namespace UE::Geometry;
+
+void FDpParallelNormals::ComputeTriangleNormals()
+{
+	FTriangleNormalsKey Key;
+	Key.ShapeChangeStamp = Mesh->GetShapeChangeStamp();
+	Key.TopologyChangeStamp = Mesh->GetTopologyChangeStamp();
+	Key.MaxTriangleID = Mesh->MaxTriangleID();
+	Key.bWeightByArea = bWeightByArea;
+	Key.bWeightByAngle = bWeightByAngle;
+	if (Key == TriangleNormalsKey)
+	{
+		return;
+	}
+	TriangleNormalsKey = Key;
+
+	const EParallelForFlags ParallelFlags = bUseParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+	TriangleNormals.SetNumUninitialized(Mesh->MaxTriangleID());
+	CornerWeights.SetNumUninitialized(Mesh->MaxTriangleID());
+	ParallelFor(Mesh->MaxTriangleID(), [&](int32 TriangleID)
+	{
+		if (Mesh->IsTriangle(TriangleID) == false)
+		{
+			TriangleNormals[TriangleID] = FVector3d::Zero();
+			CornerWeights[TriangleID] = FVector3d::Zero();
+			return;
+		}
+
+		double Area = 0;
+		FVector3d Centroid;
+		Mesh->GetTriInfo(TriangleID, TriangleNormals[TriangleID], Area, Centroid);
+
+		FVector3d Weights = bWeightByAngle ? Mesh->GetTriInternalAnglesR(TriangleID) : FVector3d::One();
+		if (bWeightByArea)
+		{
+			Weights *= Area;
+		}
+		CornerWeights[TriangleID] = Weights;
+	}, ParallelFlags);
+}
+
+void FDpParallelNormals::BuildCornerIndex(const int32 NumRows, TFunctionRef<FIndex3i(int32)> TriangleRows)
+{
+	const EParallelForFlags ParallelFlags = bUseParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+	const int32 MaxTriangleID = Mesh->MaxTriangleID();
+
+	// Count the corners of every row, then turn the counts into row starts
+	RowStart.Reset();
+	RowStart.SetNumZeroed(NumRows + 1);
+	ParallelFor(MaxTriangleID, [&](int32 TriangleID)
+	{
+		if (Mesh->IsTriangle(TriangleID))
+		{
+			const FIndex3i Rows = TriangleRows(TriangleID);
+			for (int32 Corner = 0; Corner < 3; ++Corner)
+			{
+				if (Rows[Corner] >= 0 && Rows[Corner] < NumRows)
+				{
+					FPlatformAtomics::InterlockedIncrement(&RowStart[Rows[Corner]]);
+				}
+			}
+		}
+	}, ParallelFlags);
+
+	int32 Sum = 0;
+	for (int32 Row = 0; Row <= NumRows; ++Row)
+	{
+		const int32 Count = RowStart[Row];
+		RowStart[Row] = Sum;
+		Sum += Count;
+	}
+
+	// Fill the rows, then sort them so that the gather sums in the same order whatever the scheduling
+	TArray<int32> RowFill;
+	RowFill.SetNumUninitialized(NumRows);
+	FMemory::Memcpy(RowFill.GetData(), RowStart.GetData(), NumRows * sizeof(int32));
+	Corners.SetNumUninitialized(Sum);
+	ParallelFor(MaxTriangleID, [&](int32 TriangleID)
+	{
+		if (Mesh->IsTriangle(TriangleID))
+		{
+			const FIndex3i Rows = TriangleRows(TriangleID);
+			for (int32 Corner = 0; Corner < 3; ++Corner)
+			{
+				if (Rows[Corner] >= 0 && Rows[Corner] < NumRows)
+				{
+					const int32 Slot = FPlatformAtomics::InterlockedIncrement(&RowFill[Rows[Corner]]) - 1;
+					Corners[Slot] = TriangleID * 3 + Corner;
+				}
+			}
+		}
+	}, ParallelFlags);
+
+	ParallelFor(NumRows, [&](int32 Row)
+	{
+		Algo::Sort(MakeArrayView(Corners.GetData() + RowStart[Row], RowStart[Row + 1] - RowStart[Row]));
+	}, ParallelFlags);
+}
+
+void FDpParallelNormals::GatherNormals(const int32 NumRows, TArray<FVector3d>& OutNormals)
+{
+	const EParallelForFlags ParallelFlags = bUseParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+	OutNormals.SetNumUninitialized(NumRows);
+	ParallelFor(NumRows, [&](int32 Row)
+	{
+		FVector3d Sum = FVector3d::Zero();
+		for (int32 Index = RowStart[Row]; Index < RowStart[Row + 1]; ++Index)
+		{
+			const int32 TriangleID = Corners[Index] / 3;
+			Sum += CornerWeights[TriangleID][Corners[Index] % 3] * TriangleNormals[TriangleID];
+		}
+		OutNormals[Row] = Normalized(Sum);
+	}, ParallelFlags);
+}
+
+void FDpParallelNormals::ComputeVertexNormals(TArray<FVector3d>& OutNormals)
+{
+	ComputeTriangleNormals();
+	BuildCornerIndex(Mesh->MaxVertexID(), [this](int32 TriangleID) { return Mesh->GetTriangle(TriangleID); });
+	GatherNormals(Mesh->MaxVertexID(), OutNormals);
+}
+
+void FDpParallelNormals::ComputeVertexNormals(FMeshNormals& OutNormals)
+{
+	ComputeVertexNormals(OutNormals.GetNormals());
+}
+
+void FDpParallelNormals::ComputeOverlayNormals(const FDynamicMeshNormalOverlay* Overlay, TArray<FVector3d>& OutNormals)
+{
+	check(Overlay->GetParentMesh() == Mesh);
+	ComputeTriangleNormals();
+	BuildCornerIndex(Overlay->MaxElementID(), [Overlay](int32 TriangleID)
+	{
+		return Overlay->IsSetTriangle(TriangleID) ? Overlay->GetTriangle(TriangleID) : FIndex3i::Invalid();
+	});
+	GatherNormals(Overlay->MaxElementID(), OutNormals);
+}
+
+void FDpParallelNormals::GatherOverlayVertexNormals(const FDynamicMeshNormalOverlay* Overlay, FMeshNormals& OutNormals)
+{
+	check(Overlay->GetParentMesh() == Mesh);
+	const EParallelForFlags ParallelFlags = bUseParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+	BuildCornerIndex(Mesh->MaxVertexID(), [this](int32 TriangleID) { return Mesh->GetTriangle(TriangleID); });
+
+	TArray<FVector3d>& Normals = OutNormals.GetNormals();
+	Normals.SetNumUninitialized(Mesh->MaxVertexID());
+	ParallelFor(Mesh->MaxVertexID(), [&](int32 VertexID)
+	{
+		// A vertex has one element, or one per side of a seam, so the list of the elements already summed is short
+		TArray<int32, TInlineAllocator<8>> Elements;
+		FVector3d ElementSum = FVector3d::Zero();
+		FVector3d TriangleSum = FVector3d::Zero();
+		for (int32 Index = RowStart[VertexID]; Index < RowStart[VertexID + 1]; ++Index)
+		{
+			const int32 TriangleID = Corners[Index] / 3;
+			const int32 ElementID = Overlay->IsSetTriangle(TriangleID) ? Overlay->GetTriangle(TriangleID)[Corners[Index] % 3] : FDynamicMesh3::InvalidID;
+			if (ElementID == FDynamicMesh3::InvalidID)
+			{
+				TriangleSum += Mesh->GetTriNormal(TriangleID);
+			}
+			else if (Elements.Contains(ElementID) == false)
+			{
+				Elements.Add(ElementID);
+				ElementSum += (FVector3d)Overlay->GetElement(ElementID);
+			}
+		}
+		Normals[VertexID] = Normalized(Elements.Num() > 0 ? ElementSum : TriangleSum);
+	}, ParallelFlags);
+}
+
+void FDpParallelNormals::RecomputeNormals(FDynamicMesh3& Mesh, bool bWeightByArea, bool bWeightByAngle, bool bUseParallel)
+{
+	const EParallelForFlags ParallelFlags = bUseParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+	FDpParallelNormals Normals(&Mesh);
+	Normals.bWeightByArea = bWeightByArea;
+	Normals.bWeightByAngle = bWeightByAngle;
+	Normals.bUseParallel = bUseParallel;
+
+	TArray<FVector3d> Result;
+	if (Mesh.HasAttributes() && Mesh.Attributes()->PrimaryNormals() != nullptr)
+	{
+		FDynamicMeshNormalOverlay* NormalOverlay = Mesh.Attributes()->PrimaryNormals();
+		Normals.ComputeOverlayNormals(NormalOverlay, Result);
+		ParallelFor(Result.Num(), [&](int32 ElementID)
+		{
+			if (NormalOverlay->IsElement(ElementID))
+			{
+				NormalOverlay->SetElement(ElementID, (FVector3f)Result[ElementID]);
+			}
+		}, ParallelFlags);
+	}
+	else
+	{
+		if (Mesh.HasVertexNormals() == false)
+		{
+			Mesh.EnableVertexNormals(FVector3f::UnitZ());
+		}
+		Normals.ComputeVertexNormals(Result);
+		ParallelFor(Result.Num(), [&](int32 VertexID)
+		{
+			if (Mesh.IsVertex(VertexID))
+			{
+				Mesh.SetVertexNormal(VertexID, (FVector3f)Result[VertexID]);
+			}
+		}, ParallelFlags);
+	}
+}
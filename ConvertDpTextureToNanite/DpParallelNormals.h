@@ -0,0 +1,105 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DynamicMesh/DynamicMesh3.h"
+#include "DynamicMesh/DynamicMeshAttributeSet.h"
+
+namespace UE
+{
+namespace Geometry
+{
+
+class FMeshNormals;
+
+/**
+ * Vertex and overlay normals of large meshes, computed in parallel without scattering. FMeshNormals walks the
+ * one-ring of every vertex serially, and accumulating triangle normals into their vertices would need atomics.
+ * Here the weighted triangle normals are computed once in parallel, then every vertex (or overlay element) sums
+ * the normals of its own triangles through a compressed sparse row (CSR) index of its triangle corners. Each
+ * output normal is written by one task only. The CSR rows are sorted, so the sums and the results do not depend
+ * on the number of threads.
+ *
+ * Same weighting and results as FMeshNormals, up to the summation order. Only depends on GeometryCore.
+ * The triangle normals are computed on first use and shared by the following calls while the weighting flags and 
+ * the shape and topology change stamps of the mesh stay the same.
+ */
+class FDpParallelNormals
+{
+public:
+	/** Weight the triangle normals by the triangle area. */
+	bool bWeightByArea = true;
+
+	/** Weight the triangle normals by the interior angle of the triangle at the vertex. */
+	bool bWeightByAngle = true;
+
+	bool bUseParallel = true;
+
+	explicit FDpParallelNormals(const FDynamicMesh3* Mesh) : Mesh(Mesh)
+	{
+	}
+
+	/** Compute the normal of every vertex, indexed by vertex ID. Unused IDs get a zero normal. */
+	void ComputeVertexNormals(TArray<FVector3d>& OutNormals);
+
+	/** Same as above, into the normals of an FMeshNormals set to Mesh, e.g. for ComputeDisplacement. */
+	void ComputeVertexNormals(FMeshNormals& OutNormals);
+
+	/** Compute the normal of every element of Overlay, indexed by element ID. Split normals stay split. */
+	void ComputeOverlayNormals(const FDynamicMeshNormalOverlay* Overlay, TArray<FVector3d>& OutNormals);
+
+	/**
+	 * Read the normal of every vertex from the elements of Overlay instead of computing it from the triangles, e.g. 
+	 * the PN normals DpFPNTriangles evaluated while tessellating. The elements of a vertex split by a seam are 
+	 * averaged, a vertex without any set element gets the average normal of its triangles.
+	 */
+	void GatherOverlayVertexNormals(const FDynamicMeshNormalOverlay* Overlay, FMeshNormals& OutNormals);
+
+	/**
+	 * Recompute the primary normal overlay of Mesh if it has one, the per-vertex normals otherwise (enabling
+	 * them if needed). Parallel replacement for FMeshNormals::RecomputeOverlayNormals() + CopyToOverlay() and
+	 * FMeshNormals::QuickComputeVertexNormals().
+	 */
+	static void RecomputeNormals(FDynamicMesh3& Mesh, bool bWeightByArea = true, bool bWeightByAngle = true, bool bUseParallel = true);
+
+private:
+	const FDynamicMesh3* Mesh = nullptr;
+
+	/** Unit normal of every triangle, indexed by triangle ID */
+	TArray<FVector3d> TriangleNormals;
+
+	/** What TriangleNormals and CornerWeights were computed for */
+	struct FTriangleNormalsKey
+	{
+		uint32 ShapeChangeStamp = 0;
+		uint32 TopologyChangeStamp = 0;
+		int32 MaxTriangleID = -1;
+		bool bWeightByArea = false;
+		bool bWeightByAngle = false;
+
+		bool operator==(const FTriangleNormalsKey& Other) const
+		{
+			return ShapeChangeStamp == Other.ShapeChangeStamp && TopologyChangeStamp == Other.TopologyChangeStamp && 
+				MaxTriangleID == Other.MaxTriangleID && bWeightByArea == Other.bWeightByArea && bWeightByAngle == Other.bWeightByAngle;
+		}
+	};
+	FTriangleNormalsKey TriangleNormalsKey;
+
+	/** Weight of the triangle normal at each of its corners, in GetTriangle() order */
+	TArray<FVector3d> CornerWeights;
+
+	/** CSR index: the corners (TriangleID * 3 + Corner) of row r are Corners[RowStart[r]] .. Corners[RowStart[r + 1] - 1] */
+	TArray<int32> RowStart;
+	TArray<int32> Corners;
+
+	/** Compute TriangleNormals and CornerWeights, unless they are up to date */
+	void ComputeTriangleNormals();
+
+	/** Build the CSR index of NumRows rows, where corner c of triangle t belongs to row TriangleRows(t)[c] */
+	void BuildCornerIndex(const int32 NumRows, TFunctionRef<FIndex3i(int32)> TriangleRows);
+
+	/** Sum the weighted triangle normals of each CSR row and normalize them */
+	void GatherNormals(const int32 NumRows, TArray<FVector3d>& OutNormals);
+};
+
+} // end namespace UE::Geometry
+} // end namespace UE
@@ -0,0 +1,271 @@
+#include "DpScalarFieldPyramid.h"
+#include "Async/ParallelFor.h"
+
+using namespace UE::Geometry;
+
+void FDpScalarFieldPyramid::Reset()
+{
+	Levels.Empty();
+	CellDimensions = FVector2f::One();
+	ValueOffset = 0.0f;
+	ValueScale = 1.0f;
+}
+
+void FDpScalarFieldPyramid::Build(const TImageBuilder<FVector4f>& Image, int32 Channel, EPrecision PrecisionIn)
+{
+	const int64 ImageWidth = Image.GetDimensions().GetWidth();
+	Build(Image.GetDimensions(), [&Image, Channel, ImageWidth](int32 FirstY, int32 NumRows, float* OutValues)
+	{
+		const int64 FirstIndex = FirstY * ImageWidth;
+		for (int64 i = 0; i < NumRows * ImageWidth; ++i)
+		{
+			OutValues[i] = Image.GetPixel(FirstIndex + i)[Channel];
+		}
+	}, PrecisionIn);
+}
+
+void FDpScalarFieldPyramid::Build(const FImageDimensions& Dimensions, TFunctionRef<void(int32 FirstY, int32 NumRows, float* OutValues)> ReadRows, EPrecision PrecisionIn)
+{
+	Reset();
+	Precision = PrecisionIn;
+
+	const int64 SourceWidth = Dimensions.GetWidth();
+	const int64 SourceHeight = Dimensions.GetHeight();
+	if (SourceWidth <= 0 || SourceHeight <= 0)
+	{
+		return;
+	}
+	const int32 BytesPerValue = (Precision == EPrecision::Unorm8) ? 1 : 2;
+
+	// Note that the height will not be 1.0 if the image is not square, same as the FSampledScalarField2f grids
+	CellDimensions = FVector2f(1.0f / (float)SourceWidth);
+
+	// Unorm8 is meant for 8 bit unorm sources: the fixed [0,1] range keeps their k/255 values exact, a min/max
+	// rescale would not
+	ValueOffset = 0.0f;
+	ValueScale = 1.0f / (float)MaxQuantized();
+
+	// One float buffer per band of rows, reused for all its rows
+	const int32 NumBands = (int32)FMath::DivideAndRoundUp(SourceHeight, (int64)BuildBandHeight);
+	auto ReadBand = [&ReadRows, SourceWidth, SourceHeight](int32 Band, TArray<float>& OutValues)
+	{
+		const int32 FirstY = Band * BuildBandHeight;
+		const int32 NumRows = (int32)FMath::Min((int64)BuildBandHeight, SourceHeight - FirstY);
+		OutValues.SetNumUninitialized(NumRows * SourceWidth);
+		ReadRows(FirstY, NumRows, OutValues.GetData());
+	};
+
+	// Unorm16 quantizes between the source min and max, so values outside [0,1] (float textures) are not clipped. 
+	// The bands are read again for the quantization below rather than kept as floats.
+	TArray<FVector2f> BandRanges;
+	BandRanges.SetNumUninitialized(Precision == EPrecision::Unorm16 ? NumBands : 0);
+	ParallelFor((int32)BandRanges.Num(), [&](int32 Band)
+	{
+		TArray<float> Values;
+		ReadBand(Band, Values);
+		FVector2f Range(TNumericLimits<float>::Max(), TNumericLimits<float>::Lowest());
+		for (const float Value : Values)
+		{
+			Range.X = FMath::Min(Range.X, Value);
+			Range.Y = FMath::Max(Range.Y, Value);
+		}
+		BandRanges[Band] = Range;
+	});
+	if (BandRanges.Num() > 0)
+	{
+		float SourceMin = TNumericLimits<float>::Max();
+		float SourceMax = TNumericLimits<float>::Lowest();
+		for (const FVector2f& Range : BandRanges)
+		{
+			SourceMin = FMath::Min(SourceMin, Range.X);
+			SourceMax = FMath::Max(SourceMax, Range.Y);
+		}
+		ValueOffset = SourceMin;
+		ValueScale = (SourceMax - SourceMin) / (float)MaxQuantized();
+	}
+
+	int32 NumLevelsToBuild = 1;
+	for (int64 W = SourceWidth, H = SourceHeight; W > 1 || H > 1; W = (W + 1) / 2, H = (H + 1) / 2)
+	{
+		++NumLevelsToBuild;
+	}
+	Levels.SetNum(NumLevelsToBuild);
+
+	FLevel& Level0 = Levels[0];
+	Level0.Width = SourceWidth;
+	Level0.Height = SourceHeight;
+	Level0.Values.SetNumUninitialized(SourceWidth * SourceHeight * BytesPerValue);
+	ParallelFor(NumBands, [&](int32 Band)
+	{
+		TArray<float> Values;
+		ReadBand(Band, Values);
+		const int64 FirstIndex = (int64)Band * BuildBandHeight * SourceWidth;
+		for (int64 i = 0; i < Values.Num(); ++i)
+		{
+			Write(Level0.Values, FirstIndex + i, Quantize(Values[i]));
+		}
+	});
+
+	for (int32 LevelIndex = 1; LevelIndex < NumLevelsToBuild; ++LevelIndex)
+	{
+		const FLevel& Parent = Levels[LevelIndex - 1];
+		FLevel& Level = Levels[LevelIndex];
+		Level.Width = (Parent.Width + 1) / 2;
+		Level.Height = (Parent.Height + 1) / 2;
+		const int64 NumTexels = Level.Width * Level.Height;
+		Level.Values.SetNumUninitialized(NumTexels * BytesPerValue);
+
+		const bool bHasMinMax = LevelIndex >= MinMaxFirstLevel;
+		const bool bMinMaxFromLevel0 = LevelIndex == MinMaxFirstLevel;
+		if (bHasMinMax)
+		{
+			Level.MinValues.SetNumUninitialized(NumTexels * BytesPerValue);
+			Level.MaxValues.SetNumUninitialized(NumTexels * BytesPerValue);
+		}
+
+		ParallelFor((int32)Level.Height, [&](int32 y)
+		{
+			for (int64 x = 0; x < Level.Width; ++x)
+			{
+				const int64 Index = y * Level.Width + x;
+
+				// box filter the 2x2 parent texels, repeating the last row/column on odd sizes
+				float Sum = 0.0f;
+				uint32 MinQuantized = MaxQuantized();
+				uint32 MaxQuantizedValue = 0;
+				for (int64 dy = 0; dy < 2; ++dy)
+				{
+					for (int64 dx = 0; dx < 2; ++dx)
+					{
+						const int64 ParentX = FMath::Min(2 * x + dx, Parent.Width - 1);
+						const int64 ParentY = FMath::Min(2 * y + dy, Parent.Height - 1);
+						const int64 ParentIndex = ParentY * Parent.Width + ParentX;
+						Sum += Dequantize(Read(Parent.Values, ParentIndex));
+						if (bHasMinMax && bMinMaxFromLevel0 == false)
+						{
+							MinQuantized = FMath::Min(MinQuantized, Read(Parent.MinValues, ParentIndex));
+							MaxQuantizedValue = FMath::Max(MaxQuantizedValue, Read(Parent.MaxValues, ParentIndex));
+						}
+					}
+				}
+				Write(Level.Values, Index, Quantize(Sum * 0.25f));
+
+				if (bMinMaxFromLevel0)
+				{
+					// the first min/max level bounds the level 0 texels directly
+					const int64 BlockSize = (int64)1 << LevelIndex;
+					const int64 X0 = x * BlockSize, X1 = FMath::Min(X0 + BlockSize, SourceWidth);
+					const int64 Y0 = y * BlockSize, Y1 = FMath::Min(Y0 + BlockSize, SourceHeight);
+					for (int64 SourceY = Y0; SourceY < Y1; ++SourceY)
+					{
+						for (int64 SourceX = X0; SourceX < X1; ++SourceX)
+						{
+							const uint32 Value = Read(Level0.Values, SourceY * SourceWidth + SourceX);
+							MinQuantized = FMath::Min(MinQuantized, Value);
+							MaxQuantizedValue = FMath::Max(MaxQuantizedValue, Value);
+						}
+					}
+				}
+				if (bHasMinMax)
+				{
+					Write(Level.MinValues, Index, MinQuantized);
+					Write(Level.MaxValues, Index, MaxQuantizedValue);
+				}
+			}
+		});
+	}
+}
+
+float FDpScalarFieldPyramid::BilinearSampleClamped(const FVector2f& UV, int32 LevelIndex) const
+{
+	if (Levels.Num() == 0)
+	{
+		return 0.0f;
+	}
+	const int32 ClampedLevelIndex = FMath::Clamp(LevelIndex, 0, Levels.Num() - 1);
+	const FLevel& Level = Levels[ClampedLevelIndex];
+
+	// texel x of level L is centered on level 0 texel x*2^L + (2^L-1)/2
+	const float LevelScale = (float)(1 << ClampedLevelIndex);
+	const float GridX = FMath::Clamp((UV.X / CellDimensions.X - (LevelScale - 1.0f) * 0.5f) / LevelScale, 0.0f, (float)(Level.Width - 1));
+	const float GridY = FMath::Clamp((UV.Y / CellDimensions.Y - (LevelScale - 1.0f) * 0.5f) / LevelScale, 0.0f, (float)(Level.Height - 1));
+
+	const int64 X0 = (int64)GridX;
+	const int64 Y0 = (int64)GridY;
+	const int64 X1 = FMath::Min(X0 + 1, Level.Width - 1);
+	const int64 Y1 = FMath::Min(Y0 + 1, Level.Height - 1);
+	const float FracX = GridX - (float)X0;
+	const float FracY = GridY - (float)Y0;
+
+	const float V00 = (float)Read(Level.Values, Y0 * Level.Width + X0);
+	const float V10 = (float)Read(Level.Values, Y0 * Level.Width + X1);
+	const float V01 = (float)Read(Level.Values, Y1 * Level.Width + X0);
+	const float V11 = (float)Read(Level.Values, Y1 * Level.Width + X1);
+	const float Quantized = (1.0f - FracY) * ((1.0f - FracX) * V00 + FracX * V10) + FracY * ((1.0f - FracX) * V01 + FracX * V11);
+	return ValueOffset + Quantized * ValueScale;
+}
+
+void FDpScalarFieldPyramid::RangeClamped(const FVector2f& UVMin, const FVector2f& UVMax, float& OutMin, float& OutMax) const
+{
+	if (Levels.Num() == 0)
+	{
+		OutMin = OutMax = 0.0f;
+		return;
+	}
+	const int64 SourceWidth = Width();
+	const int64 SourceHeight = Height();
+
+	// level 0 texels a bilinear sample inside the box can read
+	const int64 X0 = FMath::Clamp((int64)FMath::FloorToFloat(UVMin.X / CellDimensions.X), (int64)0, SourceWidth - 1);
+	const int64 Y0 = FMath::Clamp((int64)FMath::FloorToFloat(UVMin.Y / CellDimensions.Y), (int64)0, SourceHeight - 1);
+	const int64 X1 = FMath::Clamp((int64)FMath::FloorToFloat(UVMax.X / CellDimensions.X) + 1, (int64)0, SourceWidth - 1);
+	const int64 Y1 = FMath::Clamp((int64)FMath::FloorToFloat(UVMax.Y / CellDimensions.Y) + 1, (int64)0, SourceHeight - 1);
+
+	// coarsest useful level is the first one where the box spans at most 2x2 texels
+	int32 LevelIndex = 0;
+	while (LevelIndex < Levels.Num() - 1 && ((X1 >> LevelIndex) - (X0 >> LevelIndex) > 1 || (Y1 >> LevelIndex) - (Y0 >> LevelIndex) > 1))
+	{
+		++LevelIndex;
+	}
+
+	uint32 MinQuantized = MaxQuantized();
+	uint32 MaxQuantizedValue = 0;
+	if (LevelIndex < MinMaxFirstLevel)
+	{
+		const FLevel& Level0 = Levels[0];
+		for (int64 y = Y0; y <= Y1; ++y)
+		{
+			for (int64 x = X0; x <= X1; ++x)
+			{
+				const uint32 Value = Read(Level0.Values, y * SourceWidth + x);
+				MinQuantized = FMath::Min(MinQuantized, Value);
+				MaxQuantizedValue = FMath::Max(MaxQuantizedValue, Value);
+			}
+		}
+	}
+	else
+	{
+		const FLevel& Level = Levels[LevelIndex];
+		for (int64 y = Y0 >> LevelIndex; y <= (Y1 >> LevelIndex); ++y)
+		{
+			for (int64 x = X0 >> LevelIndex; x <= (X1 >> LevelIndex); ++x)
+			{
+				MinQuantized = FMath::Min(MinQuantized, Read(Level.MinValues, y * Level.Width + x));
+				MaxQuantizedValue = FMath::Max(MaxQuantizedValue, Read(Level.MaxValues, y * Level.Width + x));
+			}
+		}
+	}
+
+	OutMin = Dequantize(MinQuantized);
+	OutMax = Dequantize(MaxQuantizedValue);
+}
+
+SIZE_T FDpScalarFieldPyramid::GetAllocatedSize() const
+{
+	SIZE_T Size = Levels.GetAllocatedSize();
+	for (const FLevel& Level : Levels)
+	{
+		Size += Level.Values.GetAllocatedSize() + Level.MinValues.GetAllocatedSize() + Level.MaxValues.GetAllocatedSize();
+	}
+	return Size;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Image/ImageBuilder.h"
+
+namespace UE
+{
+namespace Geometry
+{
+
+/**
+ * Single channel scalar field stored as a prefiltered mip pyramid of 8 or 16 bit planes, with a min/max quadtree
+ * over it. Unorm16 values are quantized between the minimum and maximum value of the source, so any range is kept.
+ * Unorm8 values are quantized on the fixed [0,1] range, so 8 bit unorm sources are stored exactly.
+ *
+ * Level 0 is laid out like the FSampledScalarField2f grids it replaces: it spans [0,1] in U and [0,Height/Width]
+ * in V, and Width()/Height()/CellDimensions/BilinearSampleClamped() behave the same, so it can be used wherever
+ * those grids are sampled. Level L averages 2^L x 2^L blocks of level 0 texels. From level MinMaxFirstLevel on,
+ * every level also stores the minimum and maximum level 0 value under each of its texels, which bounds the field
+ * over any UV region with a handful of reads.
+ */
+class FDpScalarFieldPyramid
+{
+public:
+	enum class EPrecision : uint8
+	{
+		Unorm8,
+		Unorm16
+	};
+
+	/** Min/max planes start at this level, below it the level 0 texels are scanned directly */
+	static constexpr int32 MinMaxFirstLevel = 2;
+
+	/** Build() reads the rows in bands of this many rows, a multiple of the 4 row blocks of compressed textures */
+	static constexpr int32 BuildBandHeight = 16;
+
+	/** Size of a level 0 texel in UV units, matches FSampledScalarField2f::CellDimensions */
+	FVector2f CellDimensions = FVector2f::One();
+
+public:
+	/**
+	 * Build the pyramid from one channel of an image.
+	 * @param Precision bits kept per value. Unorm8 is lossless for 8 bit unorm sources, values outside [0,1] are clamped.
+	 */
+	void Build(const TImageBuilder<FVector4f>& Image, int32 Channel, EPrecision Precision);
+
+	/**
+	 * Build the pyramid from a field read in bands of BuildBandHeight rows, e.g. straight from a texture without 
+	 * decoding it into an image first. Bands are read concurrently into one buffer each, twice for Unorm16 (value 
+	 * range, then quantization), so only a band per worker is held as floats.
+	 * @param ReadRows writes the Dimensions.GetWidth() values of rows FirstY..FirstY+NumRows-1 to OutValues, row after row
+	 */
+	void Build(const FImageDimensions& Dimensions, TFunctionRef<void(int32 FirstY, int32 NumRows, float* OutValues)> ReadRows, EPrecision Precision);
+
+	void Reset();
+
+	int64 Width() const { return Levels.Num() > 0 ? Levels[0].Width : 0; }
+	int64 Height() const { return Levels.Num() > 0 ? Levels[0].Height : 0; }
+	int32 NumLevels() const { return Levels.Num(); }
+
+	/** Bilinear sample of level 0, clamped at the borders */
+	float BilinearSampleClamped(const FVector2f& UV) const
+	{
+		return BilinearSampleClamped(UV, 0);
+	}
+
+	/** Bilinear sample of the given mip level, clamped at the borders */
+	float BilinearSampleClamped(const FVector2f& UV, int32 Level) const;
+
+	/** @return the mip level whose texels are about TexelFootprint level 0 texels wide */
+	int32 LevelForFootprint(float TexelFootprint) const
+	{
+		const int32 Level = TexelFootprint > 1.0f ? FMath::FloorToInt32(FMath::Log2(TexelFootprint)) : 0;
+		return FMath::Clamp(Level, 0, FMath::Max(Levels.Num() - 1, 0));
+	}
+
+	/**
+	 * Conservative range of the values BilinearSampleClamped() can return inside a UV box.
+	 * Tiling is not applied, the box is in the same UV space the samples are taken in.
+	 */
+	void RangeClamped(const FVector2f& UVMin, const FVector2f& UVMax, float& OutMin, float& OutMax) const;
+
+	/** @return bytes used by all the planes */
+	SIZE_T GetAllocatedSize() const;
+
+protected:
+	struct FLevel
+	{
+		int64 Width = 0;
+		int64 Height = 0;
+		/** Quantized values, uint8 or uint16 depending on Precision */
+		TArray64<uint8> Values;
+		TArray64<uint8> MinValues;
+		TArray64<uint8> MaxValues;
+	};
+
+	TArray<FLevel> Levels;
+	EPrecision Precision = EPrecision::Unorm16;
+	float ValueOffset = 0.0f;
+	float ValueScale = 1.0f;
+
+	uint32 MaxQuantized() const
+	{
+		return Precision == EPrecision::Unorm8 ? 0xFF : 0xFFFF;
+	}
+
+	uint32 Read(const TArray64<uint8>& Plane, int64 Index) const
+	{
+		return Precision == EPrecision::Unorm8 ? Plane[Index] : reinterpret_cast<const uint16*>(Plane.GetData())[Index];
+	}
+
+	void Write(TArray64<uint8>& Plane, int64 Index, uint32 Quantized) const
+	{
+		if (Precision == EPrecision::Unorm8)
+		{
+			Plane[Index] = (uint8)Quantized;
+		}
+		else
+		{
+			reinterpret_cast<uint16*>(Plane.GetData())[Index] = (uint16)Quantized;
+		}
+	}
+
+	float Dequantize(uint32 Quantized) const
+	{
+		return ValueOffset + (float)Quantized * ValueScale;
+	}
+
+	uint32 Quantize(float Value) const
+	{
+		const float Normalized = ValueScale > 0.0f ? (Value - ValueOffset) / ValueScale : 0.0f;
+		return (uint32)FMath::Clamp(FMath::RoundToInt32(Normalized), 0, (int32)MaxQuantized());
+	}
+};
+
+} // end namespace UE::Geometry
+} // end namespace UE
@@ -0,0 +1,596 @@
+#include "DpTessellationCache.h"
+
+#include "DpBulkMeshBuilder.h"
+#include "DynamicMesh/DynamicMesh3.h"
+#include "DynamicMesh/DynamicMeshAttributeSet.h"
+#include "Async/MappedFileHandle.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/LargeMemoryReader.h"
+#include <atomic>
+
+using namespace UE::Geometry;
+
+namespace DpTessellationCacheLocals
+{
+	static constexpr uint32 EntryMagic = 0x43545044; // "DPTC"
+	// Bump when the entry layout changes
+	static constexpr int32 EntryVersion = 1;
+	static constexpr int64 SectionAlignment = 16;
+	static const TCHAR* EntryExtension = TEXT(".dpmesh");
+
+	enum class EPayload : int32
+	{
+		Arrays = 0,
+		Archive = 1
+	};
+
+	struct FEntryHeader
+	{
+		uint32 Magic = EntryMagic;
+		int32 Version = EntryVersion;
+		EPayload Payload = EPayload::Arrays;
+		int32 NumVertices = 0;
+		int32 NumTriangles = 0;
+		int32 bHasTriangleGroups = 0;
+		int32 bHasVertexNormals = 0;
+		int32 bHasAttributes = 0;
+		int32 NumUVLayers = 0;
+		int32 NumNormalLayers = 0;
+		int32 bHasMaterialID = 0;
+		int32 Padding = 0;
+		double TessellationTime = 0;
+	};
+
+	/** @return true if every attribute of Mesh has a section in the array layout */
+	static bool CanWriteArrays(const FDynamicMesh3& Mesh)
+	{
+		if (Mesh.IsCompact() == false || Mesh.HasVertexColors() || Mesh.HasVertexUVs())
+		{
+			return false;
+		}
+		if (Mesh.HasAttributes() == false)
+		{
+			return true;
+		}
+
+		const FDynamicMeshAttributeSet* Attributes = Mesh.Attributes();
+		if (Attributes->HasPrimaryColors() || Attributes->NumPolygroupLayers() > 0 || Attributes->NumWeightLayers() > 0 ||
+			Attributes->GetSkinWeightsAttributes().Num() > 0 || Attributes->NumAttachedAttributes() > 0)
+		{
+			return false;
+		}
+
+		// The elements are written by index, so they have to be compact too
+		for (int32 LayerIndex = 0; LayerIndex < Attributes->NumUVLayers(); ++LayerIndex)
+		{
+			const FDynamicMeshUVOverlay* Overlay = Attributes->GetUVLayer(LayerIndex);
+			if (Overlay->ElementCount() != Overlay->MaxElementID())
+			{
+				return false;
+			}
+		}
+		for (int32 LayerIndex = 0; LayerIndex < Attributes->NumNormalLayers(); ++LayerIndex)
+		{
+			const FDynamicMeshNormalOverlay* Overlay = Attributes->GetNormalLayer(LayerIndex);
+			if (Overlay->ElementCount() != Overlay->MaxElementID())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static void WritePadding(FArchive& Ar)
+	{
+		static const uint8 Zeros[SectionAlignment] = {};
+		const int64 Remainder = Ar.Tell() % SectionAlignment;
+		if (Remainder != 0)
+		{
+			Ar.Serialize(const_cast<uint8*>(Zeros), SectionAlignment - Remainder);
+		}
+	}
+
+	/** Write Num values given by GetValue as one aligned section, through a small staging buffer */
+	template<typename ValueType, typename GetValueFunc>
+	static void WriteSection(FArchive& Ar, const int32 Num, GetValueFunc&& GetValue)
+	{
+		constexpr int32 ChunkSize = 16384;
+		TArray<ValueType> Chunk;
+		Chunk.SetNumUninitialized(FMath::Min(Num, ChunkSize));
+		for (int32 First = 0; First < Num; First += ChunkSize)
+		{
+			const int32 Count = FMath::Min(ChunkSize, Num - First);
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				Chunk[Index] = GetValue(First + Index);
+			}
+			Ar.Serialize(Chunk.GetData(), (int64)Count * sizeof(ValueType));
+		}
+		WritePadding(Ar);
+	}
+
+	template<typename OverlayType, typename ElementType>
+	static void WriteOverlay(FArchive& Ar, const FDynamicMesh3& Mesh, const OverlayType* Overlay)
+	{
+		int32 NumElements = Overlay->ElementCount();
+		Ar << NumElements;
+		WritePadding(Ar);
+		WriteSection<ElementType>(Ar, NumElements, [Overlay](int32 ElementID) { return Overlay->GetElement(ElementID); });
+		WriteSection<FIndex3i>(Ar, Mesh.MaxTriangleID(), [Overlay](int32 TriangleID)
+		{
+			return Overlay->IsSetTriangle(TriangleID) ? Overlay->GetTriangle(TriangleID) : FIndex3i::Invalid();
+		});
+	}
+
+	/** Walks the aligned sections of a mapped entry */
+	struct FSectionReader
+	{
+		const uint8* Data = nullptr;
+		int64 Size = 0;
+		int64 Offset = 0;
+
+		/** @return the next section of Num values, nullptr if the entry is truncated */
+		template<typename ValueType>
+		const ValueType* Read(const int64 Num)
+		{
+			const int64 Bytes = Num * (int64)sizeof(ValueType);
+			if (Num < 0 || Offset + Bytes > Size)
+			{
+				return nullptr;
+			}
+			const ValueType* Section = reinterpret_cast<const ValueType*>(Data + Offset);
+			Offset = Align(Offset + Bytes, SectionAlignment);
+			return Section;
+		}
+	};
+
+	struct FOverlaySections
+	{
+		int32 NumElements = 0;
+		const float* Elements = nullptr;
+		const FIndex3i* Triangles = nullptr;
+	};
+
+	template<int ElementSize>
+	static bool ReadOverlaySections(FSectionReader& Reader, const int32 NumTriangles, FOverlaySections& OutSections)
+	{
+		const int32* NumElements = Reader.Read<int32>(1);
+		if (NumElements == nullptr)
+		{
+			return false;
+		}
+		OutSections.NumElements = *NumElements;
+		OutSections.Elements = Reader.Read<float>((int64)OutSections.NumElements * ElementSize);
+		OutSections.Triangles = Reader.Read<FIndex3i>(NumTriangles);
+		return OutSections.Elements != nullptr && OutSections.Triangles != nullptr;
+	}
+
+	/** Fill an overlay of the mesh from its sections. Elements and triangles can only be added one at a time. */
+	template<int ElementSize, typename OverlayType>
+	static bool FillOverlay(const FOverlaySections& Sections, const int32 NumTriangles, OverlayType* Overlay)
+	{
+		Overlay->ClearElements();
+		Overlay->InitializeTriangles(NumTriangles);
+		for (int32 ElementID = 0; ElementID < Sections.NumElements; ++ElementID)
+		{
+			const float* Element = Sections.Elements + (int64)ElementID * ElementSize;
+			if constexpr (ElementSize == 2)
+			{
+				Overlay->AppendElement(FVector2f(Element[0], Element[1]));
+			}
+			else
+			{
+				Overlay->AppendElement(FVector3f(Element[0], Element[1], Element[2]));
+			}
+		}
+		for (int32 TriangleID = 0; TriangleID < NumTriangles; ++TriangleID)
+		{
+			const FIndex3i& Tri = Sections.Triangles[TriangleID];
+			if (Tri.A == IndexConstants::InvalidID)
+			{
+				continue;
+			}
+			if (FMath::Min3(Tri.A, Tri.B, Tri.C) < 0 || FMath::Max3(Tri.A, Tri.B, Tri.C) >= Sections.NumElements ||
+				Overlay->SetTriangle(TriangleID, Tri) != EMeshResult::Ok)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static bool ReadArrays(const FEntryHeader& Header, FSectionReader& Reader, FDynamicMesh3& OutMesh)
+	{
+		const int32 NumVertices = Header.NumVertices;
+		const int32 NumTriangles = Header.NumTriangles;
+
+		const FVector3d* Positions = Reader.Read<FVector3d>(NumVertices);
+		const FIndex3i* Triangles = Reader.Read<FIndex3i>(NumTriangles);
+		const int32* Groups = Header.bHasTriangleGroups ? Reader.Read<int32>(NumTriangles) : nullptr;
+		const FVector3f* VertexNormals = Header.bHasVertexNormals ? Reader.Read<FVector3f>(NumVertices) : nullptr;
+		if (Positions == nullptr || Triangles == nullptr || (Header.bHasTriangleGroups && Groups == nullptr) ||
+			(Header.bHasVertexNormals && VertexNormals == nullptr))
+		{
+			return false;
+		}
+
+		TArray<FOverlaySections> UVSections, NormalSections;
+		const int32* MaterialIDs = nullptr;
+		if (Header.bHasAttributes)
+		{
+			UVSections.SetNum(Header.NumUVLayers);
+			for (FOverlaySections& Sections : UVSections)
+			{
+				if (ReadOverlaySections<2>(Reader, NumTriangles, Sections) == false)
+				{
+					return false;
+				}
+			}
+			NormalSections.SetNum(Header.NumNormalLayers);
+			for (FOverlaySections& Sections : NormalSections)
+			{
+				if (ReadOverlaySections<3>(Reader, NumTriangles, Sections) == false)
+				{
+					return false;
+				}
+			}
+			if (Header.bHasMaterialID)
+			{
+				MaterialIDs = Reader.Read<int32>(NumTriangles);
+				if (MaterialIDs == nullptr)
+				{
+					return false;
+				}
+			}
+		}
+
+		// The topology is built straight from the mapped arrays
+		TFunction<int32(int32)> TriangleGroup;
+		if (Groups != nullptr)
+		{
+			TriangleGroup = [Groups](int32 TriangleID) { return Groups[TriangleID]; };
+		}
+		if (FDpBulkMeshBuilder::Build(OutMesh, NumVertices, [Positions](int32 VertexID) { return Positions[VertexID]; }, TArrayView<const FIndex3i>(Triangles, NumTriangles), TriangleGroup, true) == false)
+		{
+			return false;
+		}
+
+		if (VertexNormals != nullptr)
+		{
+			OutMesh.EnableVertexNormals(FVector3f::Zero());
+			ParallelFor(NumVertices, [&](int32 VertexID)
+			{
+				OutMesh.SetVertexNormal(VertexID, VertexNormals[VertexID]);
+			});
+		}
+
+		if (Header.bHasAttributes)
+		{
+			OutMesh.EnableAttributes();
+			FDynamicMeshAttributeSet* Attributes = OutMesh.Attributes();
+			Attributes->SetNumUVLayers(Header.NumUVLayers);
+			Attributes->SetNumNormalLayers(Header.NumNormalLayers);
+
+			// The overlays are independent, fill one per task
+			const int32 NumLayers = Header.NumUVLayers + Header.NumNormalLayers;
+			std::atomic<bool> bLayersValid(true);
+			ParallelFor(NumLayers, [&](int32 LayerIndex)
+			{
+				const bool bValid = LayerIndex < Header.NumUVLayers ?
+					FillOverlay<2>(UVSections[LayerIndex], NumTriangles, Attributes->GetUVLayer(LayerIndex)) :
+					FillOverlay<3>(NormalSections[LayerIndex - Header.NumUVLayers], NumTriangles, Attributes->GetNormalLayer(LayerIndex - Header.NumUVLayers));
+				if (bValid == false)
+				{
+					bLayersValid = false;
+				}
+			});
+			if (bLayersValid == false)
+			{
+				return false;
+			}
+
+			if (MaterialIDs != nullptr)
+			{
+				Attributes->EnableMaterialID();
+				FDynamicMeshMaterialAttribute* MaterialIDAttribute = Attributes->GetMaterialID();
+				ParallelFor(NumTriangles, [&](int32 TriangleID)
+				{
+					MaterialIDAttribute->SetValue(TriangleID, &MaterialIDs[TriangleID]);
+				});
+			}
+		}
+
+		return true;
+	}
+
+	static void WriteEntry(FArchive& Ar, const FDynamicMesh3& Mesh, double TessellationTime)
+	{
+		FEntryHeader Header;
+		Header.TessellationTime = TessellationTime;
+
+		if (CanWriteArrays(Mesh) == false)
+		{
+			Header.Payload = EPayload::Archive;
+			Ar.Serialize(&Header, sizeof(Header));
+			WritePadding(Ar);
+			Ar << const_cast<FDynamicMesh3&>(Mesh);
+			return;
+		}
+
+		const FDynamicMeshAttributeSet* Attributes = Mesh.Attributes();
+		Header.NumVertices = Mesh.MaxVertexID();
+		Header.NumTriangles = Mesh.MaxTriangleID();
+		Header.bHasTriangleGroups = Mesh.HasTriangleGroups();
+		Header.bHasVertexNormals = Mesh.HasVertexNormals();
+		Header.bHasAttributes = Attributes != nullptr;
+		Header.NumUVLayers = Attributes ? Attributes->NumUVLayers() : 0;
+		Header.NumNormalLayers = Attributes ? Attributes->NumNormalLayers() : 0;
+		Header.bHasMaterialID = Attributes && Attributes->HasMaterialID();
+		Ar.Serialize(&Header, sizeof(Header));
+		WritePadding(Ar);
+
+		WriteSection<FVector3d>(Ar, Header.NumVertices, [&Mesh](int32 VertexID) { return Mesh.GetVertex(VertexID); });
+		WriteSection<FIndex3i>(Ar, Header.NumTriangles, [&Mesh](int32 TriangleID) { return Mesh.GetTriangle(TriangleID); });
+		if (Header.bHasTriangleGroups)
+		{
+			WriteSection<int32>(Ar, Header.NumTriangles, [&Mesh](int32 TriangleID) { return Mesh.GetTriangleGroup(TriangleID); });
+		}
+		if (Header.bHasVertexNormals)
+		{
+			WriteSection<FVector3f>(Ar, Header.NumVertices, [&Mesh](int32 VertexID) { return Mesh.GetVertexNormal(VertexID); });
+		}
+		if (Attributes)
+		{
+			for (int32 LayerIndex = 0; LayerIndex < Header.NumUVLayers; ++LayerIndex)
+			{
+				WriteOverlay<FDynamicMeshUVOverlay, FVector2f>(Ar, Mesh, Attributes->GetUVLayer(LayerIndex));
+			}
+			for (int32 LayerIndex = 0; LayerIndex < Header.NumNormalLayers; ++LayerIndex)
+			{
+				WriteOverlay<FDynamicMeshNormalOverlay, FVector3f>(Ar, Mesh, Attributes->GetNormalLayer(LayerIndex));
+			}
+			if (Header.bHasMaterialID)
+			{
+				const FDynamicMeshMaterialAttribute* MaterialIDAttribute = Attributes->GetMaterialID();
+				WriteSection<int32>(Ar, Header.NumTriangles, [MaterialIDAttribute](int32 TriangleID)
+				{
+					int32 MaterialID = 0;
+					MaterialIDAttribute->GetValue(TriangleID, &MaterialID);
+					return MaterialID;
+				});
+			}
+		}
+	}
+}
+
+FDpTessellationCache& FDpTessellationCache::Get()
+{
+	static FDpTessellationCache Cache;
+	return Cache;
+}
+
+FString FDpTessellationCache::GetDirectory() const
+{
+	return FPaths::ProjectSavedDir() / TEXT("DpNanite") / TEXT("Checkpoints");
+}
+
+FString FDpTessellationCache::GetEntryPath(const FString& Key) const
+{
+	return GetDirectory() / (Key + DpTessellationCacheLocals::EntryExtension);
+}
+
+bool FDpTessellationCache::Load(const FString& Key, FDynamicMesh3& OutMesh)
+{
+	using namespace DpTessellationCacheLocals;
+
+	{
+		FScopeLock ScopeLock(&Lock);
+		++Stats.NumLookups;
+	}
+
+	const FString Path = GetEntryPath(Key);
+	if (IFileManager::Get().FileExists(*Path) == false)
+	{
+		return false;
+	}
+
+	// Map the entry, fall back to reading it on platforms without mapped files. The region has to be released
+	// before its file, which the declaration order takes care of.
+	TUniquePtr<IMappedFileHandle> MappedFile(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	TUniquePtr<IMappedFileRegion> MappedRegion(MappedFile ? MappedFile->MapRegion() : nullptr);
+	TArray64<uint8> FileData;
+	FSectionReader Reader;
+	if (MappedRegion)
+	{
+		Reader.Data = MappedRegion->GetMappedPtr();
+		Reader.Size = MappedRegion->GetMappedSize();
+	}
+	else if (FFileHelper::LoadFileToArray(FileData, *Path))
+	{
+		Reader.Data = FileData.GetData();
+		Reader.Size = FileData.Num();
+	}
+	else
+	{
+		return false;
+	}
+
+	const FEntryHeader* Header = Reader.Read<FEntryHeader>(1);
+	if (Header == nullptr || Header->Magic != EntryMagic || Header->Version != EntryVersion)
+	{
+		return false;
+	}
+
+	bool bLoaded = false;
+	if (Header->Payload == EPayload::Archive)
+	{
+		FLargeMemoryReader Archive(Reader.Data + Reader.Offset, Reader.Size - Reader.Offset);
+		Archive << OutMesh;
+		bLoaded = Archive.IsError() == false;
+	}
+	else if (Header->Payload == EPayload::Arrays)
+	{
+		bLoaded = ReadArrays(*Header, Reader, OutMesh);
+	}
+
+	if (bLoaded == false)
+	{
+		OutMesh.Clear();
+		return false;
+	}
+
+	// Hits keep their entry at the recent end of the LRU order
+	IFileManager::Get().SetTimeStamp(*Path, FDateTime::UtcNow());
+
+	FScopeLock ScopeLock(&Lock);
+	++Stats.NumHits;
+	Stats.BytesLoaded += Reader.Size;
+	Stats.TessellationTimeSaved += Header->TessellationTime;
+	return true;
+}
+
+void FDpTessellationCache::Save(const FString& Key, const FDynamicMesh3& Mesh, double TessellationTime)
+{
+	const FString Path = GetEntryPath(Key);
+
+	// write next to the entry and move it in place, so a concurrent conversion never reads a partial file
+	const FString TempPath = Path + TEXT(".tmp");
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempPath));
+	if (!Writer)
+	{
+		UE_LOG(LogTemp,Warning,TEXT("2K_DpRA Could not write tessellation cache entry %s"), *TempPath);
+		return;
+	}
+	DpTessellationCacheLocals::WriteEntry(*Writer, Mesh, TessellationTime);
+	const int64 EntrySize = Writer->Tell();
+	const bool bWritten = Writer->Close();
+	Writer.Reset();
+	if (!bWritten || !IFileManager::Get().Move(*Path, *TempPath))
+	{
+		IFileManager::Get().Delete(*TempPath);
+		return;
+	}
+
+	{
+		FScopeLock ScopeLock(&Lock);
+		++Stats.NumWrites;
+		Stats.BytesWritten += EntrySize;
+	}
+
+	Trim();
+}
+
+void FDpTessellationCache::Trim()
+{
+	struct FEntry
+	{
+		FString Path;
+		int64 Size = 0;
+		FDateTime LastUsed;
+	};
+
+	// Only one trim at a time, two would delete the same entries
+	FScopeLock ScopeLock(&Lock);
+
+	TArray<FEntry> Entries;
+	int64 TotalSize = 0;
+	const FString Directory = GetDirectory();
+	FPlatformFileManager::Get().GetPlatformFile().IterateDirectoryStat(*Directory, [&](const TCHAR* FilenameOrDirectory, const FFileStatData& StatData)
+	{
+		if (StatData.bIsDirectory == false && FString(FilenameOrDirectory).EndsWith(DpTessellationCacheLocals::EntryExtension))
+		{
+			Entries.Add({ FilenameOrDirectory, StatData.FileSize, StatData.ModificationTime });
+			TotalSize += StatData.FileSize;
+		}
+		return true;
+	});
+
+	if (TotalSize <= MaxSizeBytes)
+	{
+		return;
+	}
+
+	Entries.Sort([](const FEntry& A, const FEntry& B) { return A.LastUsed < B.LastUsed; });
+	for (const FEntry& Entry : Entries)
+	{
+		if (TotalSize <= MaxSizeBytes)
+		{
+			break;
+		}
+		if (IFileManager::Get().Delete(*Entry.Path))
+		{
+			TotalSize -= Entry.Size;
+			++Stats.NumEvictions;
+			Stats.BytesEvicted += Entry.Size;
+		}
+	}
+}
+
+void FDpTessellationCache::Clear()
+{
+	FScopeLock ScopeLock(&Lock);
+	TArray<FString> Files;
+	IFileManager::Get().FindFiles(Files, *GetDirectory(), DpTessellationCacheLocals::EntryExtension);
+	for (const FString& File : Files)
+	{
+		IFileManager::Get().Delete(*(GetDirectory() / File));
+	}
+}
+
+FDpTessellationCacheStats FDpTessellationCache::GetStats() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Stats;
+}
+
+void FDpTessellationCache::LogStats() const
+{
+	const FDpTessellationCacheStats Current = GetStats();
+	UE_LOG(LogTemp,Warning,TEXT("2K_DpRA Tessellation cache: %d/%d hits (%.1f%%), %.1f MB loaded instead of tessellated, %f ms tessellation saved"),
+		Current.NumHits, Current.NumLookups, Current.HitRate() * 100.0, Current.BytesLoaded / (1024.0 * 1024.0), Current.TessellationTimeSaved);
+	UE_LOG(LogTemp,Warning,TEXT("2K_DpRA   %d writes %.1f MB, %d evictions %.1f MB, cap %.1f MB"),
+		Current.NumWrites, Current.BytesWritten / (1024.0 * 1024.0), Current.NumEvictions, Current.BytesEvicted / (1024.0 * 1024.0), GetMaxSizeBytes() / (1024.0 * 1024.0));
+}
+
+int64 FDpTessellationCache::GetMaxSizeBytes() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return MaxSizeBytes;
+}
+
+void FDpTessellationCache::SetMaxSizeBytes(int64 InMaxSizeBytes)
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		MaxSizeBytes = FMath::Max<int64>(InMaxSizeBytes, 0);
+	}
+	Trim();
+}
+
+namespace DpTessellationCacheLocals
+{
+	static void TessellationCacheCommand(const TArray<FString>& Args)
+	{
+		FDpTessellationCache& Cache = FDpTessellationCache::Get();
+		if (Args.Num() >= 1 && Args[0] == TEXT("clear"))
+		{
+			Cache.Clear();
+		}
+		else if (Args.Num() >= 2 && Args[0] == TEXT("maxsize"))
+		{
+			Cache.SetMaxSizeBytes((int64)FCString::Atoi64(*Args[1]) * 1024 * 1024);
+		}
+		Cache.LogStats();
+	}
+
+	static FAutoConsoleCommand TessellationCacheConsoleCommand(
+		TEXT("DpNanite.TessellationCache"),
+		TEXT("Log the tessellation cache hit rate and sizes. 'clear' deletes the entries, 'maxsize <MB>' sets the LRU size cap"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&TessellationCacheCommand));
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+namespace UE
+{
+namespace Geometry
+{
+class FDynamicMesh3;
+}
+}
+
+/** Counters of the tessellation cache since the editor started */
+struct FDpTessellationCacheStats
+{
+	int32 NumLookups = 0;
+	int32 NumHits = 0;
+	int32 NumWrites = 0;
+	int32 NumEvictions = 0;
+	/** Size of the entries loaded instead of tessellating, i.e. the tessellated meshes the hits did not build */
+	int64 BytesLoaded = 0;
+	int64 BytesWritten = 0;
+	int64 BytesEvicted = 0;
+	/** Tessellation time the hits did not spend, as measured when their entries were written, in ms */
+	double TessellationTimeSaved = 0;
+
+	double HitRate() const
+	{
+		return NumLookups > 0 ? (double)NumHits / (double)NumLookups : 0.0;
+	}
+};
+
+/**
+ * On-disk cache of tessellated meshes in Saved/DpNanite/Checkpoints, one file per key. The key is built by the
+ * caller from everything the tessellation depends on (source mesh content, subdivision type, level ...).
+ *
+ * Entries are a header followed by flat, 16 byte aligned arrays: positions, triangles, groups, vertex normals, then
+ * the elements and triangles of every UV and normal overlay and the material IDs. Loading maps the file and builds
+ * the mesh straight from the mapped arrays, the topology with FDpBulkMeshBuilder and the overlays one layer per task.
+ * Meshes with other attributes (colors, polygroup layers, skin weights ...) or that are not compact are stored with
+ * the FDynamicMesh3 serialization instead.
+ *
+ * Hits refresh the entry time stamp, and the least recently used entries are deleted once the directory grows over
+ * MaxSizeBytes. Can be used from any thread.
+ */
+class FDpTessellationCache
+{
+public:
+	static FDpTessellationCache& Get();
+
+	FString GetDirectory() const;
+	FString GetEntryPath(const FString& Key) const;
+
+	/** @return false on a miss or an unreadable entry, OutMesh is undefined then */
+	bool Load(const FString& Key, UE::Geometry::FDynamicMesh3& OutMesh);
+
+	/**
+	 * Write the entry of Key, then trim the cache to its size cap.
+	 * @param TessellationTime time spent tessellating Mesh in ms, what a later hit saves
+	 */
+	void Save(const FString& Key, const UE::Geometry::FDynamicMesh3& Mesh, double TessellationTime);
+
+	/** Delete the least recently used entries until the cache fits in MaxSizeBytes */
+	void Trim();
+
+	/** Delete every entry */
+	void Clear();
+
+	FDpTessellationCacheStats GetStats() const;
+	void LogStats() const;
+
+	int64 GetMaxSizeBytes() const;
+	void SetMaxSizeBytes(int64 InMaxSizeBytes);
+
+private:
+	mutable FCriticalSection Lock;
+	FDpTessellationCacheStats Stats;
+	int64 MaxSizeBytes = 8ll * 1024 * 1024 * 1024;
+};
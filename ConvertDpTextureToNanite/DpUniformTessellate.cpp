@@ -1,12 +1,16 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "DpUniformTessellate.h"
+#include "DpBulkMeshBuilder.h"
 #include "VectorTypes.h"
 #include "DynamicMesh/DynamicMesh3.h"
 #include "DynamicMesh/MeshNormals.h"
 #include "DynamicMesh/DynamicVertexSkinWeightsAttribute.h"
+#include "DynamicSubmesh3.h"
+#include "Async/Async.h"
 #include "Async/ParallelFor.h"
 #include "Util/ProgressCancel.h"
+#include <atomic>
 
 using namespace UE::Geometry;
 
@@ -136,8 +140,16 @@ namespace UniformTessellateLocals
 		// ---------------------------------------------------------------------
 		TArray<RealType> Elements;
 
-		// Track which elements we set in the Elements array. 
-		TArray<bool> ElementIsSet; 
+		// Track which elements we set in the Elements array, one bit per element. Neighbouring elements are set from
+		// different threads in the ParallelFor bodies, so the words are updated atomically there, see MarkElementsSet().
+		TArray<int32> ElementIsSetBits; 
+
+		// If set, the new elements are ElementFunction(InputTriangleID, BaryCoords) instead of being lerped from the 
+		// input triangle corners, e.g. to place them on a curved patch. Called concurrently if bUseParallel is set.
+		TFunction<void(int32 TriangleID, const FVector3d& BaryCoords, RealType* OutValue)> ElementFunction;
+
+		// Lerp the consecutive rows with LerpElementRow(). Only disable this to compare against the scalar lerp.
+		bool bVectorLerp = true;
 
 		FElementsGenerator(const FDynamicMesh3* Mesh, const int TessellationNum, FProgressCancel* InProgress, const bool bUseParallel) 
 		:
@@ -153,7 +165,42 @@ namespace UniformTessellateLocals
 		{
 			checkSlow(NumElements * ElementSize > 0);
 			Elements.SetNum(NumElements * ElementSize);
-			ElementIsSet.Init(false, NumElements);
+			ElementIsSetBits.Init(0, FMath::DivideAndRoundUp(NumElements, 32));
+		}
+
+		bool IsElementSet(const int Index) const 
+		{
+			return (ElementIsSetBits[Index >> 5] & (1u << (Index & 31))) != 0;
+		}
+
+		// Mark one element as set, from serial code only
+		void MarkElementSet(const int Index) 
+		{
+			ElementIsSetBits[Index >> 5] |= (int32)(1u << (Index & 31));
+		}
+
+		// Mark the elements [First, First + Num) as set from a ParallelFor body, with one OR per 32 elements. Rows of 
+		// different triangles share words, so the OR is atomic unless the generator runs single threaded.
+		void MarkElementsSet(const int First, const int Num) 
+		{
+			int Index = First;
+			const int End = First + Num;
+			while (Index < End) 
+			{
+				const int Word = Index >> 5;
+				const int FirstBit = Index & 31;
+				const int NumBits = FMath::Min(32 - FirstBit, End - Index);
+				const uint32 Mask = (NumBits == 32 ? ~0u : ((1u << NumBits) - 1)) << FirstBit;
+				if (this->bUseParallel) 
+				{
+					FPlatformAtomics::InterlockedOr(&ElementIsSetBits[Word], (int32)Mask);
+				}
+				else 
+				{
+					ElementIsSetBits[Word] |= (int32)Mask;
+				}
+				Index += NumBits;
+			}
 		}
 
 		// Child classes overwrite this to initialize element counts (InElementCount, OutElementCount ... )
@@ -174,7 +221,7 @@ namespace UniformTessellateLocals
 		{
 			const int Index = this->GetElementIDOnEdge(InEdgeID, InTriangleID, VertexOffset);
 			checkSlow(Index >= InElementCount && Index < InElementCount + OutEdgeElementCount); 
-			SetElement(Index, Value); 
+			SetElementConcurrent(Index, Value); 
 		}
 
 		/**
@@ -202,7 +249,7 @@ namespace UniformTessellateLocals
 		{
 			const int Index = GetElementIDOnTriangle(InTriangleID, VertexOffset);
 			checkSlow(Index >= InElementCount + OutEdgeElementCount && Index < OutElementCount); 
-			SetElement(Index, Value); 
+			SetElementConcurrent(Index, Value); 
 		}
 		
 		// Get the element ID at the vertex of the input triangle
@@ -211,10 +258,22 @@ namespace UniformTessellateLocals
 		// Get the element value at the vertex of the input triangle
 		virtual void GetInputMeshElementValue(const int TriangleID, const int VertexID, RealType* Value) const = 0;
 		
+		// Set an element from serial code, e.g. the copies of the input elements in Initialize()
 		void SetElement(const int Index, const RealType* Value)
 		{	
 			const int Offset = Index * ElementSize;
-			ElementIsSet[Index] = true;
+			MarkElementSet(Index);
+			for (int Idx = 0; Idx < ElementSize; ++Idx)
+			{
+				Elements[Offset + Idx] = Value[Idx];
+			}
+		}
+
+		// Set an element from a ParallelFor body
+		void SetElementConcurrent(const int Index, const RealType* Value)
+		{	
+			const int Offset = Index * ElementSize;
+			MarkElementsSet(Index, 1);
 			for (int Idx = 0; Idx < ElementSize; ++Idx)
 			{
 				Elements[Offset + Idx] = Value[Idx];
@@ -225,7 +284,7 @@ namespace UniformTessellateLocals
 		void SetElement(const int Index, const AsType& TypeValue)
 		{	
 			const int Offset = Index * ElementSize;
-			ElementIsSet[Index] = true;
+			MarkElementSet(Index);
 			for (int Idx = 0; Idx < ElementSize; ++Idx)
 			{
 				Elements[Offset + Idx] = TypeValue[Idx];
@@ -234,7 +293,7 @@ namespace UniformTessellateLocals
 
 		void GetElement(const int Index, RealType* Value) const
 		{
-			if (ElementIsSet[Index] == false) 
+			if (IsElementSet(Index) == false) 
 			{
 				checkSlow(false); // we are trying to access an element that wasn't set
 				return;
@@ -251,7 +310,7 @@ namespace UniformTessellateLocals
 		template<typename AsType>
 		void GetElement(const int Index, AsType& TypeValue) const
 		{
-			if (ElementIsSet[Index] == false)
+			if (IsElementSet(Index) == false)
 			{
 				checkSlow(false); // we are trying to access an element that wasn't set
 				return;
@@ -284,6 +343,158 @@ namespace UniformTessellateLocals
 			}
 		} 
 
+		/**
+		 * Lerp the NumPoints elements evenly spaced strictly between Element1 and Element2, i.e. one row of the 
+		 * barycentric lattice of a triangle or the new elements of an edge, into NumPoints consecutive elements.
+		 * 
+		 * Float and double rows are computed 4 points at a time with the platform vector registers (SSE/AVX/NEON). 
+		 * 4 points are ElementSize full registers whatever the ElementSize, lane L of register R holding the 
+		 * component (4R + L) % ElementSize of the point (4R + L) / ElementSize, so the row is written with plain 
+		 * unaligned stores and no shuffles.
+		 */
+		static void LerpElementRow(const RealType* Element1, const RealType* Element2, const int NumPoints, RealType* OutElements)
+		{
+			constexpr int Lanes = 4;
+			const RealType Step = (RealType)1 / (RealType)(NumPoints + 1);
+			int Point = 0;
+
+			if constexpr (std::is_same_v<RealType, float> || std::is_same_v<RealType, double>) 
+			{
+				using VectorType = TVectorRegisterType<RealType>;
+
+				// Per register lane: the start and end component and the offset of the lane's point in the block
+				RealType Pattern[Lanes * ElementSize];
+				VectorType StartRegs[ElementSize];
+				VectorType EndRegs[ElementSize];
+				VectorType OffsetRegs[ElementSize];
+				for (int Reg = 0; Reg < ElementSize; ++Reg) 
+				{
+					for (int Lane = 0; Lane < Lanes; ++Lane) 
+					{
+						Pattern[Reg * Lanes + Lane] = Element1[(Reg * Lanes + Lane) % ElementSize];
+					}
+					StartRegs[Reg] = VectorLoad(&Pattern[Reg * Lanes]);
+					
+					for (int Lane = 0; Lane < Lanes; ++Lane) 
+					{
+						Pattern[Reg * Lanes + Lane] = Element2[(Reg * Lanes + Lane) % ElementSize];
+					}
+					EndRegs[Reg] = VectorLoad(&Pattern[Reg * Lanes]);
+					
+					for (int Lane = 0; Lane < Lanes; ++Lane) 
+					{
+						Pattern[Reg * Lanes + Lane] = (RealType)((Reg * Lanes + Lane) / ElementSize + 1) * Step;
+					}
+					OffsetRegs[Reg] = VectorLoad(&Pattern[Reg * Lanes]);
+				}
+
+				const RealType OnesData[Lanes] = { 1, 1, 1, 1 };
+				const VectorType Ones = VectorLoad(OnesData);
+
+				for (; Point + Lanes <= NumPoints; Point += Lanes) 
+				{
+					const RealType Base = (RealType)Point * Step;
+					const RealType BaseData[Lanes] = { Base, Base, Base, Base };
+					const VectorType BaseAlpha = VectorLoad(BaseData);
+
+					RealType* Out = OutElements + Point * ElementSize;
+					for (int Reg = 0; Reg < ElementSize; ++Reg) 
+					{
+						const VectorType Alpha = VectorAdd(BaseAlpha, OffsetRegs[Reg]);
+						const VectorType OneMinusAlpha = VectorSubtract(Ones, Alpha);
+						VectorStore(VectorMultiplyAdd(OneMinusAlpha, StartRegs[Reg], VectorMultiply(Alpha, EndRegs[Reg])), Out + Reg * Lanes);
+					}
+				}
+			}
+
+			for (; Point < NumPoints; ++Point) 
+			{
+				const RealType Alpha = (RealType)(Point + 1) * Step;
+				const RealType OneMinusAlpha = (RealType)1 - Alpha;
+				for (int Idx = 0; Idx < ElementSize; ++Idx) 
+				{
+					OutElements[Point * ElementSize + Idx] = OneMinusAlpha * Element1[Idx] + Alpha * Element2[Idx];
+				}
+			}
+		}
+
+		/** 
+		 * Lerp a row of NumPoints elements with LerpElementRow() if the elements are consecutive in the Elements 
+		 * array, one at a time otherwise.
+		 * @param GetElementID ID of the element of each point of the row
+		 */
+		template<typename GetElementIDFunc>
+		void SetElementRow(const RealType* Element1, const RealType* Element2, const int NumPoints, GetElementIDFunc&& GetElementID) 
+		{
+			if (NumPoints <= 0) 
+			{
+				return;
+			}
+
+			const int FirstID = GetElementID(0);
+			if (bVectorLerp && GetElementID(NumPoints - 1) == FirstID + NumPoints - 1) 
+			{
+				checkSlow((FirstID + NumPoints) * ElementSize <= Elements.Num());
+				LerpElementRow(Element1, Element2, NumPoints, Elements.GetData() + FirstID * ElementSize);
+				MarkElementsSet(FirstID, NumPoints);
+			}
+			else 
+			{
+				RealType OutElement[ElementSize];
+				for (int VertexOffset = 0; VertexOffset < NumPoints; ++VertexOffset)
+				{
+					const RealType Alpha = (RealType)(VertexOffset + 1) / (NumPoints + 1);
+					LerpElements(Element1, Element2, OutElement, Alpha);
+					SetElementConcurrent(GetElementID(VertexOffset), OutElement);
+				}
+			}
+		}
+
+		/** 
+		 * Set the new elements of an edge on the side of TriangleID with ElementFunction. The barycentric coordinates 
+		 * match the lerp from the first to the second edge vertex in GenerateEdgeElements().
+		 */
+		void EvaluateEdgeElements(const int EdgeID, const int TriangleID) 
+		{
+			const FIndex2i EdgeV = InMesh->GetEdgeV(EdgeID);
+			const FIndex3i TriVertices = InMesh->GetTriangle(TriangleID);
+			const int IndexA = TriVertices.IndexOf(EdgeV.A);
+			const int IndexB = TriVertices.IndexOf(EdgeV.B);
+
+			RealType Value[ElementSize];
+			for (int VertexOffset = 0; VertexOffset < TessellationNum; ++VertexOffset)
+			{
+				const double Alpha = (double)(VertexOffset + 1) / (TessellationNum + 1);
+				FVector3d Bary = FVector3d::Zero();
+				Bary[IndexA] = 1.0 - Alpha;
+				Bary[IndexB] = Alpha;
+				ElementFunction(TriangleID, Bary, Value);
+				this->SetElementOnEdge(EdgeID, TriangleID, VertexOffset, Value);
+			}
+		}
+
+		/** 
+		 * Set the new elements inside a triangle with ElementFunction. Row Level of the lattice goes from the point 
+		 * at (Level + 1)/(TessellationNum + 1) along the edge [v1 v2] to the same point along [v1 v3], see 
+		 * GenerateTriangleElements(), so the barycentric coordinates are known directly.
+		 */
+		void EvaluateTriangleElements(const int TriangleID) 
+		{
+			RealType Value[ElementSize];
+			int ElementIDCounter = 0;
+			for (int Level = 1; Level < TessellationNum; ++Level)
+			{
+				const double EdgeAlpha = (double)(Level + 1) / (TessellationNum + 1);
+				for (int VertexOffset = 0; VertexOffset < Level; ++VertexOffset, ++ElementIDCounter) 
+				{
+					const double RowAlpha = (double)(VertexOffset + 1) / (Level + 1);
+					const FVector3d Bary(1.0 - EdgeAlpha, (1.0 - RowAlpha) * EdgeAlpha, RowAlpha * EdgeAlpha);
+					ElementFunction(TriangleID, Bary, Value);
+					this->SetElementOnTriangle(TriangleID, ElementIDCounter, Value);
+				}
+			}
+		}
+
 		/**
 		 * Generate new elements for vertices (marked with "x" below) along each unique edge of the input mesh 
 		 * (input triangle corners are marked with "o" below). The number of the new vertices per edge is equal to the 
@@ -308,19 +519,22 @@ namespace UniformTessellateLocals
 
 				const FIndex2i EdgeV = InMesh->GetEdgeV(EdgeID);
 				const FIndex2i EdgeTri = InMesh->GetEdgeT(EdgeID);
+
+				if (ElementFunction) 
+				{
+					EvaluateEdgeElements(EdgeID, EdgeTri.A);
+					return;
+				}
 		
 				RealType Element1[ElementSize];
 				RealType Element2[ElementSize];
 				GetInputMeshElementValue(EdgeTri.A, EdgeV.A, Element1);
 				GetInputMeshElementValue(EdgeTri.A, EdgeV.B, Element2);
 
-				RealType OutElement[ElementSize];
-				for (int VertexOffset = 0; VertexOffset < TessellationNum; ++VertexOffset)
+				SetElementRow(Element1, Element2, TessellationNum, [&](int VertexOffset) 
 				{
-					const RealType Alpha = (RealType)(VertexOffset + 1) / (TessellationNum + 1);
-					LerpElements(Element1, Element2, OutElement, Alpha);
-					SetElementOnEdge(EdgeID, EdgeTri.A, VertexOffset, OutElement); 
-				}
+					return this->GetElementIDOnEdge(EdgeID, EdgeTri.A, VertexOffset);
+				});
 
 			}, this->bUseParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
 
@@ -371,6 +585,12 @@ namespace UniformTessellateLocals
 					return;
 				}
 
+				if (ElementFunction) 
+				{
+					EvaluateTriangleElements(TriangleID);
+					return;
+				}
+
 				const FIndex3i TriVertices = InMesh->GetTriangle(TriangleID);
 				const FIndex3i TriEdges = InMesh->GetTriEdges(TriangleID);
 
@@ -390,14 +610,13 @@ namespace UniformTessellateLocals
 					GetElement(ID1, Element1);
 					GetElement(ID2, Element2);
 
-					RealType OutElement[ElementSize];
-					for (int VertexOffset = 0; VertexOffset < NumNewLevelVertices; ++VertexOffset) 
+					// The row is consecutive in the Elements array, it is lerped with the vector kernel
+					const int FirstElementID = ElementIDCounter;
+					SetElementRow(Element1, Element2, NumNewLevelVertices, [&](int VertexOffset) 
 					{
-						const RealType Alpha = (RealType)(VertexOffset + 1) / (NumNewLevelVertices + 1);
-						LerpElements(Element1, Element2, OutElement, Alpha);
-						this->SetElementOnTriangle(TriangleID, ElementIDCounter, OutElement);
-						ElementIDCounter++;
-					}
+						return this->GetElementIDOnTriangle(TriangleID, FirstElementID + VertexOffset);
+					});
+					ElementIDCounter += NumNewLevelVertices;
 				}
 			}, this->bUseParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread); 
 
@@ -427,7 +646,7 @@ namespace UniformTessellateLocals
 		using BaseType = FElementsGenerator<RealType, ElementSize>;
 		using BaseType::InMesh;
 		using BaseType::Elements;
-		using BaseType::ElementIsSet;
+		using BaseType::IsElementSet;
 		using BaseType::TessellationNum;
 		using BaseType::OrderedEdgeOffset;
 		using BaseType::GetEdgeOrder;
@@ -763,7 +982,7 @@ namespace UniformTessellateLocals
 		using BaseType::Triangles;
 		using BaseType::OutTriangleCount;
 		using BaseType::OutInnerTriangleCount;
-		using BaseType::ElementIsSet;
+		using BaseType::IsElementSet;
 		
 		// Track the offset into the Elements array for a block of data containing elements along the edge 
 		// (1 or more for each vertex added along the edge). We can have a variable number of elements per-vertex 
@@ -871,34 +1090,41 @@ namespace UniformTessellateLocals
 				const FIndex2i EdgeV = InMesh->GetEdgeV(EdgeID);
 				const FIndex2i EdgeTri = InMesh->GetEdgeT(EdgeID);
 
+				// the elements of a seam edge are interleaved with the other side's, SetElementRow() falls back to
+				// setting them one at a time
 				RealType Element1[ElementSize]; 
 				RealType Element2[ElementSize]; 
-				RealType Out[ElementSize];
 				
-				if (Overlay->IsSetTriangle(EdgeTri.A)) 
+				if (Overlay->IsSetTriangle(EdgeTri.A) && this->ElementFunction) 
+				{
+					this->EvaluateEdgeElements(EdgeID, EdgeTri.A);
+				}
+				else if (Overlay->IsSetTriangle(EdgeTri.A)) 
 				{
 					GetInputMeshElementValue(EdgeTri.A, EdgeV.A, Element1);
 					GetInputMeshElementValue(EdgeTri.A, EdgeV.B, Element2);
 
-					for (int VertexOffset = 0; VertexOffset < TessellationNum; ++VertexOffset)
+					this->SetElementRow(Element1, Element2, TessellationNum, [&](int VertexOffset) 
 					{
-						const RealType Tau = (RealType)(VertexOffset + 1) / (TessellationNum + 1);
-						this->LerpElements(Element1, Element2, Out, Tau);
-						this->SetElementOnEdge(EdgeID, EdgeTri.A, VertexOffset, Out);	
-					}
+						return this->GetElementIDOnEdge(EdgeID, EdgeTri.A, VertexOffset);
+					});
 				}
 
-				if (SeamEdges[EdgeID] && EdgeTri.B != FDynamicMesh3::InvalidID && Overlay->IsSetTriangle(EdgeTri.B))
+				// Each side of a seam gets its own elements, evaluated on its own triangle
+				const bool bSetSideB = SeamEdges[EdgeID] && EdgeTri.B != FDynamicMesh3::InvalidID && Overlay->IsSetTriangle(EdgeTri.B);
+				if (bSetSideB && this->ElementFunction) 
+				{
+					this->EvaluateEdgeElements(EdgeID, EdgeTri.B);
+				}
+				else if (bSetSideB)
 				{
 					GetInputMeshElementValue(EdgeTri.B, EdgeV.A, Element1);
 					GetInputMeshElementValue(EdgeTri.B, EdgeV.B, Element2);
 					
-					for (int VertexOffset = 0; VertexOffset < TessellationNum; ++VertexOffset)
+					this->SetElementRow(Element1, Element2, TessellationNum, [&](int VertexOffset) 
 					{
-						const RealType Tau = (RealType)(VertexOffset + 1) / (TessellationNum + 1);
-						this->LerpElements(Element1, Element2, Out, Tau);
-						this->SetElementOnEdge(EdgeID, EdgeTri.B, VertexOffset, Out);
-					}
+						return this->GetElementIDOnEdge(EdgeID, EdgeTri.B, VertexOffset);
+					});
 				}
 			}, this->bUseParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);  
 
@@ -919,13 +1145,14 @@ namespace UniformTessellateLocals
 			}
 			
 			OutOverlay->ClearElements();
+			OutOverlay->InitializeTriangles(OutTriangleCount);
 			
 			TArray<int32> ElementMap;
 			ElementMap.SetNumUninitialized(OutElementCount);
 			RealType Value[ElementSize];
 			for (int32 EID = 0; EID < OutElementCount; ++EID)
 			{
-				if (ElementIsSet[EID]) 
+				if (IsElementSet(EID)) 
 				{
 					this->GetElement(EID, Value);
 					ElementMap[EID] = OutOverlay->AppendElement(Value);
@@ -1022,22 +1249,12 @@ namespace UniformTessellateLocals
 		using BaseType::OutInnerElementCount;
 		using BaseType::OutTriangleCount;
 
-		// Map vertex IDs inserted along the edges to the input mesh triangle ID(s) that share that edge.
-  		TMap<int32, FIndex2i>* VertexEdgeMap; 
-
-		// Map vertex IDs to IDs of the triangles those vertices inserted into.
-  		TMap<int32, int32>* VertexTriangleMap;
-		
 		FMeshVerticesGenerator(const FDynamicMesh3* Mesh, 
 							   const int TessellationNum, 
 							   FProgressCancel* InProgress, 
-  							   TMap<int32, FIndex2i>* VertexEdgeMap,
-  							   TMap<int32, int32>* VertexTriangleMap,
   							   const bool bUseParallel) 
 		:
-		FTrianglesGenerator<RealType, 3>(Mesh, TessellationNum, InProgress, bUseParallel), 
-  		VertexEdgeMap(VertexEdgeMap),
-  		VertexTriangleMap(VertexTriangleMap)
+		FTrianglesGenerator<RealType, 3>(Mesh, TessellationNum, InProgress, bUseParallel)
 		{
 		}
 			
@@ -1062,16 +1279,6 @@ namespace UniformTessellateLocals
 				GetInputMeshElementValue(VertexID, Value);
 				this->SetElement(VertexID, Value);
 			}
-
-			if (VertexEdgeMap) 
-			{
-				VertexEdgeMap->Reserve(OutEdgeElementCount);
-			}
-			
-			if (VertexTriangleMap) 
-			{
-				VertexTriangleMap->Reserve(OutInnerElementCount*InMesh->TriangleCount());
-			}
 		}
 
 		/**
@@ -1112,51 +1319,6 @@ namespace UniformTessellateLocals
 			GetInputMeshElementValue(VertexID, Value);
 		}
 
-		/** Compute the mappings between vertices and triangles of the input and the output meshes. */
-		bool ComputeTopologyMappings() 
-		{	
-			if (VertexEdgeMap) 
-			{
-				for (int32 EdgeID = 0; EdgeID < InMesh->MaxEdgeID(); ++EdgeID)
-				{
-					checkSlow(InMesh->IsEdge(EdgeID));
-					
-					const FIndex2i EdgeTri = InMesh->GetEdgeT(EdgeID);
-
-					for (int VertexOffset = 0; VertexOffset < TessellationNum; ++VertexOffset)
-					{	
-						const int VertexID = this->GetElementIDOnEdge(EdgeID, EdgeTri.A, VertexOffset);
-						VertexEdgeMap->Add(VertexID, EdgeTri);
-					}
-				}
-			}
-
-			if (this->Cancelled()) 
-			{
-				return false;
-			}
-
-			if (VertexTriangleMap) 
-			{			
-				for (int32 TriangleID = 0; TriangleID < InMesh->MaxTriangleID(); ++TriangleID)
-				{
-					checkSlow(InMesh->IsTriangle(TriangleID));
-					
-					int VertexIDCounter = 0;
-					for (int Level = 1; Level < TessellationNum; ++Level)
-					{
-						for (int VertexOffset = 0; VertexOffset < Level; ++VertexOffset, ++VertexIDCounter) 
-						{
-							const int VertexID = this->GetElementIDOnTriangle(TriangleID, VertexIDCounter);
-							VertexTriangleMap->Add(VertexID, TriangleID);
-						}
-					}
-				}
-			}
-			
-			return true;
-		}
-
 		virtual bool Generate() override
 		{	
 			if (this->Validate() == false) 
@@ -1180,11 +1342,6 @@ namespace UniformTessellateLocals
 			{
 				return false;
 			}
-
-			if (ComputeTopologyMappings() == false) 
-			{
-				return false;
-			}
 				
 			return true;
 		}
@@ -1481,12 +1638,13 @@ namespace UniformTessellateLocals
 
 		void CopyToAttribute(TDynamicMeshTriangleAttribute<RealType, ElementSize>* OutAttribute) 
 		{
-			RealType Value[ElementSize];
-			for (int TID = 0; TID < OutTriangleCount; ++TID) 
+			// every triangle has its own slot in the attribute
+			ParallelFor(OutTriangleCount, [&](int32 TID) 
 			{
+				RealType Value[ElementSize];
 				GetElement(TID, Value);
 				OutAttribute->SetValue(TID, Value);
-			}
+			}, this->bUseParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
 		}
 	};
 
@@ -1701,27 +1859,235 @@ namespace UniformTessellateLocals
 		}
 	};
 
+	/** 
+	 * One attribute layer of the result. Generate() only reads the input mesh, so the layers are generated 
+	 * concurrently with each other and with the topology. Enable() adds the layer's storage to the result mesh and 
+	 * has to run alone, Copy() only writes that storage and runs concurrently with the other layers' copies.
+	 */
+	struct FAttributeLayerJob
+	{
+		FString Name;
+		TFunction<bool()> Generate;
+		TFunction<void(FDynamicMesh3*)> Enable;
+		TFunction<void(FDynamicMesh3*)> Copy;
+		double GenerateTime = 0;
+		double CopyTime = 0;
+	};
+
+	/** 
+	 * Add the jobs generating every attribute layer of InMesh except the triangle groups. 
+	 * @param NormalFunction If set, evaluates the new elements of the primary normals and of the per-vertex normals
+	 */
+	void AddAttributeLayerJobs(const FDynamicMesh3* InMesh, 
+							   const int TessellationNum, 
+							   FProgressCancel* Progress, 
+							   const bool bUseParallel,
+							   const bool bVectorLerp,
+							   const TFunction<FVector3f(int32, const FVector3d&)>& NormalFunction,
+							   TArray<FAttributeLayerJob>& OutJobs)
+	{
+		const EParallelForFlags ParallelFlags = bUseParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+
+		TFunction<void(int32, const FVector3d&, float*)> NormalElementFunction;
+		if (NormalFunction) 
+		{
+			NormalElementFunction = [NormalFunction](int32 TriangleID, const FVector3d& BaryCoords, float* OutValue) 
+			{
+				const FVector3f Normal = NormalFunction(TriangleID, BaryCoords);
+				OutValue[0] = Normal.X;
+				OutValue[1] = Normal.Y;
+				OutValue[2] = Normal.Z;
+			};
+		}
+
+		if (InMesh->HasAttributes()) 
+		{	
+			const FDynamicMeshAttributeSet* InAttributes = InMesh->Attributes(); 
+
+			for (int Idx = 0; Idx < InAttributes->NumNormalLayers(); ++Idx) 
+			{	
+				TSharedPtr<FOverlayGenerator<float, 3>> Generator = MakeShared<FOverlayGenerator<float, 3>>(InMesh, TessellationNum, Progress, bUseParallel, InAttributes->GetNormalLayer(Idx));
+				Generator->bVectorLerp = bVectorLerp;
+				if (Idx == 0) 
+				{
+					Generator->ElementFunction = NormalElementFunction;
+				}
+				OutJobs.Add({ FString::Printf(TEXT("NormalLayer%d"), Idx), 
+							  [Generator]() { return Generator->Generate(); },
+							  [Idx](FDynamicMesh3* OutMesh) { OutMesh->Attributes()->SetNumNormalLayers(FMath::Max(OutMesh->Attributes()->NumNormalLayers(), Idx + 1)); },
+							  [Generator, Idx](FDynamicMesh3* OutMesh) { Generator->CopyToAttribute(OutMesh->Attributes()->GetNormalLayer(Idx)); } });
+			}
+
+			for (int Idx = 0; Idx < InAttributes->NumUVLayers(); ++Idx) 
+			{	
+				TSharedPtr<FOverlayGenerator<float, 2>> Generator = MakeShared<FOverlayGenerator<float, 2>>(InMesh, TessellationNum, Progress, bUseParallel, InAttributes->GetUVLayer(Idx));
+				Generator->bVectorLerp = bVectorLerp;
+				OutJobs.Add({ FString::Printf(TEXT("UVLayer%d"), Idx), 
+							  [Generator]() { return Generator->Generate(); },
+							  [Idx](FDynamicMesh3* OutMesh) { OutMesh->Attributes()->SetNumUVLayers(FMath::Max(OutMesh->Attributes()->NumUVLayers(), Idx + 1)); },
+							  [Generator, Idx](FDynamicMesh3* OutMesh) { Generator->CopyToAttribute(OutMesh->Attributes()->GetUVLayer(Idx)); } });
+			}
+
+			if (InAttributes->HasPrimaryColors()) 
+			{
+				TSharedPtr<FOverlayGenerator<float, 4>> Generator = MakeShared<FOverlayGenerator<float, 4>>(InMesh, TessellationNum, Progress, bUseParallel, InAttributes->PrimaryColors());
+				Generator->bVectorLerp = bVectorLerp;
+				OutJobs.Add({ TEXT("PrimaryColors"), 
+							  [Generator]() { return Generator->Generate(); },
+							  [](FDynamicMesh3* OutMesh) { OutMesh->Attributes()->EnablePrimaryColors(); },
+							  [Generator](FDynamicMesh3* OutMesh) { Generator->CopyToAttribute(OutMesh->Attributes()->PrimaryColors()); } });
+			}
+
+			if (InAttributes->HasMaterialID())	 
+			{
+				TSharedPtr<FTriangleAttributeGenerator<int32, 1>> Generator(FTriangleAttributeGenerator<int32, 1>::CreateFromDynamicMeshTriangleAttribute(InMesh, TessellationNum, Progress, bUseParallel, InAttributes->GetMaterialID()).Release());
+				OutJobs.Add({ TEXT("MaterialID"), 
+							  [Generator]() { return Generator->Generate(); },
+							  [](FDynamicMesh3* OutMesh) { OutMesh->Attributes()->EnableMaterialID(); },
+							  [Generator](FDynamicMesh3* OutMesh) { Generator->CopyToAttribute(OutMesh->Attributes()->GetMaterialID()); } });
+			}
+
+			for (int Idx = 0; Idx < InAttributes->NumPolygroupLayers(); ++Idx) 
+			{	
+				TSharedPtr<FTriangleAttributeGenerator<int32, 1>> Generator(FTriangleAttributeGenerator<int32, 1>::CreateFromDynamicMeshTriangleAttribute(InMesh, TessellationNum, Progress, bUseParallel, InAttributes->GetPolygroupLayer(Idx)).Release());
+				OutJobs.Add({ FString::Printf(TEXT("PolygroupLayer%d"), Idx), 
+							  [Generator]() { return Generator->Generate(); },
+							  [Idx](FDynamicMesh3* OutMesh) { OutMesh->Attributes()->SetNumPolygroupLayers(FMath::Max(OutMesh->Attributes()->NumPolygroupLayers(), Idx + 1)); },
+							  [Generator, Idx](FDynamicMesh3* OutMesh) { Generator->CopyToAttribute(OutMesh->Attributes()->GetPolygroupLayer(Idx)); } });
+			}
+
+			for (const TTuple<FName, TUniquePtr<FDynamicMeshVertexSkinWeightsAttribute>>& AttributeInfo : InAttributes->GetSkinWeightsAttributes())
+			{
+				TSharedPtr<FSkinWeightAttributeGenerator> Generator = MakeShared<FSkinWeightAttributeGenerator>(InMesh, TessellationNum, Progress, bUseParallel, AttributeInfo.Value.Get());
+				const FName Name = AttributeInfo.Key;
+				OutJobs.Add({ FString::Printf(TEXT("SkinWeights %s"), *Name.ToString()), 
+							  [Generator]() { return Generator->Generate(); },
+							  [Name](FDynamicMesh3* OutMesh) { OutMesh->Attributes()->AttachSkinWeightsAttribute(Name, new FDynamicMeshVertexSkinWeightsAttribute(OutMesh)); },
+							  [Generator, Name](FDynamicMesh3* OutMesh) { Generator->CopyToAttribute(OutMesh->Attributes()->GetSkinWeightsAttribute(Name)); } });
+			}
+		}
+
+		if (InMesh->HasVertexNormals()) 
+		{	
+			TSharedPtr<FVertexAttributeGenerator<float, 3>> Generator(FVertexAttributeGenerator<float, 3>::CreateFromPerVertexNormals(InMesh, TessellationNum, Progress, bUseParallel).Release());
+			Generator->bVectorLerp = bVectorLerp;
+			Generator->ElementFunction = NormalElementFunction;
+			OutJobs.Add({ TEXT("VertexNormals"), 
+						  [Generator]() { return Generator->Generate(); },
+						  [](FDynamicMesh3* OutMesh) { OutMesh->EnableVertexNormals(FVector3f::Zero()); },
+						  [Generator, ParallelFlags](FDynamicMesh3* OutMesh) 
+						  { 
+							  ParallelFor(OutMesh->MaxVertexID(), [&](int32 Idx) 
+							  {
+								  OutMesh->SetVertexNormal(Idx, Generator->GetElement<FVector3f>(Idx));
+							  }, ParallelFlags);
+						  } });
+		}
+
+		if (InMesh->HasVertexUVs()) 
+		{	
+			TSharedPtr<FVertexAttributeGenerator<float, 2>> Generator(FVertexAttributeGenerator<float, 2>::CreateFromPerVertexUVs(InMesh, TessellationNum, Progress, bUseParallel).Release());
+			Generator->bVectorLerp = bVectorLerp;
+			OutJobs.Add({ TEXT("VertexUVs"), 
+						  [Generator]() { return Generator->Generate(); },
+						  [](FDynamicMesh3* OutMesh) { OutMesh->EnableVertexUVs(FVector2f::Zero()); },
+						  [Generator, ParallelFlags](FDynamicMesh3* OutMesh) 
+						  { 
+							  ParallelFor(OutMesh->MaxVertexID(), [&](int32 Idx) 
+							  {
+								  OutMesh->SetVertexUV(Idx, Generator->GetElement<FVector2f>(Idx));
+							  }, ParallelFlags);
+						  } });
+		}
+
+		if (InMesh->HasVertexColors()) 
+		{	
+			TSharedPtr<FVertexAttributeGenerator<float, 4>> Generator(FVertexAttributeGenerator<float, 4>::CreateFromPerVertexColors(InMesh, TessellationNum, Progress, bUseParallel).Release());
+			Generator->bVectorLerp = bVectorLerp;
+			OutJobs.Add({ TEXT("VertexColors"), 
+						  [Generator]() { return Generator->Generate(); },
+						  [](FDynamicMesh3* OutMesh) { OutMesh->EnableVertexColors(FVector4f::Zero()); },
+						  [Generator, ParallelFlags](FDynamicMesh3* OutMesh) 
+						  { 
+							  ParallelFor(OutMesh->MaxVertexID(), [&](int32 Idx) 
+							  {
+								  OutMesh->SetVertexColor(Idx, Generator->GetElement<FVector4f>(Idx));
+							  }, ParallelFlags);
+						  } });
+		}
+	}
+
 	bool Tessellate(const FDynamicMesh3* InMesh, 
 				   const int TessellationNum, 
 				   FProgressCancel* Progress, 
 				   const bool bUseParallel,
-				   TMap<int32, FIndex2i>* OutVertexEdgeMap,
-				   TMap<int32, int32>* OutVertexTriangleMap, 
+				   const bool bBulkAssembly,
+				   const bool bVectorLerp,
+				   const TFunction<FVector3d(int32, const FVector3d&)>& PositionFunction,
+				   const TFunction<FVector3f(int32, const FVector3d&)>& NormalFunction,
+				   FDpUniformTessellate::FStageTimings& OutTimings,
 				   FDynamicMesh3* OutMesh) 
 	{	
 		OutMesh->Clear();
+		OutTimings = FDpUniformTessellate::FStageTimings();
+		const double StartTime = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
+		auto Now = []() { return FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64()); };
+
+		TArray<FAttributeLayerJob> Jobs;
+		AddAttributeLayerJobs(InMesh, TessellationNum, Progress, bUseParallel, bVectorLerp, NormalFunction, Jobs);
 
-		FMeshVerticesGenerator<double> FTrianglesGenerator(InMesh, TessellationNum, Progress, OutVertexEdgeMap, OutVertexTriangleMap, bUseParallel);
+		// Generate the attribute layers on the task graph while this thread builds the topology. Each generator
+		// still runs its own ParallelFor, the tasks only remove the barrier between the layers. Single threaded,
+		// every layer is generated and copied in turn later on, so only one layer is held in memory at a time.
+		TArray<TFuture<bool>> JobFutures;
+		if (bUseParallel) 
+		{
+			for (FAttributeLayerJob& Job : Jobs) 
+			{
+				FAttributeLayerJob* JobPtr = &Job;
+				JobFutures.Add(Async(EAsyncExecution::TaskGraph, [JobPtr, Now]() 
+				{
+					const double JobStartTime = Now();
+					const bool bGenerated = JobPtr->Generate();
+					JobPtr->GenerateTime = Now() - JobStartTime;
+					return bGenerated;
+				}));
+			}
+		}
+
+		// Jobs must not outlive the references they hold, wait for all of them on every exit path
+		auto WaitForJobs = [&JobFutures]() 
+		{
+			bool bAllGenerated = true;
+			for (TFuture<bool>& Future : JobFutures) 
+			{
+				bAllGenerated = Future.Get() && bAllGenerated;
+			}
+			JobFutures.Empty();
+			return bAllGenerated;
+		};
+
+		FMeshVerticesGenerator<double> FTrianglesGenerator(InMesh, TessellationNum, Progress, bUseParallel);
+		FTrianglesGenerator.bVectorLerp = bVectorLerp;
+		if (PositionFunction) 
+		{
+			FTrianglesGenerator.ElementFunction = [&PositionFunction](int32 TriangleID, const FVector3d& BaryCoords, double* OutValue) 
+			{
+				const FVector3d Position = PositionFunction(TriangleID, BaryCoords);
+				OutValue[0] = Position.X;
+				OutValue[1] = Position.Y;
+				OutValue[2] = Position.Z;
+			};
+		}
 		if (FTrianglesGenerator.Generate() == false) 
 		{
+			WaitForJobs();
 			return false;
 		}
 		
 		const int NumVerts = FTrianglesGenerator.OutElementCount;
-		for (int Idx = 0; Idx < NumVerts; ++Idx)
-		{
-			OutMesh->AppendVertex(FTrianglesGenerator.GetElement<FVector3d>(Idx));
-		}
+		OutTimings.TopologyTime = Now() - StartTime;
+		const double AssemblyStartTime = Now();
 
 		TUniquePtr<FTriangleAttributeGenerator<int, 1>> TriangleGroupGenerator;
 		if (InMesh->HasTriangleGroups()) 
@@ -1729,194 +2095,186 @@ namespace UniformTessellateLocals
 			TriangleGroupGenerator = FTriangleAttributeGenerator<int, 1>::CreateFromMeshTriangleGroups(InMesh, TessellationNum, Progress, bUseParallel);
 			if (TriangleGroupGenerator->Generate() == false) 
 			{
+				WaitForJobs();
 				return false;
 			} 
-
-			OutMesh->EnableTriangleGroups();
-		}
-
-		for (int Idx = 0; Idx < FTrianglesGenerator.Triangles.Num(); ++Idx)
-		{
-			int PolyID = 0; 
-			if (OutMesh->HasTriangleGroups() && TriangleGroupGenerator != nullptr) 
-			{
-				TriangleGroupGenerator->GetElement(Idx, &PolyID);
-			} 
-
-			ensure(OutMesh->AppendTriangle(FTrianglesGenerator.Triangles[Idx], PolyID) == Idx);
 		}
 
-		if (OutMesh->TriangleCount() != FTrianglesGenerator.Triangles.Num()) 
+		if (bBulkAssembly) 
 		{
-			return false;
-		}
-
-		if (InMesh->HasAttributes()) 
-		{	
-			OutMesh->EnableAttributes(); 
-
-			const FDynamicMeshAttributeSet* InAttributes = InMesh->Attributes(); 
-			FDynamicMeshAttributeSet* OutAttributes = OutMesh->Attributes(); 
-			
-			if (InAttributes->NumNormalLayers()) 
+			TFunction<int32(int32)> TriangleGroup;
+			if (TriangleGroupGenerator != nullptr) 
 			{
-				OutAttributes->SetNumNormalLayers(InAttributes->NumNormalLayers());
-				for (int Idx = 0; Idx < InAttributes->NumNormalLayers(); ++Idx) 
-				{	
-					FOverlayGenerator<float, 3> Generator(InMesh, TessellationNum, Progress, bUseParallel, InAttributes->GetNormalLayer(Idx));
-					if (Generator.Generate() == false) 
-					{
-						return false;
-					}
-
-					Generator.CopyToAttribute(OutAttributes->GetNormalLayer(Idx));
-				} 
+				TriangleGroup = [&TriangleGroupGenerator](int32 TriangleID) 
+				{
+					int PolyID = 0;
+					TriangleGroupGenerator->GetElement(TriangleID, &PolyID);
+					return PolyID;
+				};
 			}
 
-			if (InAttributes->NumUVLayers()) 
+			if (FDpBulkMeshBuilder::Build(*OutMesh,
+										  NumVerts, 
+										  [&FTrianglesGenerator](int32 VertexID) { return FTrianglesGenerator.GetElement<FVector3d>(VertexID); },
+										  FTrianglesGenerator.Triangles, 
+										  TriangleGroup, 
+										  bUseParallel) == false) 
 			{
-				OutAttributes->SetNumUVLayers(InAttributes->NumUVLayers());
-				for (int Idx = 0; Idx < InAttributes->NumUVLayers(); ++Idx) 
-				{	
-					FOverlayGenerator<float, 2> Generator(InMesh, TessellationNum, Progress, bUseParallel, InAttributes->GetUVLayer(Idx));
-					if (Generator.Generate() == false) 
-					{
-						return false;
-					}
-
-					Generator.CopyToAttribute(OutAttributes->GetUVLayer(Idx));
-				}
+				WaitForJobs();
+				return false;
 			}
-
-			if (InAttributes->HasPrimaryColors()) 
+		}
+		else 
+		{
+			for (int Idx = 0; Idx < NumVerts; ++Idx)
 			{
-				OutAttributes->EnablePrimaryColors();
-				FOverlayGenerator<float, 4> Generator(InMesh, TessellationNum, Progress, bUseParallel, InAttributes->PrimaryColors());
-				if (Generator.Generate() == false)
-				{
-					return false;
-				}
-
-				Generator.CopyToAttribute(OutAttributes->PrimaryColors());
+				OutMesh->AppendVertex(FTrianglesGenerator.GetElement<FVector3d>(Idx));
 			}
 
-			if (InAttributes->HasMaterialID())	 
+			if (TriangleGroupGenerator != nullptr) 
 			{
-				OutAttributes->EnableMaterialID();
-				TUniquePtr<FTriangleAttributeGenerator<int32, 1>> Generator; 
-				Generator = FTriangleAttributeGenerator<int32, 1>::CreateFromDynamicMeshTriangleAttribute(InMesh, TessellationNum, Progress, bUseParallel, InAttributes->GetMaterialID());
-				if (Generator->Generate() == false)
-				{
-					return false;
-				}
-
-				Generator->CopyToAttribute(OutAttributes->GetMaterialID());
+				OutMesh->EnableTriangleGroups();
 			}
 
-			if (InAttributes->NumPolygroupLayers())  
+			for (int Idx = 0; Idx < FTrianglesGenerator.Triangles.Num(); ++Idx)
 			{
-				OutAttributes->SetNumPolygroupLayers(InAttributes->NumPolygroupLayers());
-				for (int Idx = 0; Idx < InAttributes->NumPolygroupLayers(); ++Idx) 
-				{	
-					TUniquePtr<FTriangleAttributeGenerator<int32, 1>> Generator;
-					Generator = FTriangleAttributeGenerator<int32, 1>::CreateFromDynamicMeshTriangleAttribute(InMesh, TessellationNum, Progress, bUseParallel, InAttributes->GetPolygroupLayer(Idx));
-					if (Generator->Generate() == false) 
-					{
-						return false;
-					}
+				int PolyID = 0; 
+				if (OutMesh->HasTriangleGroups() && TriangleGroupGenerator != nullptr) 
+				{
+					TriangleGroupGenerator->GetElement(Idx, &PolyID);
+				} 
 
-					Generator->CopyToAttribute(OutAttributes->GetPolygroupLayer(Idx));
-				}
+				ensure(OutMesh->AppendTriangle(FTrianglesGenerator.Triangles[Idx], PolyID) == Idx);
 			}
+		}
 
-			for (const TTuple<FName, TUniquePtr<FDynamicMeshVertexSkinWeightsAttribute>>& AttributeInfo : InAttributes->GetSkinWeightsAttributes())
-			{
-				FSkinWeightAttributeGenerator Generator(InMesh, TessellationNum, Progress, bUseParallel, AttributeInfo.Value.Get());
-				if (Generator.Generate() == false) 
-				{
-					return false;
-				}
+		if (OutMesh->TriangleCount() != FTrianglesGenerator.Triangles.Num()) 
+		{
+			WaitForJobs();
+			return false;
+		}
+		OutTimings.AssemblyTime = Now() - AssemblyStartTime;
 
-				FDynamicMeshVertexSkinWeightsAttribute* SkinAttribute = new FDynamicMeshVertexSkinWeightsAttribute(OutMesh);			
-				Generator.CopyToAttribute(SkinAttribute);
+		const double WaitStartTime = Now();
+		if (WaitForJobs() == false) 
+		{
+			return false;
+		}
+		OutTimings.AttributeWaitTime = Now() - WaitStartTime;
 
-				OutAttributes->AttachSkinWeightsAttribute(AttributeInfo.Key, SkinAttribute);
-			}
+		// Add the storage of every layer first, then fill the layers concurrently
+		const double CopyStartTime = Now();
+		if (InMesh->HasAttributes()) 
+		{
+			OutMesh->EnableAttributes(); 
 		}
 
-		if (InMesh->HasVertexNormals()) 
-		{	
-			TUniquePtr<FVertexAttributeGenerator<float, 3>> Generator;
-			Generator = FVertexAttributeGenerator<float, 3>::CreateFromPerVertexNormals(InMesh, TessellationNum, Progress, bUseParallel);
-			if (Generator->Generate() == false) 
+		if (bUseParallel) 
+		{
+			for (FAttributeLayerJob& Job : Jobs) 
 			{
-				return false;
+				Job.Enable(OutMesh);
 			}
 
-			OutMesh->EnableVertexNormals(FVector3f::Zero());
-			
-			for (int Idx = 0; Idx < NumVerts; ++Idx) 
+			ParallelFor(Jobs.Num(), [&](int32 JobIndex) 
 			{
-				OutMesh->SetVertexNormal(Idx, Generator->GetElement<FVector3f>(Idx));
-			}
+				const double JobStartTime = Now();
+				Jobs[JobIndex].Copy(OutMesh);
+				Jobs[JobIndex].CopyTime = Now() - JobStartTime;
+			});
 		}
-
-		if (InMesh->HasVertexUVs()) 
-		{	
-			TUniquePtr<FVertexAttributeGenerator<float, 2>> Generator; 
-			Generator = FVertexAttributeGenerator<float, 2>::CreateFromPerVertexUVs(InMesh, TessellationNum, Progress, bUseParallel);
-			if (Generator->Generate() == false) 
+		else 
+		{
+			for (FAttributeLayerJob& Job : Jobs) 
 			{
-				return false;
-			}
+				double JobStartTime = Now();
+				if (Job.Generate() == false) 
+				{
+					return false;
+				}
+				Job.GenerateTime = Now() - JobStartTime;
 
-			OutMesh->EnableVertexUVs(FVector2f::Zero());
+				JobStartTime = Now();
+				Job.Enable(OutMesh);
+				Job.Copy(OutMesh);
+				Job.CopyTime = Now() - JobStartTime;
 
-			for (int Idx = 0; Idx < NumVerts; ++Idx) 
-			{
-				OutMesh->SetVertexUV(Idx, Generator->GetElement<FVector2f>(Idx));
+				// release the generator
+				Job.Generate = nullptr;
+				Job.Copy = nullptr;
 			}
 		}
+		OutTimings.AttributeCopyTime = Now() - CopyStartTime;
 
-		if (InMesh->HasVertexColors()) 
-		{	
-			TUniquePtr<FVertexAttributeGenerator<float, 4>> Generator;
-			Generator  = FVertexAttributeGenerator<float, 4>::CreateFromPerVertexColors(InMesh, TessellationNum, Progress, bUseParallel);
-			if (Generator->Generate() == false) 
-			{
-				return false;
-			}
-
-			OutMesh->EnableVertexColors(FVector4f::Zero());
-
-			for (int Idx = 0; Idx < NumVerts; ++Idx) 
-			{
-				OutMesh->SetVertexColor(Idx, Generator->GetElement<FVector4f>(Idx));
-			}
+		for (const FAttributeLayerJob& Job : Jobs) 
+		{
+			OutTimings.Layers.Add({ Job.Name, Job.GenerateTime, Job.CopyTime });
 		}
+		OutTimings.TotalTime = Now() - StartTime;
 
 		return true; 
 	}
 
 }
 
-int32 FDpUniformTessellate::ExpectedNumVertices(const FDynamicMesh3& Mesh, const int32 TessellationNum)
+int64 FDpUniformTessellate::ExpectedNumVertices(const FDynamicMesh3& Mesh, const int32 TessellationNum)
 {
-	int32 EdgeVertCount = TessellationNum * Mesh.EdgeCount();
-	int32 TriangleNumber = TessellationNum + 2; // plus 2 corner vertices on the edge ends
-	int32 InnerTriangleVertCount = UniformTessellateLocals::TriangularPatternUtils::NumInnerVertices(TriangleNumber);
-	int32 TotalVertCount = Mesh.VertexCount() + EdgeVertCount + InnerTriangleVertCount* Mesh.TriangleCount();
+	// Same as the TriangularPatternUtils counts, in 64 bit
+	const int64 EdgeVertCount = (int64)TessellationNum * Mesh.EdgeCount();
+	const int64 InnerTriangleVertCount = (int64)TessellationNum * (TessellationNum - 1) / 2;
+	const int64 TotalVertCount = Mesh.VertexCount() + EdgeVertCount + InnerTriangleVertCount * Mesh.TriangleCount();
 	return TotalVertCount; 	
 }
 	
-int32 FDpUniformTessellate::ExpectedNumTriangles(const FDynamicMesh3& Mesh, const int32 TessellationNum)
+int64 FDpUniformTessellate::ExpectedNumTriangles(const FDynamicMesh3& Mesh, const int32 TessellationNum)
 {
-	int32 TriangleNumber = TessellationNum + 2; // plus 2 corner vertices on the edge ends
-	int32 InnerTriangleCount = UniformTessellateLocals::TriangularPatternUtils::NumTriangles(TriangleNumber);
-	int32 TotalTriangleCount = InnerTriangleCount * Mesh.TriangleCount();
+	const int64 InnerTriangleCount = ((int64)TessellationNum + 1) * ((int64)TessellationNum + 1);
+	const int64 TotalTriangleCount = InnerTriangleCount * Mesh.TriangleCount();
 	return TotalTriangleCount;
 }
 
+int32 FDpUniformTessellate::MaxTessellationNum(const FDynamicMesh3& Mesh, const int64 TriangleBudget)
+{
+	const int64 NumTriangles = FMath::Max(Mesh.TriangleCount(), 1);
+	if (TriangleBudget < NumTriangles) 
+	{
+		return -1;
+	}
+
+	// (N + 1)^2 triangles per input triangle, the square root can be off by one either way
+	int64 Level = FMath::Min((int64)FMath::Sqrt((double)(TriangleBudget / NumTriangles)) - 1, (int64)MAX_int32 - 1);
+	while (Level > 0 && ExpectedNumTriangles(Mesh, (int32)Level) > TriangleBudget) 
+	{
+		--Level;
+	}
+	while (Level + 1 < MAX_int32 && ExpectedNumTriangles(Mesh, (int32)Level + 1) <= TriangleBudget) 
+	{
+		++Level;
+	}
+	return (int32)FMath::Max(Level, (int64)0);
+}
+
+int32 FDpUniformTessellate::MaxChunkTessellationNum(const int64 ChunkTriangleBudget)
+{
+	const int64 Budget = FMath::Min(ChunkTriangleBudget, MaxResultTriangles);
+	if (Budget < 1) 
+	{
+		return -1;
+	}
+
+	// (N + 1)^2 triangles per input triangle, the square root can be off by one either way
+	int64 Level = (int64)FMath::Sqrt((double)Budget) - 1;
+	while (Level > 0 && (Level + 1) * (Level + 1) > Budget) 
+	{
+		--Level;
+	}
+	while ((Level + 2) * (Level + 2) <= Budget) 
+	{
+		++Level;
+	}
+	return (int32)FMath::Max(Level, (int64)0);
+}
+
 bool FDpUniformTessellate::Cancelled()
 {
 	return (Progress == nullptr) ? false : Progress->Cancelled();
@@ -1929,19 +2287,26 @@ bool FDpUniformTessellate::Compute()
 		return false;
 	}
 
-	if (TessellationNum == 0)
+	// Refuse or clamp results that do not fit in the budget before allocating anything
+	const FDynamicMesh3& Source = bInPlace ? *ResultMesh : *Mesh;
+	ResultTessellationNum = TessellationNum;
+	if (ExpectedNumTriangles(Source, TessellationNum) > GetClampedTriangleBudget()) 
 	{
-		return true; 
-	}
-
-	// Check for the empty meshes
-	if (bInPlace && ResultMesh->TriangleCount() == 0) 
-	{
-		return true;
+		ResultTessellationNum = bClampToBudget ? MaxTessellationNum(Source, GetClampedTriangleBudget()) : -1;
+		if (ResultTessellationNum < 0) 
+		{
+			return false;
+		}
 	}
 
-	if (bInPlace == false && Mesh->TriangleCount() == 0) 
+	// Nothing to generate, the result is the input mesh. Tessellating in place it already is.
+	if (ResultTessellationNum == 0 || Source.TriangleCount() == 0)
 	{
+		ResetMappings();
+		if (bInPlace == false)
+		{
+			ResultMesh->Copy(*Mesh);
+		}
 		return true;
 	}
 
@@ -1955,29 +2320,32 @@ bool FDpUniformTessellate::Compute()
 	}
 
 	ResultMesh->Clear();
-	VertexMap.Empty();
-	VertexEdgeMap.Empty();
-	VertexTriangleMap.Empty();
+	ResetMappings();
 	
 	bool bIsValidMesh = false;
 
 	if (Mesh->IsCompact()) 
 	{
 		bIsValidMesh = UniformTessellateLocals::Tessellate(Mesh, 
-														   TessellationNum, 
+														   ResultTessellationNum, 
 														   Progress, 
 														   bUseParallel, 
-														   bComputeMappings ? &VertexEdgeMap : nullptr, 
-														   bComputeMappings ? &VertexTriangleMap : nullptr, 
+														   bBulkAssembly,
+														   bVectorLerp,
+														   PositionFunction,
+														   NormalFunction,
+														   Timings,
 														   ResultMesh);
 
 		if (bIsValidMesh && bComputeMappings) 
 		{
 			VertexMap.SetNumUninitialized(Mesh->MaxVertexID());
-			for (int32 VertexID = 0; VertexID < Mesh->MaxVertexID(); ++VertexID)
+			ParallelFor(Mesh->MaxVertexID(), [&](int32 VertexID)
 			{
 				VertexMap[VertexID] = VertexID; 
-			}
+			}, bUseParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+			InitializeMappings(*Mesh, nullptr);
 		}
 	}
 	else 
@@ -1986,64 +2354,61 @@ bool FDpUniformTessellate::Compute()
 		FCompactMaps CompactInfo;
 		CompactMesh.CompactCopy(*Mesh, true, true, true, true, &CompactInfo);
 
+		// The inverse of the FCompactMaps triangle mapping. The tessellation runs on the compact mesh, the mappings
+		// and the position and normal functions report the input mesh triangles.
+		TArray<int32> CompactToInputTriangles;
+		if (bComputeMappings || PositionFunction || NormalFunction) 
+		{
+			CompactToInputTriangles.Init(FDynamicMesh3::InvalidID, CompactMesh.MaxTriangleID());
+			for (int32 TriangleID : Mesh->TriangleIndicesItr()) 
+			{
+				const int32 CompactTriangleID = CompactInfo.GetTriangleMapping(TriangleID);
+				if (CompactTriangleID != FCompactMaps::InvalidID)
+				{
+					CompactToInputTriangles[CompactTriangleID] = TriangleID;
+				}
+			}
+		}
+
+		TFunction<FVector3d(int32, const FVector3d&)> CompactPositionFunction;
+		if (PositionFunction) 
+		{
+			CompactPositionFunction = [this, &CompactToInputTriangles](int32 CompactTriangleID, const FVector3d& BaryCoords) 
+			{
+				return PositionFunction(CompactToInputTriangles[CompactTriangleID], BaryCoords);
+			};
+		}
+
+		TFunction<FVector3f(int32, const FVector3d&)> CompactNormalFunction;
+		if (NormalFunction) 
+		{
+			CompactNormalFunction = [this, &CompactToInputTriangles](int32 CompactTriangleID, const FVector3d& BaryCoords) 
+			{
+				return NormalFunction(CompactToInputTriangles[CompactTriangleID], BaryCoords);
+			};
+		}
+
 		bIsValidMesh = UniformTessellateLocals::Tessellate(&CompactMesh, 
-														   TessellationNum, 
+														   ResultTessellationNum, 
 														   Progress, 
 														   bUseParallel, 
-														   bComputeMappings ? &VertexEdgeMap : nullptr, 
-														   bComputeMappings ? &VertexTriangleMap : nullptr, 
+														   bBulkAssembly,
+														   bVectorLerp,
+														   CompactPositionFunction,
+														   CompactNormalFunction,
+														   Timings,
 														   ResultMesh);
 
 
 		if (bIsValidMesh && bComputeMappings) 
 		{	
 			VertexMap.SetNumUninitialized(Mesh->MaxVertexID());
-			for (int32 VertexID = 0; VertexID < Mesh->MaxVertexID(); ++VertexID)
+			ParallelFor(Mesh->MaxVertexID(), [&](int32 VertexID)
 			{
 				VertexMap[VertexID] = CompactInfo.GetVertexMapping(VertexID); 
-			}
-			
-			// Compute an additional mapping from the compact mesh triangles to the input mesh triangles 
-			// i.e the inverse of the FCompactMaps
-			TMap<int32, int32> CompactToInputTriangles;
-			CompactToInputTriangles.Reserve(CompactMesh.TriangleCount());
-			for (int32 TriangleID : Mesh->TriangleIndicesItr()) 
-			{
-				const int32 CompactTriangleID = CompactInfo.GetTriangleMapping(TriangleID);
-				if (CompactTriangleID != FCompactMaps::InvalidID)
-				{
-					CompactToInputTriangles.Add(CompactTriangleID, TriangleID);
-				}
-			}
-			checkSlow(CompactToInputTriangles.Num() == CompactMesh.TriangleCount());
-				
-			// Chage the mapping [tessellated triangles --> compact mesh triangles]
-			// to the mapping [tessellated triangles --> input mesh triangles (before compacting)]
-			for (TMap<int32, FIndex2i>::TIterator It = VertexEdgeMap.CreateIterator(); It; ++It)
-			{
-				FIndex2i& EdgeTri = It.Value();
-				
-				// We should always be able to find the correct match, but double check in case the Tessellate method
-				// failed to return the correct mapping
-				int32* TID1= CompactToInputTriangles.Find(EdgeTri.A);
-				ensure(TID1 != nullptr);
-				EdgeTri.A = TID1 != nullptr ? *TID1 : EdgeTri.A;
-				
-				if (EdgeTri.B != FDynamicMesh3::InvalidID) 
-				{
-					int32* TID2 = CompactToInputTriangles.Find(EdgeTri.B);
-					ensure(TID2 != nullptr);
-					EdgeTri.B = TID2 != nullptr ? *TID2 : EdgeTri.B;
-				}
-			}
+			}, bUseParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
 
-			for (TMap<int32, int32>::TIterator It = VertexTriangleMap.CreateIterator(); It; ++It)
-			{
-				int32& CompactTriID = It.Value();
-				int32* TID1 = CompactToInputTriangles.Find(CompactTriID);
-				ensure(TID1 != nullptr);
-				CompactTriID = TID1 != nullptr ? *TID1 : CompactTriID;
-			}
+			InitializeMappings(CompactMesh, &CompactToInputTriangles);
 		}
 	}
 
@@ -2059,12 +2424,123 @@ bool FDpUniformTessellate::Compute()
 			ResultMesh->Clear();
 		}
 
-		VertexMap.Empty();
-		VertexEdgeMap.Empty();
-		VertexTriangleMap.Empty();
+		ResetMappings();
 		
 		return false;
 	}
 	
 	return true;
-}
\ No newline at end of file
+}
+
+void FDpUniformTessellate::ResetMappings()
+{
+	VertexMap.Empty();
+	EdgeTriangles.Empty();
+	InputTriangles.Empty();
+	FirstEdgeVertexID = FirstTriangleVertexID = EndNewVertexID = 0;
+	NumEdgeVerticesPerEdge = NumVerticesPerTriangle = 0;
+}
+
+void FDpUniformTessellate::InitializeMappings(const FDynamicMesh3& TessellatedMesh, const TArray<int32>* CompactToInputTriangles)
+{
+	// The generators place the vertices in three contiguous ranges: the input vertices, ResultTessellationNum 
+	// vertices per input edge in edge ID order and the inner vertices of every input triangle in triangle ID order
+	NumEdgeVerticesPerEdge = ResultTessellationNum;
+	NumVerticesPerTriangle = ResultTessellationNum * (ResultTessellationNum - 1) / 2;
+	FirstEdgeVertexID = TessellatedMesh.VertexCount();
+	FirstTriangleVertexID = FirstEdgeVertexID + NumEdgeVerticesPerEdge * TessellatedMesh.EdgeCount();
+	EndNewVertexID = FirstTriangleVertexID + NumVerticesPerTriangle * TessellatedMesh.TriangleCount();
+
+	auto ToInputTriangle = [CompactToInputTriangles](int32 TriangleID) 
+	{
+		return (CompactToInputTriangles != nullptr && TriangleID != FDynamicMesh3::InvalidID) ? (*CompactToInputTriangles)[TriangleID] : TriangleID;
+	};
+
+	const EParallelForFlags ParallelFlags = bUseParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+	EdgeTriangles.SetNumUninitialized(TessellatedMesh.MaxEdgeID());
+	ParallelFor(TessellatedMesh.MaxEdgeID(), [&](int32 EdgeID)
+	{
+		checkSlow(TessellatedMesh.IsEdge(EdgeID));
+		const FIndex2i EdgeTri = TessellatedMesh.GetEdgeT(EdgeID);
+		EdgeTriangles[EdgeID] = FIndex2i(ToInputTriangle(EdgeTri.A), ToInputTriangle(EdgeTri.B));
+	}, ParallelFlags);
+
+	InputTriangles.SetNumUninitialized(TessellatedMesh.MaxTriangleID());
+	ParallelFor(TessellatedMesh.MaxTriangleID(), [&](int32 TriangleID)
+	{
+		InputTriangles[TriangleID] = ToInputTriangle(TriangleID);
+	}, ParallelFlags);
+}
+
+bool FDpUniformTessellate::ForEachChunkSubmesh(const FDynamicMesh3& Source, const int32 TessellationNum, const int64 ChunkTriangleBudget, 
+	TFunctionRef<bool(const FDynamicMesh3& Submesh)> SubmeshCallback)
+{
+	const int64 ChunkBudget = FMath::Min(ChunkTriangleBudget, MaxResultTriangles);
+	const int64 TrianglesPerInputTriangle = ((int64)TessellationNum + 1) * ((int64)TessellationNum + 1);
+	if (TessellationNum < 0 || TrianglesPerInputTriangle > ChunkBudget) 
+	{
+		return false;
+	}
+	const int32 InputTrianglesPerChunk = (int32)FMath::Min(ChunkBudget / TrianglesPerInputTriangle, (int64)MAX_int32);
+
+	TArray<int> ChunkTriangles;
+	ChunkTriangles.Reserve(FMath::Min(InputTrianglesPerChunk, Source.TriangleCount()));
+
+	auto EmitChunk = [&]() 
+	{
+		FDynamicSubmesh3 Submesh(&Source, ChunkTriangles);
+		ChunkTriangles.Reset();
+		return SubmeshCallback(Submesh.GetSubmesh());
+	};
+
+	for (int32 TriangleID : Source.TriangleIndicesItr()) 
+	{
+		ChunkTriangles.Add(TriangleID);
+		if (ChunkTriangles.Num() == InputTrianglesPerChunk && EmitChunk() == false) 
+		{
+			return false;
+		}
+	}
+
+	return ChunkTriangles.Num() == 0 || EmitChunk();
+}
+
+bool FDpUniformTessellate::ComputeChunks(const int64 ChunkTriangleBudget, TFunctionRef<bool(FDynamicMesh3& Chunk, int32 ChunkIndex)> ChunkCallback)
+{
+	const bool bIsInvalid = bInPlace ? ResultMesh == nullptr : Mesh == nullptr;
+	if (TessellationNum < 0 || bIsInvalid || PositionFunction || NormalFunction) 
+	{
+		return false; // the chunks are tessellated from submeshes, whose triangle IDs the functions would not know
+	}
+
+	const FDynamicMesh3& Source = bInPlace ? *ResultMesh : *Mesh;
+	const int64 ChunkBudget = FMath::Min(ChunkTriangleBudget, MaxResultTriangles);
+	int32 ChunkIndex = 0;
+
+	const bool bChunked = ForEachChunkSubmesh(Source, TessellationNum, ChunkBudget, [&](const FDynamicMesh3& Submesh)
+	{
+		FDynamicMesh3 Chunk;
+		if (TessellationNum == 0) 
+		{
+			Chunk.Copy(Submesh);
+		}
+		else 
+		{
+			FDpUniformTessellate ChunkTessellator(&Submesh, &Chunk);
+			ChunkTessellator.Progress = Progress;
+			ChunkTessellator.TessellationNum = TessellationNum;
+			ChunkTessellator.bUseParallel = bUseParallel;
+			ChunkTessellator.bBulkAssembly = bBulkAssembly;
+			ChunkTessellator.bVectorLerp = bVectorLerp;
+			ChunkTessellator.TriangleBudget = ChunkBudget;
+			if (ChunkTessellator.Validate() != EOperationValidationResult::Ok || ChunkTessellator.Compute() == false) 
+			{
+				return false;
+			}
+		}
+
+		return ChunkCallback(Chunk, ChunkIndex++);
+	});
+
+	return bChunked && Cancelled() == false;
+}
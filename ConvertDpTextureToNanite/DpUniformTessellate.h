@@ -51,9 +51,46 @@ public:
 	/** Should multi-threading be enabled. */
 	bool bUseParallel = true;
 
-	/** If true, populate VertexMap, VertexEdgeMap, VertexTriangleMap. */
+	/** If true, populate VertexMap and the new vertex mappings (GetVertexEdgeTriangles, GetVertexTriangle ...). */
 	bool bComputeMappings = false;
 
+	/** 
+	 * Build the result topology in bulk (parallel edge construction) instead of appending the triangles one by one.
+	 * Only disable this to compare against the incremental assembly.
+	 */
+	bool bBulkAssembly = true;
+
+	/** 
+	 * Lerp the rows of the barycentric lattice 4 points at a time with the platform vector registers. Only disable 
+	 * this to compare against the scalar lerp, see DpNanite.BenchmarkLatticeLerp.
+	 */
+	bool bVectorLerp = true;
+
+	/** 
+	 * Upper bound on the number of triangles of the result. A result above it is refused by Validate(), or built 
+	 * with a lower TessellationNum if bClampToBudget is set. Never above MaxResultTriangles.
+	 */
+	int64 TriangleBudget = MaxResultTriangles;
+
+	/** Lower TessellationNum until the result fits in TriangleBudget instead of refusing to tessellate. */
+	bool bClampToBudget = false;
+
+	/**
+	 * If set, every new vertex is placed at PositionFunction(InputTriangleID, BaryCoords) instead of being linearly 
+	 * interpolated, e.g. to evaluate a curved patch over each input triangle while tessellating instead of 
+	 * displacing the result afterwards. BaryCoords are relative to the triangle vertices in GetTriangle() order. 
+	 * Vertices on an input edge are evaluated on its first triangle only, so the function has to agree along shared 
+	 * edges for the result to be watertight. Called concurrently if bUseParallel is set. Not supported by ComputeChunks().
+	 */
+	TFunction<FVector3d(int32 TriangleID, const FVector3d& BaryCoords)> PositionFunction;
+
+	/**
+	 * If set, the new elements of the primary normal overlay and the new per-vertex normals are 
+	 * NormalFunction(InputTriangleID, BaryCoords) instead of being linearly interpolated. Along a normal seam each 
+	 * side is evaluated on its own triangle, so split normals stay split. Same rules as PositionFunction otherwise.
+	 */
+	TFunction<FVector3f(int32 TriangleID, const FVector3d& BaryCoords)> NormalFunction;
+
 	//
 	// Input/Output
 	//
@@ -71,16 +108,117 @@ public:
 	 */
 	TArray<int32> VertexMap;
 	
+
+	/** The tessellation level actually used, lower than TessellationNum if it was clamped to the TriangleBudget. */
+	int ResultTessellationNum = 0;
+
+	/** 
+	 * Time spent in the stages of the last Compute(), in ms. The attribute layers are generated on the task graph 
+	 * while the topology is built, so their GenerateTime overlaps with TopologyTime and AssemblyTime.
+	 */
+	struct FStageTimings
+	{
+		struct FLayer
+		{
+			FString Name;
+			double GenerateTime = 0;
+			double CopyTime = 0;
+		};
+
+		/** Generating the vertex positions and triangles */
+		double TopologyTime = 0;
+		/** Building the result mesh topology */
+		double AssemblyTime = 0;
+		/** Waiting for the attribute layers still generating once the topology was built */
+		double AttributeWaitTime = 0;
+		/** Adding and filling the attribute layers of the result mesh */
+		double AttributeCopyTime = 0;
+		double TotalTime = 0;
+		TArray<FLayer> Layers;
+	};
+	FStageTimings Timings;
+
+	/** 
+	 * Largest result a single FDynamicMesh3 is built for. The generators index per-vertex elements of up to 4 
+	 * components and triangle corners with int32, so both have to stay below MAX_int32. Larger results have to be 
+	 * built in chunks, see ComputeChunks().
+	 */
+	static constexpr int64 MaxResultTriangles = MAX_int32 / 4;
+
+	//
+	// New vertex mappings, valid after Compute() if bComputeMappings is set. The tessellation allocates the new 
+	// vertex IDs in one contiguous run per input edge followed by one run per input triangle, so a new vertex is 
+	// mapped to the input mesh arithmetically, through tables the size of the input mesh. Lookups are O(1) and
+	// thread safe.
+	//
+
+	/** @return The first result vertex ID added by the tessellation, the IDs below are the input mesh vertices. */
+	int32 GetFirstNewVertexID() const 
+	{
+		return FirstEdgeVertexID;
+	}
+
+	/** @return One past the last result vertex ID added by the tessellation. */
+	int32 GetEndNewVertexID() const 
+	{
+		return EndNewVertexID;
+	}
+
 	/**
-	 * Map the ID of the vertex inserted along the input mesh edge to the input mesh triangle IDs (t1,t2) that share 
-	 * that edge. If its a boundary edge then t2 is InvalidID.
+	 * @return true if the vertex was inserted along an input mesh edge. OutTriangles are then the input mesh 
+	 * triangle IDs (t1,t2) that share that edge, t2 is InvalidID on a boundary edge.
 	 */
-	TMap<int32, FIndex2i> VertexEdgeMap;
+	bool GetVertexEdgeTriangles(const int32 VertexID, FIndex2i& OutTriangles) const 
+	{
+		if (VertexID < FirstEdgeVertexID || VertexID >= FirstTriangleVertexID) 
+		{
+			return false;
+		}
+		OutTriangles = EdgeTriangles[(VertexID - FirstEdgeVertexID) / NumEdgeVerticesPerEdge];
+		return true;
+	}
 
-	/** Map the ID of the vertex inserted inside the input mesh triangle to the triangle's ID. */
-	TMap<int32, int32> VertexTriangleMap;
+	/** @return The ID of the input mesh triangle the vertex was inserted inside, InvalidID for any other vertex. */
+	int32 GetVertexTriangle(const int32 VertexID) const 
+	{
+		if (VertexID < FirstTriangleVertexID || VertexID >= EndNewVertexID) 
+		{
+			return IndexConstants::InvalidID;
+		}
+		return InputTriangles[(VertexID - FirstTriangleVertexID) / NumVerticesPerTriangle];
+	}
+
+	/** 
+	 * @return An input mesh triangle the new vertex lies on, t1 for the vertices inserted along an edge. InvalidID 
+	 * for the input mesh vertices.
+	 */
+	int32 GetNewVertexTriangle(const int32 VertexID) const 
+	{
+		FIndex2i EdgeTriangle;
+		return GetVertexEdgeTriangles(VertexID, EdgeTriangle) ? EdgeTriangle.A : GetVertexTriangle(VertexID);
+	}
 
 protected:
+
+	/** Input mesh triangles (t1,t2) of every edge of the tessellated (compact) mesh */
+	TArray<FIndex2i> EdgeTriangles;
+
+	/** Input mesh triangle ID of every triangle of the tessellated (compact) mesh */
+	TArray<int32> InputTriangles;
+
+	int32 FirstEdgeVertexID = 0;
+	int32 FirstTriangleVertexID = 0;
+	int32 EndNewVertexID = 0;
+	int32 NumEdgeVerticesPerEdge = 0;
+	int32 NumVerticesPerTriangle = 0;
+
+	void ResetMappings();
+
+	/** 
+	 * Fill the mapping tables from the mesh given to the generators.
+	 * @param CompactToInputTriangles Input mesh ID of each of its triangles if it is a compact copy of the input.
+	 */
+	void InitializeMappings(const FDynamicMesh3& TessellatedMesh, const TArray<int32>* CompactToInputTriangles);
 	
 	/** 
 	 * Points to either the input mesh to be used to generate the new tessellated mesh or will point to a copy of 
@@ -120,10 +258,26 @@ public:
 	}
 
 	/** @return The number of vertices after the tessellation. */
-	static int32 ExpectedNumVertices(const FDynamicMesh3& Mesh, const int32 TessellationNum);
+	static int64 ExpectedNumVertices(const FDynamicMesh3& Mesh, const int32 TessellationNum);
 	
 	/** @return The number of triangles after the tessellation. */
-	static int32 ExpectedNumTriangles(const FDynamicMesh3& Mesh, const int32 TessellationNum);
+	static int64 ExpectedNumTriangles(const FDynamicMesh3& Mesh, const int32 TessellationNum);
+
+	/** @return The largest tessellation level whose result has at most TriangleBudget triangles, -1 if even level 0 does not fit. */
+	static int32 MaxTessellationNum(const FDynamicMesh3& Mesh, const int64 TriangleBudget);
+
+	/** @return The largest tessellation level at which one input triangle fits in a chunk of ChunkTriangleBudget triangles. */
+	static int32 MaxChunkTessellationNum(const int64 ChunkTriangleBudget);
+
+	/**
+	 * Split the triangles of Source, in ID order, into runs whose tessellation at TessellationNum has at most 
+	 * ChunkTriangleBudget triangles, and hand each run to SubmeshCallback as a submesh of Source with its attributes.
+	 * The submesh only lives for the duration of the callback. Used by ComputeChunks() and DpFPNTriangles::ComputeChunks().
+	 * 
+	 * @return false if SubmeshCallback returned false, or if a single input triangle does not fit in ChunkTriangleBudget.
+	 */
+	static bool ForEachChunkSubmesh(const FDynamicMesh3& Source, const int32 TessellationNum, const int64 ChunkTriangleBudget, 
+		TFunctionRef<bool(const FDynamicMesh3& Submesh)> SubmeshCallback);
 
 	/**
 	 * @return EOperationValidationResult::Ok if we can apply operation, or error code if we cannot.
@@ -138,6 +292,13 @@ public:
 			return EOperationValidationResult::Failed_UnknownReason;
 		}
 
+		// The counts are 64 bit, (TessellationNum + 1)^2 triangles per input triangle overflows int32 quickly
+		const FDynamicMesh3& Source = bInPlace ? *ResultMesh : *Mesh;
+		if (bClampToBudget == false && ExpectedNumTriangles(Source, TessellationNum) > GetClampedTriangleBudget()) 
+		{
+			return EOperationValidationResult::Failed_UnknownReason;
+		}
+
 		return EOperationValidationResult::Ok;
 	}
 
@@ -148,8 +309,27 @@ public:
 	 */
 	virtual bool Compute();
 
+	/**
+	 * Tessellate a result too large for one mesh as a series of bounded meshes. The input triangles are split, in 
+	 * ID order, into runs whose tessellation has at most ChunkTriangleBudget triangles, and each run is tessellated 
+	 * on its own and handed to ChunkCallback, which can move it away. Only one chunk is held in memory at a time.
+	 * Neighbouring chunks generate the same vertices along their shared input edges, but do not share vertex IDs.
+	 * The input mesh is not changed, even when tessellating in place, and the vertex mappings are not computed.
+	 * TriangleBudget does not apply, TessellationNum is never clamped.
+	 * 
+	 * @param ChunkCallback receives each chunk and its index, return false to stop
+	 * @return true if every chunk was generated and accepted, false if it failed, was cancelled or stopped, or if a 
+	 * single input triangle does not fit in ChunkTriangleBudget.
+	 */
+	virtual bool ComputeChunks(const int64 ChunkTriangleBudget, TFunctionRef<bool(FDynamicMesh3& Chunk, int32 ChunkIndex)> ChunkCallback);
+
 protected:
 
+	int64 GetClampedTriangleBudget() const
+	{
+		return FMath::Clamp(TriangleBudget, (int64)0, MaxResultTriangles);
+	}
+
 	/** If this returns true, abort computation. */
 	virtual bool Cancelled();
 };